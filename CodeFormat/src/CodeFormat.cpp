@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -32,8 +33,11 @@ int main(int argc, char **argv) {
             "for example:\n"
             "\tCodeFormat check -w . -d\n"
             "\tCodeFormat format -f test.lua -d\n"
+            "\tCodeFormat format -w . -d --check-only\n"
             "\tCodeFormat check -w . -d --ignores \"Test/*.lua;src/**.lua\"\n"
             "\tCodeFormat check -w . -d --ignores-file \".gitignore\"\n"
+            "\tCodeFormat check -w . -d --cache .codeformat-cache\n"
+            "\tCodeFormat check -w . -d --output-format=sarif\n"
             "\tCodeFormat rangeformat -i -d --rangeline 1:10\n"
             "\tCodeFormat rangeformat -i -d --rangeOffset 0:100\n");
     cmd.AddTarget("format")
@@ -55,6 +59,16 @@ int main(int argc, char **argv) {
                               "Use file wildcards to specify how to ignore files\n"
                               "\t\tseparated by ';'")
             .Add<bool>("non-standard", "", "Enable non-standard formatting")
+            .Add<std::string>("cache", "",
+                              "Specify cache file, unchanged files that are already formatted will be skipped")
+            .Add<bool>("check-only", "",
+                       "Only verify whether the files are formatted, nothing is written\n"
+                       "\t\treturn 1 if any file is not formatted")
+            .Add<bool>("diff", "", "Same as check-only, and show the position of the first difference")
+            .Add<int>("threads", "j",
+                      "Split a large file at independent top-level statements and format them in parallel\n"
+                      "\t\tin workspace mode, the number of files formatted at the same time\n"
+                      "\t\t0 means the number of hardware threads")
             .EnableKeyValueArgs();
     cmd.AddTarget("rangeformat")
             .Add<std::string>("file", "f", "Specify the input file")
@@ -88,7 +102,19 @@ int main(int argc, char **argv) {
                               "Use file wildcards to specify how to ignore files\n"
                               "\t\tseparated by ';'")
             .Add<bool>("name-style", "ns", "Enable name-style check")
+            .Add<int>("max-diagnostics", "",
+                      "Stop checking a file once it has reported this many diagnostics, 0 means no limit")
+            .Add<int>("max-diagnostics-per-type", "",
+                      "Maximum number of diagnostics of the same type for each file, 0 means no limit")
             .Add<bool>("non-standard", "", "Enable non-standard checking")
+            .Add<std::string>("cache", "",
+                              "Specify cache file, the results of unchanged files will be reused")
+            .Add<std::string>("output-format", "",
+                              "text, json, sarif or checkstyle, the default is text\n"
+                              "\t\tother formats write a single document to stdout")
+            .Add<int>("threads", "j",
+                      "In workspace mode, the number of files checked at the same time\n"
+                      "\t\t0 means the number of hardware threads")
             .EnableKeyValueArgs();
 
 
@@ -105,7 +131,9 @@ int main(int argc, char **argv) {
             return 1;
         }
     } else if (cmd.GetTarget() == "check") {
-        InitCheck(cmd, format);
+        if (!InitCheck(cmd, format)) {
+            return -1;
+        }
         if (!format.Check() && cmd.Get<bool>("diagnosis-as-error")) {
             return -1;
         }
@@ -178,6 +206,18 @@ bool InitFormat(CommandLine &cmd, LuaFormat &format) {
         format.SupportNonStandardLua();
     }
 
+    if (cmd.HasOption("cache")) {
+        format.SetCachePath(cmd.Get<std::string>("cache"));
+    }
+
+    if (cmd.Get<bool>("check-only") || cmd.Get<bool>("diff")) {
+        format.SupportCheckOnly(cmd.Get<bool>("diff"));
+    }
+
+    if (cmd.HasOption("threads")) {
+        format.SetFormatThreads(std::max(cmd.Get<int>("threads"), 0));
+    }
+
     format.SetDefaultStyle(cmd.GetKeyValueOptions());
     return true;
 }
@@ -237,9 +277,31 @@ bool InitCheck(CommandLine &cmd, LuaFormat &format) {
         format.SupportNameStyleCheck();
     }
 
+    if (cmd.HasOption("max-diagnostics") || cmd.HasOption("max-diagnostics-per-type")) {
+        format.SetDiagnosticLimit(std::max(cmd.Get<int>("max-diagnostics"), 0),
+                                  std::max(cmd.Get<int>("max-diagnostics-per-type"), 0));
+    }
+
     if (cmd.Get<bool>("non-standard")) {
         format.SupportNonStandardLua();
     }
+
+    if (cmd.HasOption("cache")) {
+        format.SetCachePath(cmd.Get<std::string>("cache"));
+    }
+
+    if (cmd.HasOption("threads")) {
+        format.SetFormatThreads(std::max(cmd.Get<int>("threads"), 0));
+    }
+
+    if (cmd.HasOption("output-format")) {
+        auto outputFormat = DiagnosticReport::ParseFormat(cmd.Get<std::string>("output-format"));
+        if (!outputFormat.has_value()) {
+            std::cerr << util::format("Unknown output format {}", cmd.Get<std::string>("output-format")) << std::endl;
+            return false;
+        }
+        format.SetOutputFormat(outputFormat.value());
+    }
     return true;
 }
 
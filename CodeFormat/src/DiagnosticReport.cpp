@@ -0,0 +1,491 @@
+#include "DiagnosticReport.h"
+#include "Util/format.h"
+#include <iostream>
+
+static void AppendNumber(std::string &out, std::size_t value) {
+    out.append(std::to_string(value));
+}
+
+static void AppendJsonString(std::string &out, std::string_view text) {
+    out.push_back('"');
+    for (auto ch: text) {
+        switch (ch) {
+            case '"': {
+                out.append("\\\"");
+                break;
+            }
+            case '\\': {
+                out.append("\\\\");
+                break;
+            }
+            case '\n': {
+                out.append("\\n");
+                break;
+            }
+            case '\r': {
+                out.append("\\r");
+                break;
+            }
+            case '\t': {
+                out.append("\\t");
+                break;
+            }
+            default: {
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    constexpr std::string_view hex = "0123456789abcdef";
+                    out.append("\\u00");
+                    out.push_back(hex[(ch >> 4) & 0xf]);
+                    out.push_back(hex[ch & 0xf]);
+                } else {
+                    out.push_back(ch);
+                }
+                break;
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+static void AppendXmlString(std::string &out, std::string_view text) {
+    for (auto ch: text) {
+        switch (ch) {
+            case '&': {
+                out.append("&amp;");
+                break;
+            }
+            case '<': {
+                out.append("&lt;");
+                break;
+            }
+            case '>': {
+                out.append("&gt;");
+                break;
+            }
+            case '"': {
+                out.append("&quot;");
+                break;
+            }
+            case '\'': {
+                out.append("&apos;");
+                break;
+            }
+            default: {
+                out.push_back(ch);
+                break;
+            }
+        }
+    }
+}
+
+// sarif 的 uri 使用 '/' 分隔
+static std::string ToUri(std::string_view path) {
+    std::string uri(path);
+    for (auto &ch: uri) {
+        if (ch == '\\') {
+            ch = '/';
+        }
+    }
+    return uri;
+}
+
+enum class Severity {
+    Error,
+    Warning,
+    Info
+};
+
+static Severity GetSeverity(DiagnosticType type) {
+    switch (type) {
+        case DiagnosticType::None: {
+            return Severity::Error;
+        }
+        case DiagnosticType::NameStyle:
+        case DiagnosticType::Spell: {
+            return Severity::Info;
+        }
+        default: {
+            return Severity::Warning;
+        }
+    }
+}
+
+std::optional<OutputFormat> DiagnosticReport::ParseFormat(std::string_view name) {
+    if (name == "text") {
+        return OutputFormat::Text;
+    } else if (name == "json") {
+        return OutputFormat::Json;
+    } else if (name == "sarif") {
+        return OutputFormat::Sarif;
+    } else if (name == "checkstyle") {
+        return OutputFormat::Checkstyle;
+    }
+    return std::nullopt;
+}
+
+std::string_view DiagnosticReport::GetTypeName(DiagnosticType type) {
+    switch (type) {
+        case DiagnosticType::None:
+            return "syntax";
+        case DiagnosticType::Space:
+            return "space";
+        case DiagnosticType::Align:
+            return "align";
+        case DiagnosticType::MaxLineWidth:
+            return "max-line-width";
+        case DiagnosticType::StringQuote:
+            return "string-quote";
+        case DiagnosticType::StatementLineSpace:
+            return "line-space";
+        case DiagnosticType::EndWithNewLine:
+            return "end-with-new-line";
+        case DiagnosticType::Indent:
+            return "indent";
+        case DiagnosticType::Semicolon:
+            return "semicolon";
+        case DiagnosticType::NameStyle:
+            return "name-style";
+        case DiagnosticType::Spell:
+            return "spell";
+    }
+    return "unknown";
+}
+
+DiagnosticReport::DiagnosticReport()
+    : _format(OutputFormat::Text),
+      _fileCount(0),
+      _diagnosticFileCount(0),
+      _diagnosticCount(0),
+      _typeCounts(),
+      _hasElement(false) {
+}
+
+void DiagnosticReport::SetFormat(OutputFormat format) {
+    _format = format;
+}
+
+OutputFormat DiagnosticReport::GetFormat() const {
+    return _format;
+}
+
+void DiagnosticReport::Begin() {
+    _startTime = std::chrono::steady_clock::now();
+    _fileCount = 0;
+    _diagnosticFileCount = 0;
+    _diagnosticCount = 0;
+    _typeCounts.fill(0);
+    _hasElement = false;
+    _sarifNotifications.clear();
+
+    switch (_format) {
+        case OutputFormat::Json: {
+            _buffer.append("{\"version\":");
+            AppendJsonString(_buffer, CodeFormatVersion);
+            _buffer.append(",\"files\":[");
+            break;
+        }
+        case OutputFormat::Sarif: {
+            _buffer.append("{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\",\"version\":\"2.1.0\","
+                           "\"runs\":[{\"results\":[");
+            break;
+        }
+        case OutputFormat::Checkstyle: {
+            _buffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<checkstyle version=\"4.3\">\n");
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+    Flush();
+}
+
+void DiagnosticReport::AddFile(std::string_view path, const CacheEntry &entry) {
+    _fileCount++;
+    if (!entry.Diagnostics.empty()) {
+        _diagnosticFileCount++;
+    }
+    _diagnosticCount += entry.Diagnostics.size();
+    for (auto &d: entry.Diagnostics) {
+        auto index = static_cast<std::size_t>(d.Type);
+        if (index < TypeCount) {
+            _typeCounts[index]++;
+        }
+    }
+
+    if (entry.Diagnostics.empty() && !entry.Truncated) {
+        return;
+    }
+
+    switch (_format) {
+        case OutputFormat::Text: {
+            AddTextFile(path, entry);
+            break;
+        }
+        case OutputFormat::Json: {
+            AddJsonFile(path, entry);
+            break;
+        }
+        case OutputFormat::Sarif: {
+            AddSarifFile(path, entry);
+            break;
+        }
+        case OutputFormat::Checkstyle: {
+            AddCheckstyleFile(path, entry);
+            break;
+        }
+    }
+    Flush();
+}
+
+void DiagnosticReport::End(bool textSummary) {
+    switch (_format) {
+        case OutputFormat::Text: {
+            if (textSummary) {
+                std::cerr << GetTextSummary();
+            }
+            break;
+        }
+        case OutputFormat::Json: {
+            _buffer.append("],\"summary\":");
+            AppendJsonSummary();
+            _buffer.append("}\n");
+            break;
+        }
+        case OutputFormat::Sarif: {
+            _buffer.append("],\"tool\":{\"driver\":{\"name\":\"CodeFormat\",\"version\":");
+            AppendJsonString(_buffer, CodeFormatVersion);
+            _buffer.append(",\"rules\":[");
+            for (std::size_t i = 0; i != TypeCount; i++) {
+                if (i != 0) {
+                    _buffer.push_back(',');
+                }
+                _buffer.append("{\"id\":");
+                AppendJsonString(_buffer, GetTypeName(static_cast<DiagnosticType>(i)));
+                _buffer.push_back('}');
+            }
+            _buffer.append("]}},\"invocations\":[{\"executionSuccessful\":true,\"toolExecutionNotifications\":[");
+            _buffer.append(_sarifNotifications);
+            _buffer.append("]}],\"properties\":{\"summary\":");
+            AppendJsonSummary();
+            _buffer.append("}}]}\n");
+            break;
+        }
+        case OutputFormat::Checkstyle: {
+            _buffer.append("</checkstyle>\n");
+            std::cerr << GetTextSummary();
+            break;
+        }
+    }
+    Flush();
+    std::cout.flush();
+}
+
+void DiagnosticReport::AddTextFile(std::string_view path, const CacheEntry &entry) {
+    if (entry.SyntaxError) {
+        std::cout << util::format("Check {} ...\t{} error\n", path, entry.Diagnostics.size());
+    } else if (!entry.Diagnostics.empty()) {
+        std::cout << util::format("Check {}\t{} warning\n", path, entry.Diagnostics.size());
+    }
+
+    // 诊断信息写到 stderr, 不经过 Flush
+    std::string out;
+    for (auto &d: entry.Diagnostics) {
+        out.push_back('\t');
+        out.append(path);
+        out.push_back('(');
+        AppendNumber(out, d.StartLine + 1);
+        out.push_back(':');
+        AppendNumber(out, d.StartChar);
+        out.append(" to ");
+        AppendNumber(out, d.EndLine + 1);
+        out.push_back(':');
+        AppendNumber(out, d.EndChar);
+        out.append("): ");
+        out.append(d.Message);
+        out.push_back('\n');
+    }
+    if (entry.Truncated) {
+        out.append(util::format("\t{}: too many diagnostics, the rest are omitted\n", path));
+    }
+    std::cerr.write(out.data(), static_cast<std::streamsize>(out.size()));
+}
+
+void DiagnosticReport::AddJsonFile(std::string_view path, const CacheEntry &entry) {
+    if (_hasElement) {
+        _buffer.push_back(',');
+    }
+    _hasElement = true;
+
+    _buffer.append("\n{\"path\":");
+    AppendJsonString(_buffer, path);
+    _buffer.append(",\"syntaxError\":");
+    _buffer.append(entry.SyntaxError ? "true" : "false");
+    _buffer.append(",\"truncated\":");
+    _buffer.append(entry.Truncated ? "true" : "false");
+    _buffer.append(",\"diagnostics\":[");
+    for (std::size_t i = 0; i != entry.Diagnostics.size(); i++) {
+        auto &d = entry.Diagnostics[i];
+        if (i != 0) {
+            _buffer.push_back(',');
+        }
+        _buffer.append("{\"type\":");
+        AppendJsonString(_buffer, GetTypeName(d.Type));
+        _buffer.append(",\"severity\":");
+        switch (GetSeverity(d.Type)) {
+            case Severity::Error: {
+                _buffer.append("\"error\"");
+                break;
+            }
+            case Severity::Warning: {
+                _buffer.append("\"warning\"");
+                break;
+            }
+            case Severity::Info: {
+                _buffer.append("\"info\"");
+                break;
+            }
+        }
+        _buffer.append(",\"message\":");
+        AppendJsonString(_buffer, d.Message);
+        _buffer.append(",\"start\":{\"line\":");
+        AppendNumber(_buffer, d.StartLine + 1);
+        _buffer.append(",\"column\":");
+        AppendNumber(_buffer, d.StartChar + 1);
+        _buffer.append("},\"end\":{\"line\":");
+        AppendNumber(_buffer, d.EndLine + 1);
+        _buffer.append(",\"column\":");
+        AppendNumber(_buffer, d.EndChar + 1);
+        _buffer.append("}}");
+    }
+    _buffer.append("]}");
+}
+
+void DiagnosticReport::AddSarifFile(std::string_view path, const CacheEntry &entry) {
+    auto uri = ToUri(path);
+    if (entry.Truncated) {
+        if (!_sarifNotifications.empty()) {
+            _sarifNotifications.push_back(',');
+        }
+        _sarifNotifications.append("\n{\"level\":\"warning\",\"message\":{\"text\":\"too many diagnostics, the rest are omitted\"},"
+                                   "\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+        AppendJsonString(_sarifNotifications, uri);
+        _sarifNotifications.append("}}}]}");
+    }
+
+    for (auto &d: entry.Diagnostics) {
+        if (_hasElement) {
+            _buffer.push_back(',');
+        }
+        _hasElement = true;
+
+        _buffer.append("\n{\"ruleId\":");
+        AppendJsonString(_buffer, GetTypeName(d.Type));
+        _buffer.append(",\"level\":");
+        switch (GetSeverity(d.Type)) {
+            case Severity::Error: {
+                _buffer.append("\"error\"");
+                break;
+            }
+            case Severity::Warning: {
+                _buffer.append("\"warning\"");
+                break;
+            }
+            case Severity::Info: {
+                _buffer.append("\"note\"");
+                break;
+            }
+        }
+        _buffer.append(",\"message\":{\"text\":");
+        AppendJsonString(_buffer, d.Message);
+        _buffer.append("},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+        AppendJsonString(_buffer, uri);
+        _buffer.append("},\"region\":{\"startLine\":");
+        AppendNumber(_buffer, d.StartLine + 1);
+        _buffer.append(",\"startColumn\":");
+        AppendNumber(_buffer, d.StartChar + 1);
+        _buffer.append(",\"endLine\":");
+        AppendNumber(_buffer, d.EndLine + 1);
+        _buffer.append(",\"endColumn\":");
+        AppendNumber(_buffer, d.EndChar + 1);
+        _buffer.append("}}}]}");
+    }
+}
+
+void DiagnosticReport::AddCheckstyleFile(std::string_view path, const CacheEntry &entry) {
+    _buffer.append("<file name=\"");
+    AppendXmlString(_buffer, path);
+    _buffer.append("\">\n");
+    for (auto &d: entry.Diagnostics) {
+        _buffer.append("<error line=\"");
+        AppendNumber(_buffer, d.StartLine + 1);
+        _buffer.append("\" column=\"");
+        AppendNumber(_buffer, d.StartChar + 1);
+        _buffer.append("\" severity=\"");
+        switch (GetSeverity(d.Type)) {
+            case Severity::Error: {
+                _buffer.append("error");
+                break;
+            }
+            case Severity::Warning: {
+                _buffer.append("warning");
+                break;
+            }
+            case Severity::Info: {
+                _buffer.append("info");
+                break;
+            }
+        }
+        _buffer.append("\" message=\"");
+        AppendXmlString(_buffer, d.Message);
+        _buffer.append("\" source=\"CodeFormat.");
+        _buffer.append(GetTypeName(d.Type));
+        _buffer.append("\"/>\n");
+    }
+    _buffer.append("</file>\n");
+}
+
+void DiagnosticReport::AppendJsonSummary() {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _startTime);
+    _buffer.append("{\"files\":");
+    AppendNumber(_buffer, _fileCount);
+    _buffer.append(",\"filesWithDiagnostics\":");
+    AppendNumber(_buffer, _diagnosticFileCount);
+    _buffer.append(",\"diagnostics\":");
+    AppendNumber(_buffer, _diagnosticCount);
+    _buffer.append(",\"byType\":{");
+    bool first = true;
+    for (std::size_t i = 0; i != TypeCount; i++) {
+        if (_typeCounts[i] == 0) {
+            continue;
+        }
+        if (!first) {
+            _buffer.push_back(',');
+        }
+        first = false;
+        AppendJsonString(_buffer, GetTypeName(static_cast<DiagnosticType>(i)));
+        _buffer.push_back(':');
+        AppendNumber(_buffer, _typeCounts[i]);
+    }
+    _buffer.append("},\"elapsedMs\":");
+    AppendNumber(_buffer, static_cast<std::size_t>(elapsed.count()));
+    _buffer.push_back('}');
+}
+
+std::string DiagnosticReport::GetTextSummary() const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _startTime);
+    std::string summary = util::format("Checked {} files in {} ms, {} diagnostics in {} files\n", _fileCount,
+                                       static_cast<std::size_t>(elapsed.count()), _diagnosticCount, _diagnosticFileCount);
+    for (std::size_t i = 0; i != TypeCount; i++) {
+        if (_typeCounts[i] != 0) {
+            summary.append(util::format("\t{}: {}\n", GetTypeName(static_cast<DiagnosticType>(i)), _typeCounts[i]));
+        }
+    }
+    return summary;
+}
+
+void DiagnosticReport::Flush() {
+    if (!_buffer.empty()) {
+        std::cout.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+        _buffer.clear();
+    }
+}
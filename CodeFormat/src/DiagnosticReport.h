@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ResultCache.h"
+#include <array>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+enum class OutputFormat {
+    Text,
+    Json,
+    Sarif,
+    Checkstyle
+};
+
+/*
+ * check 命令的输出
+ * 每个文件的结果先在内存中拼好再一次写出, 最后输出按诊断类型统计的汇总和耗时
+ * 非文本格式时 stdout 只包含一个完整的文档, 其中的行列号都从 1 开始
+ */
+class DiagnosticReport {
+public:
+    static std::optional<OutputFormat> ParseFormat(std::string_view name);
+
+    // 语法错误为 syntax
+    static std::string_view GetTypeName(DiagnosticType type);
+
+    DiagnosticReport();
+
+    void SetFormat(OutputFormat format);
+
+    OutputFormat GetFormat() const;
+
+    void Begin();
+
+    // 文件按调用顺序输出, 调用者负责排序
+    void AddFile(std::string_view path, const CacheEntry &entry);
+
+    // textSummary 为 false 时文本格式不输出汇总
+    void End(bool textSummary);
+
+private:
+    static constexpr std::size_t TypeCount = static_cast<std::size_t>(DiagnosticType::Spell) + 1;
+
+    void AddTextFile(std::string_view path, const CacheEntry &entry);
+
+    void AddJsonFile(std::string_view path, const CacheEntry &entry);
+
+    void AddSarifFile(std::string_view path, const CacheEntry &entry);
+
+    void AddCheckstyleFile(std::string_view path, const CacheEntry &entry);
+
+    void AppendJsonSummary();
+
+    std::string GetTextSummary() const;
+
+    void Flush();
+
+    OutputFormat _format;
+    std::chrono::steady_clock::time_point _startTime;
+    std::size_t _fileCount;
+    std::size_t _diagnosticFileCount;
+    std::size_t _diagnosticCount;
+    std::array<std::size_t, TypeCount> _typeCounts;
+    // 文档中是否已经有元素, 决定 json 是否需要逗号
+    bool _hasElement;
+    std::string _buffer;
+    // sarif 中截断的文件, 作为 invocation 的 toolExecutionNotifications 输出
+    std::string _sarifNotifications;
+};
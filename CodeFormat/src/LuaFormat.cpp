@@ -2,25 +2,44 @@
 #include "CodeFormatCore/Config/LuaEditorConfig.h"
 #include "CodeFormatCore/Diagnostic/DiagnosticBuilder.h"
 #include "CodeFormatCore/Format/FormatBuilder.h"
+#include "CodeFormatCore/Format/ParallelFormatBuilder.h"
+#include "CodeFormatCore/Format/VerifyFormatBuilder.h"
 #include "CodeFormatCore/RangeFormat/RangeFormatBuilder.h"
 #include "LuaParser/Ast/LuaSyntaxTree.h"
 #include "LuaParser/File/LuaSource.h"
 #include "LuaParser/Lexer/LuaLexer.h"
 #include "LuaParser/Parse/LuaParser.h"
 #include "LuaParser/Types/TextRange.h"
+#include "Util/BlockingQueue.h"
 #include "Util/FileFinder.h"
 #include "Util/StringUtil.h"
+#include "Util/Utf8.h"
 #include "Util/Url.h"
 #include "Util/format.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 LuaFormat::LuaFormat()
     : _mode(WorkMode::File),
       _isRangeLine(false),
       _isCompleteOutputRangeFormat(false),
-      _isSupportNonStandardLua(false) {
+      _isSupportNonStandardLua(false),
+      _isCheckOnly(false),
+      _isShowDiff(false),
+      _formatThreads(1) {
     _diagnosticStyle.name_style_check = false;
 }
 
@@ -139,22 +158,62 @@ void LuaFormat::SetDefaultStyle(std::map<std::string, std::string, std::less<>>
         return;
     }
     _defaultStyle.Parse(keyValues);
+    _defaultStyleConfig = keyValues;
 }
 
 bool LuaFormat::Reformat() {
     switch (_mode) {
         case WorkMode::File:
         case WorkMode::Stdin: {
-            return ReformatSingleFile(_inputPath, _outPath, std::move(_inputFileText));
+            auto result = ReformatSingleFile(_inputPath, _outPath, std::move(_inputFileText));
+            if (_isCheckOnly && !result) {
+                std::cerr << util::format("{} is not formatted.", _inputPath.empty() ? "stdin" : _inputPath)
+                          << std::endl;
+            }
+            SaveCache();
+            return result;
         }
         case WorkMode::Workspace: {
-            return ReformatWorkspace();
+            auto result = ReformatWorkspace();
+            SaveCache();
+            return result;
         }
     }
     return false;
 }
 
 bool LuaFormat::ReformatSingleFile(std::string_view inputPath, std::string_view outPath, std::string &&sourceText) {
+    auto output = FormatSingleFile(inputPath, outPath.empty(), std::move(sourceText));
+    std::cerr << output.Message;
+    if (output.Ok && !_isCheckOnly) {
+        WriteFormattedText(outPath, output.Text, output.Unchanged);
+    }
+    return output.Ok;
+}
+
+LuaFormat::FormatOutput LuaFormat::FormatSingleFile(std::string_view inputPath, bool toStdout, std::string &&sourceText) {
+    FormatOutput output;
+    LuaStyle style = GetStyle(inputPath);
+    if (toStdout && !_isCheckOnly) {
+        style.detect_end_of_line = false;
+        style.end_of_line = EndOfLine::LF;
+    }
+
+    CacheKey cacheKey;
+    if (_cache) {
+        auto optionHash = ResultCache::Mix(GetOptionHash(CacheKind::Format, inputPath), toStdout && !_isCheckOnly);
+        cacheKey = _cache->MakeKey(CacheKind::Format, sourceText, optionHash);
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        auto entry = _cache->Find(cacheKey);
+        if (entry && entry->Ok) {
+            output.Ok = true;
+            if (!_isCheckOnly) {
+                output.Text = std::move(sourceText);
+            }
+            return output;
+        }
+    }
+
     auto file = LuaSource::From(std::move(sourceText));
     LuaLexer luaLexer(file);
     if (_isSupportNonStandardLua) {
@@ -167,30 +226,66 @@ bool LuaFormat::ReformatSingleFile(std::string_view inputPath, std::string_view
     p.Parse();
 
     if (p.HasError()) {
-        std::cerr << "Exist Syntax Errors" << std::endl;
-        return false;
+        output.Message = "Exist Syntax Errors\n";
+        return output;
     }
 
     LuaSyntaxTree t;
     t.BuildTree(p);
 
-    LuaStyle style = GetStyle(inputPath);
-    if (outPath.empty()) {
-        style.detect_end_of_line = false;
-        style.end_of_line = EndOfLine::LF;
+    if (_isCheckOnly) {
+        VerifyFormatBuilder f(style);
+        if (!f.IsFormatted(t)) {
+            if (_isShowDiff) {
+                auto offset = f.GetDiffOffset();
+                auto line = file->GetLine(offset);
+                output.Message.append(util::format("\t{}({}:{}): first difference\n", inputPath, line + 1, file->GetColumn(offset)));
+                auto lineStart = file->GetOffset(line, 0);
+                auto lineText = file->GetSource().substr(lineStart);
+                lineText = lineText.substr(0, lineText.find_first_of("\r\n"));
+                output.Message.append(util::format("\t\t{}\n", lineText));
+            }
+            return output;
+        }
+    } else {
+        // 工作区模式下多个文件已经并发格式化, 单个文件不再切分
+        if (_formatThreads != 1 && _mode != WorkMode::Workspace) {
+            ParallelFormatBuilder f(style, _formatThreads);
+            output.Text = f.GetFormatResult(t);
+        } else {
+            FormatBuilder f(style);
+            output.Text = f.GetFormatResult(t);
+        }
+        output.Ok = true;
+        output.Unchanged = output.Text == file->GetSource();
+        if (!output.Unchanged) {
+            return output;
+        }
     }
 
-    FormatBuilder f(style);
-    auto formattedText = f.GetFormatResult(t);
+    output.Ok = true;
+    if (_cache) {
+        CacheEntry entry;
+        entry.Ok = true;
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        _cache->Put(cacheKey, std::move(entry));
+    }
+    return output;
+}
 
-    if (!outPath.empty()) {
-        std::fstream fout(std::string(outPath), std::ios::out | std::ios::binary);
-        fout.write(formattedText.data(), formattedText.size());
-        fout.close();
-    } else {
-        std::cout.write(formattedText.data(), formattedText.size());
+void LuaFormat::WriteFormattedText(std::string_view outPath, std::string_view text, bool unchanged) {
+    if (outPath.empty()) {
+        std::cout.write(text.data(), text.size());
+        return;
     }
-    return true;
+    // do not touch the source file when nothing changed, it keeps the mtime for build systems and file watchers
+    if (unchanged && (_mode == WorkMode::Workspace || outPath == _inputPath)) {
+        return;
+    }
+
+    std::fstream fout(std::string(outPath), std::ios::out | std::ios::binary);
+    fout.write(text.data(), text.size());
+    fout.close();
 }
 
 
@@ -253,29 +348,65 @@ bool LuaFormat::RangeReformat() {
 }
 
 bool LuaFormat::Check() {
+    auto isText = _report.GetFormat() == OutputFormat::Text;
+    _report.Begin();
+    bool result = false;
     if (_mode == WorkMode::File) {
-        if (_inputPath != "stdin") {
+        if (isText && _inputPath != "stdin") {
             std::cerr << util::format("Check {} ...", _inputPath) << std::endl;
         }
 
-        if (CheckSingleFile(_inputPath, std::move(_inputFileText))) {
+        result = CheckSingleFile(_inputPath, std::move(_inputFileText));
+        if (result && isText) {
             std::cerr << util::format("Check {} ... ok", _inputPath) << std::endl;
-            return true;
         }
-        return false;
+    } else {
+        result = CheckWorkspace();
     }
-    return CheckWorkspace();
+    _report.End(_mode == WorkMode::Workspace);
+    SaveCache();
+    return result;
 }
 
-void LuaFormat::DiagnosticInspection(std::string_view message, TextRange range, std::shared_ptr<LuaSource> file,
-                                     std::string_view path) {
-    auto startLine = file->GetLine(range.StartOffset);
-    auto startChar = file->GetColumn(range.StartOffset);
-    auto endLine = file->GetLine(range.GetEndOffset());
-    auto endChar = file->GetColumn(range.GetEndOffset());
-    std::cerr << util::format("\t{}({}:{} to {}:{}): {}", path, startLine + 1, startChar, endLine + 1, endChar,
-                              message)
-              << std::endl;
+CacheDiagnostic LuaFormat::DiagnosticInspection(DiagnosticType type, std::string_view message, TextRange range,
+                                                const LuaSource &file) {
+    CacheDiagnostic diagnostic;
+    diagnostic.Type = type;
+    diagnostic.Message = std::string(message);
+
+    auto source = file.GetSource();
+    auto startOffset = range.StartOffset;
+    auto endOffset = range.GetEndOffset();
+    diagnostic.StartLine = file.GetLine(startOffset);
+    auto lineStart = file.GetLineStartOffset(diagnostic.StartLine);
+    if (startOffset > lineStart) {
+        diagnostic.StartChar = utf8::Utf8nLen(source.data() + lineStart, startOffset - lineStart);
+    }
+
+    // 大多数诊断在同一行内, 结束位置的列号从起始位置接着数
+    if (endOffset >= startOffset && endOffset < file.GetLineStartOffset(diagnostic.StartLine + 1)) {
+        diagnostic.EndLine = diagnostic.StartLine;
+        diagnostic.EndChar = diagnostic.StartChar;
+        if (endOffset > startOffset) {
+            diagnostic.EndChar += utf8::Utf8nLen(source.data() + startOffset, endOffset - startOffset);
+        }
+    } else {
+        diagnostic.EndLine = file.GetLine(endOffset);
+        diagnostic.EndChar = file.GetColumn(endOffset);
+    }
+    return diagnostic;
+}
+
+void LuaFormat::SaveCache() {
+    if (!_cache) {
+        return;
+    }
+
+    std::cerr << util::format("Cache: {} hit, {} miss", _cache->GetHitCount(), _cache->GetMissCount()) << std::endl;
+    // a workspace run visits every file, so the entries of the kind it ran but did not use are stale
+    if (!_cache->Save(_mode == WorkMode::Workspace)) {
+        std::cerr << "Can not write cache file" << std::endl;
+    }
 }
 
 void LuaFormat::SetWorkMode(WorkMode mode) {
@@ -286,10 +417,6 @@ std::optional<std::string> LuaFormat::ReadFile(std::string_view path) {
     std::string newPath(path);
 #ifdef _WIN32
     std::fstream fin(newPath, std::ios::in | std::ios::binary);
-#else
-    std::fstream fin(newPath, std::ios::in);
-#endif
-
     if (fin.is_open()) {
         std::stringstream s;
         s << fin.rdbuf();
@@ -297,9 +424,47 @@ std::optional<std::string> LuaFormat::ReadFile(std::string_view path) {
     }
 
     return std::nullopt;
+#else
+    // 按文件大小一次分配, 并提示内核顺序预读
+    int fd = open(newPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    std::string text;
+    struct stat st {};
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+#ifdef __linux__
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        text.resize(static_cast<std::size_t>(st.st_size));
+    }
+
+    std::size_t length = 0;
+    while (true) {
+        if (length == text.size()) {
+            text.resize(std::max<std::size_t>(text.size() * 2, 4096));
+        }
+        auto n = read(fd, text.data() + length, text.size() - length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            return std::nullopt;
+        }
+        if (n == 0) {
+            break;
+        }
+        length += static_cast<std::size_t>(n);
+    }
+    close(fd);
+    text.resize(length);
+    return text;
+#endif
 }
 
-LuaStyle LuaFormat::GetStyle(std::string_view path) {
+std::shared_ptr<LuaEditorConfig> LuaFormat::FindEditorConfig(std::string_view path) {
     std::shared_ptr<LuaEditorConfig> editorConfig = nullptr;
     std::size_t matchProcess = 0;
     for (auto &config: _configs) {
@@ -311,13 +476,51 @@ LuaStyle LuaFormat::GetStyle(std::string_view path) {
         }
     }
 
+    return editorConfig;
+}
+
+LuaStyle LuaFormat::GetStyle(std::string_view path) {
+    std::lock_guard<std::mutex> lock(_styleMutex);
+    auto editorConfig = FindEditorConfig(path);
     if (editorConfig) {
         return editorConfig->Generate(path);
     }
     return _defaultStyle;
 }
 
-bool LuaFormat::CheckSingleFile(std::string_view inputPath, std::string &&sourceText) {
+std::uint64_t LuaFormat::GetOptionHash(CacheKind kind, std::string_view path) {
+    std::lock_guard<std::mutex> lock(_styleMutex);
+    auto hash = ResultCache::Hash("LuaStyle");
+    auto editorConfig = FindEditorConfig(path);
+    if (editorConfig) {
+        for (auto configMap: editorConfig->GetConfigMaps(path)) {
+            hash = ResultCache::ConfigHash(*configMap, hash);
+        }
+    } else {
+        hash = ResultCache::ConfigHash(_defaultStyleConfig, hash);
+    }
+    hash = ResultCache::Mix(hash, _isSupportNonStandardLua);
+    if (kind == CacheKind::Check) {
+        // 其余诊断选项都是默认值, 由版本覆盖
+        hash = ResultCache::Mix(hash, _diagnosticStyle.name_style_check);
+        hash = ResultCache::Mix(hash, _diagnosticStyle.max_diagnostic_count);
+        hash = ResultCache::Mix(hash, _diagnosticStyle.max_diagnostic_count_per_type);
+    }
+    return hash;
+}
+
+CacheEntry LuaFormat::CheckSourceText(std::string_view inputPath, std::string &&sourceText) {
+    LuaStyle style = GetStyle(inputPath);
+    CacheKey cacheKey;
+    if (_cache) {
+        cacheKey = _cache->MakeKey(CacheKind::Check, sourceText, GetOptionHash(CacheKind::Check, inputPath));
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        auto entry = _cache->Find(cacheKey);
+        if (entry) {
+            return *entry;
+        }
+    }
+
     auto file = std::make_shared<LuaSource>(std::move(sourceText));
     LuaLexer luaLexer(file);
     if (_isSupportNonStandardLua) {
@@ -332,37 +535,45 @@ bool LuaFormat::CheckSingleFile(std::string_view inputPath, std::string &&source
         _inputPath = "from stdin";
     }
 
+    CacheEntry entry;
     if (p.HasError()) {
-        auto &errors = p.GetErrors();
-        std::cout << util::format("Check {} ...\t{} error", inputPath, errors.size()) << std::endl;
-        for (auto &error: errors) {
-            DiagnosticInspection(error.ErrorMessage, error.ErrorRange, file, inputPath);
+        for (auto &error: p.GetErrors()) {
+            entry.Diagnostics.push_back(DiagnosticInspection(DiagnosticType::None, error.ErrorMessage, error.ErrorRange, *file));
         }
-
-        return false;
+        entry.SyntaxError = true;
+        if (_cache) {
+            std::lock_guard<std::mutex> lock(_cacheMutex);
+            _cache->Put(cacheKey, CacheEntry(entry));
+        }
+        return entry;
     }
 
     LuaSyntaxTree t;
     t.BuildTree(p);
 
-    LuaStyle style = GetStyle(inputPath);
     DiagnosticBuilder diagnosticBuilder(style, _diagnosticStyle);
-    diagnosticBuilder.CodeStyleCheck(t);
-    diagnosticBuilder.NameStyleCheck(t);
+    diagnosticBuilder.Check(t, nullptr);
     auto diagnostics = diagnosticBuilder.GetDiagnosticResults(t);
-    if (!diagnostics.empty()) {
-        std::cout << util::format("Check {}\t{} warning", inputPath, diagnostics.size()) << std::endl;
-
-        for (auto &d: diagnostics) {
-            DiagnosticInspection(d.Message, d.Range, file, inputPath);
-        }
-
-        return false;
+    entry.Diagnostics.reserve(diagnostics.size());
+    for (auto &d: diagnostics) {
+        entry.Diagnostics.push_back(DiagnosticInspection(d.Type, d.Message, d.Range, *file));
     }
-    return true;
+    entry.Truncated = diagnosticBuilder.IsTruncated();
+    entry.Ok = diagnostics.empty();
+    if (_cache) {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        _cache->Put(cacheKey, CacheEntry(entry));
+    }
+    return entry;
 }
 
-bool LuaFormat::CheckWorkspace() {
+bool LuaFormat::CheckSingleFile(std::string_view inputPath, std::string &&sourceText) {
+    auto entry = CheckSourceText(inputPath, std::move(sourceText));
+    _report.AddFile(inputPath, entry);
+    return entry.Ok;
+}
+
+FileFinder LuaFormat::CreateWorkspaceFinder() {
     FileFinder finder(_workspace);
     finder.AddFindExtension(".lua");
     finder.AddFindExtension(".lua.txt");
@@ -372,24 +583,97 @@ bool LuaFormat::CheckWorkspace() {
     finder.AddIgnoreDirectory(".idea");
     finder.AddIgnoreDirectory(".vs");
     finder.AddIgnoreDirectory(".vscode");
-    for (auto pattern: _ignorePattern) {
+    for (auto &pattern: _ignorePattern) {
         finder.AddignorePatterns(pattern);
     }
+    for (auto &line: _gitignorePattern) {
+        finder.AddGitignorePatterns(line);
+    }
+    return finder;
+}
 
-    auto files = finder.FindFiles();
-    for (auto &filePath: files) {
-        auto opText = ReadFile(filePath);
-        std::string displayPath = filePath;
-        if (!_workspace.empty()) {
-            displayPath = string_util::GetFileRelativePath(_workspace, filePath);
-        }
-        if (opText.has_value()) {
-            if (CheckSingleFile(displayPath, std::move(opText.value()))) {
-                std::cerr << util::format("Check {} ok.", displayPath) << std::endl;
+bool LuaFormat::CheckWorkspace() {
+    struct CheckResult {
+        std::string DisplayPath;
+        // 读取失败时为空
+        std::optional<CacheEntry> Entry;
+    };
+
+    // 输出按路径排序, 第一个路径要等遍历结束才能确定
+    auto files = CreateWorkspaceFinder().FindFiles();
+
+    auto checkThreads = _formatThreads;
+    if (checkThreads == 0) {
+        checkThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    checkThreads = std::min(checkThreads, files.size());
+
+    // 多个线程按序号领取文件, 结果放入重排缓冲区, 之前的文件全部完成后立即输出
+    // 领取的序号最多领先输出 PipelineQueueCapacity 个, 限制缓冲区中的结果数
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<std::size_t, CheckResult> pending;
+    std::size_t nextIndex = 0;
+    std::size_t outputIndex = 0;
+
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&] {
+                return nextIndex == files.size() || nextIndex < outputIndex + PipelineQueueCapacity;
+            });
+            if (nextIndex == files.size()) {
+                return;
             }
-        } else {
-            std::cerr << util::format("Can not read file {}", displayPath) << std::endl;
+            auto index = nextIndex++;
+            lock.unlock();
+
+            CheckResult result;
+            auto &filePath = files[index];
+            result.DisplayPath = filePath;
+            if (!_workspace.empty()) {
+                result.DisplayPath = string_util::GetFileRelativePath(_workspace, filePath);
+            }
+            auto opText = ReadFile(filePath);
+            if (opText.has_value()) {
+                result.Entry = CheckSourceText(result.DisplayPath, std::move(opText.value()));
+            }
+
+            lock.lock();
+            pending.emplace(index, std::move(result));
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i != checkThreads; i++) {
+        threads.emplace_back(worker);
+    }
+
+    for (std::size_t i = 0; i != files.size(); i++) {
+        CheckResult result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return pending.count(i) != 0; });
+            auto it = pending.find(i);
+            result = std::move(it->second);
+            pending.erase(it);
+            outputIndex = i + 1;
+        }
+        cv.notify_all();
+
+        if (!result.Entry.has_value()) {
+            std::cerr << util::format("Can not read file {}", result.DisplayPath) << std::endl;
+            continue;
         }
+        _report.AddFile(result.DisplayPath, result.Entry.value());
+        if (result.Entry->Ok && _report.GetFormat() == OutputFormat::Text) {
+            std::cerr << util::format("Check {} ok.", result.DisplayPath) << std::endl;
+        }
+    }
+
+    for (auto &thread: threads) {
+        thread.join();
     }
     return true;
 }
@@ -402,7 +686,7 @@ void LuaFormat::AddIgnoresByFile(std::string_view ignoreConfigFile) {
             std::getline(fin, line);
             auto newLine = string_util::TrimSpace(line);
             if (!string_util::StartWith(newLine, "#")) {
-                _ignorePattern.emplace_back(newLine);
+                _gitignorePattern.emplace_back(newLine);
             }
         }
     }
@@ -413,43 +697,119 @@ void LuaFormat::AddIgnores(std::string_view pattern) {
 }
 
 bool LuaFormat::ReformatWorkspace() {
-    FileFinder finder(_workspace);
-    finder.AddFindExtension(".lua");
-    finder.AddFindExtension(".lua.txt");
-    finder.AddIgnoreDirectory(".git");
-    finder.AddIgnoreDirectory(".github");
-    finder.AddIgnoreDirectory(".svn");
-    finder.AddIgnoreDirectory(".idea");
-    finder.AddIgnoreDirectory(".vs");
-    finder.AddIgnoreDirectory(".vscode");
-    for (auto pattern: _ignorePattern) {
-        finder.AddignorePatterns(pattern);
+    struct WorkspaceFile {
+        std::string Path;
+        std::string DisplayPath;
+        std::optional<std::string> Text;
+        FormatOutput Output;
+    };
+
+    auto formatThreads = _formatThreads;
+    if (formatThreads == 0) {
+        formatThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
     }
 
-    auto files = finder.FindFiles();
-    for (auto &filePath: files) {
-        auto opText = ReadFile(filePath);
-        std::string displayPath = filePath;
-        if (!_workspace.empty()) {
-            displayPath = string_util::GetFileRelativePath(_workspace, filePath);
+    // 遍历 -> 读取 -> 解析与格式化 -> 写出, 各阶段通过有界队列连接,
+    // 读取和写出的等待被格式化掩盖, 队列容量限制了同时驻留在内存中的文件数
+    BlockingQueue<std::string> paths(PipelineQueueCapacity);
+    BlockingQueue<WorkspaceFile> sources(PipelineQueueCapacity);
+    BlockingQueue<WorkspaceFile> outputs(PipelineQueueCapacity);
+
+    auto finder = CreateWorkspaceFinder();
+    std::vector<std::thread> threads;
+    threads.emplace_back([&finder, &paths]() {
+        finder.FindFiles([&paths](std::string &&filePath) {
+            paths.Push(std::move(filePath));
+        });
+        paths.Close();
+    });
+
+    // 每个阶段的最后一个线程结束时关闭下游队列
+    std::atomic<std::size_t> readers = PipelineReadThreads;
+    for (std::size_t i = 0; i != PipelineReadThreads; i++) {
+        threads.emplace_back([this, &paths, &sources, &readers]() {
+            std::string filePath;
+            while (paths.Pop(filePath)) {
+                WorkspaceFile file;
+                file.DisplayPath = filePath;
+                if (!_workspace.empty()) {
+                    file.DisplayPath = string_util::GetFileRelativePath(_workspace, filePath);
+                }
+                file.Text = ReadFile(filePath);
+                file.Path = std::move(filePath);
+                sources.Push(std::move(file));
+            }
+            if (--readers == 0) {
+                sources.Close();
+            }
+        });
+    }
+
+    std::atomic<std::size_t> formatters = formatThreads;
+    for (std::size_t i = 0; i != formatThreads; i++) {
+        threads.emplace_back([this, &sources, &outputs, &formatters]() {
+            WorkspaceFile file;
+            while (sources.Pop(file)) {
+                if (file.Text.has_value()) {
+                    file.Output = FormatSingleFile(file.DisplayPath, false, std::move(file.Text.value()));
+                }
+                outputs.Push(std::move(file));
+            }
+            if (--formatters == 0) {
+                outputs.Close();
+            }
+        });
+    }
+
+    // 文件写出不必等待, 输出信息按路径排序后一次写出, 保证结果与发现顺序无关
+    std::vector<std::pair<std::string, std::string>> messages;
+    bool allFormatted = true;
+    WorkspaceFile file;
+    while (outputs.Pop(file)) {
+        auto &displayPath = file.DisplayPath;
+        auto &message = messages.emplace_back(displayPath, std::string()).second;
+        if (!file.Text.has_value()) {
+            message = util::format("Can not read file {}\n", displayPath);
+            continue;
         }
-        if (opText.has_value()) {
-            if (ReformatSingleFile(displayPath, filePath, std::move(opText.value()))) {
-                std::cerr << util::format("Reformat {} succeed.", displayPath) << std::endl;
-            } else {
-                std::cerr << util::format("Reformat {} fail.", displayPath) << std::endl;
+
+        message = std::move(file.Output.Message);
+        if (_isCheckOnly) {
+            if (!file.Output.Ok) {
+                message.append(util::format("{} is not formatted.\n", displayPath));
+                allFormatted = false;
             }
+        } else if (file.Output.Ok) {
+            WriteFormattedText(file.Path, file.Output.Text, file.Output.Unchanged);
+            message.append(util::format("Reformat {} succeed.\n", displayPath));
         } else {
-            std::cerr << util::format("Can not read file {}", displayPath) << std::endl;
+            message.append(util::format("Reformat {} fail.\n", displayPath));
         }
     }
-    return true;
+
+    std::sort(messages.begin(), messages.end());
+    std::string out;
+    for (auto &[path, message]: messages) {
+        out.append(message);
+    }
+    std::cerr.write(out.data(), static_cast<std::streamsize>(out.size()));
+    std::cerr.flush();
+
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    return allFormatted;
 }
 
 void LuaFormat::SupportNameStyleCheck() {
     _diagnosticStyle.name_style_check = true;
 }
 
+void LuaFormat::SetDiagnosticLimit(std::size_t maxCount, std::size_t maxCountPerType) {
+    _diagnosticStyle.max_diagnostic_count = maxCount;
+    _diagnosticStyle.max_diagnostic_count_per_type = maxCountPerType;
+}
+
 void LuaFormat::SupportCompleteOutputRange() {
     _isCompleteOutputRangeFormat = true;
 }
@@ -462,3 +822,21 @@ void LuaFormat::SetFormatRange(bool rangeLine, std::string_view rangeStr) {
 void LuaFormat::SupportNonStandardLua() {
     _isSupportNonStandardLua = true;
 }
+
+void LuaFormat::SupportCheckOnly(bool showDiff) {
+    _isCheckOnly = true;
+    _isShowDiff = showDiff;
+}
+
+void LuaFormat::SetOutputFormat(OutputFormat format) {
+    _report.SetFormat(format);
+}
+
+void LuaFormat::SetFormatThreads(std::size_t threadCount) {
+    _formatThreads = threadCount;
+}
+
+void LuaFormat::SetCachePath(std::string_view cachePath) {
+    _cache = std::make_unique<ResultCache>(cachePath);
+    _cache->Load();
+}
@@ -4,9 +4,14 @@
 #include "CodeFormatCore/Config/LuaStyle.h"
 #include "LuaParser/File/LuaSource.h"
 #include "LuaParser/Types/TextRange.h"
+#include "DiagnosticReport.h"
+#include "ResultCache.h"
 #include "Types.h"
+#include "Util/FileFinder.h"
 #include <cstring>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -39,29 +44,73 @@ public:
 
     bool RangeReformat();
 
+    // gitignore 语法
     void AddIgnoresByFile(std::string_view ignoreFile);
 
+    // 通配符匹配相对路径, '*' 可以跨越 '/'
     void AddIgnores(std::string_view pattern);
 
     void SupportNameStyleCheck();
 
+    void SetDiagnosticLimit(std::size_t maxCount, std::size_t maxCountPerType);
+
     void SupportCompleteOutputRange();
 
     void SetFormatRange(bool rangeLine, std::string_view rangeStr);
 
     void SupportNonStandardLua();
+
+    void SetCachePath(std::string_view cachePath);
+
+    void SupportCheckOnly(bool showDiff);
+
+    void SetOutputFormat(OutputFormat format);
+
+    // 0 means the number of hardware threads
+    void SetFormatThreads(std::size_t threadCount);
 private:
+    // 工作区流水线中每个队列最多积压的文件数
+    static constexpr std::size_t PipelineQueueCapacity = 64;
+    // 读取线程数, 读取主要在等待 I/O, 网络文件系统上多个线程可以同时等待
+    static constexpr std::size_t PipelineReadThreads = 2;
+
+    struct FormatOutput {
+        // 格式化成功, check 模式下为已经格式化
+        bool Ok = false;
+        bool Unchanged = true;
+        std::string Text;
+        // 需要输出到 stderr 的信息
+        std::string Message;
+    };
+
     std::optional<std::string> ReadFile(std::string_view path);
 
+    std::shared_ptr<LuaEditorConfig> FindEditorConfig(std::string_view path);
+
     LuaStyle GetStyle(std::string_view path);
 
-    void DiagnosticInspection(std::string_view message, TextRange range, std::shared_ptr<LuaSource> file,
-                              std::string_view path);
+    // 结果缓存中选项部分的hash: 生成 style 的配置项以及影响结果的命令行参数
+    std::uint64_t GetOptionHash(CacheKind kind, std::string_view path);
+
+    static CacheDiagnostic DiagnosticInspection(DiagnosticType type, std::string_view message, TextRange range,
+                                                const LuaSource &file);
+
+    void SaveCache();
 
     bool ReformatSingleFile(std::string_view inputPath, std::string_view outPath, std::string&& sourceText);
 
+    // 不直接输出, 可以在多个线程中同时调用
+    FormatOutput FormatSingleFile(std::string_view inputPath, bool toStdout, std::string &&sourceText);
+
+    void WriteFormattedText(std::string_view outPath, std::string_view text, bool unchanged);
+
+    FileFinder CreateWorkspaceFinder();
+
     bool ReformatWorkspace();
 
+    // 不直接输出, 结果由调用者交给 _report, 可以在多个线程中同时调用
+    CacheEntry CheckSourceText(std::string_view inputPath, std::string &&sourceText);
+
     bool CheckSingleFile(std::string_view inputPath, std::string &&sourceText);
 
     bool CheckWorkspace();
@@ -73,11 +122,20 @@ private:
     std::string _outPath;
     std::vector<LuaConfig> _configs;
     LuaStyle _defaultStyle;
+    std::map<std::string, std::string, std::less<>> _defaultStyleConfig;
     LuaDiagnosticStyle _diagnosticStyle;
     std::vector<std::string> _ignorePattern;
+    std::vector<std::string> _gitignorePattern;
     // for range format
     bool _isCompleteOutputRangeFormat;
     bool _isRangeLine;
     std::string _rangeStr;
     bool _isSupportNonStandardLua;
+    std::unique_ptr<ResultCache> _cache;
+    bool _isCheckOnly;
+    bool _isShowDiff;
+    std::size_t _formatThreads;
+    DiagnosticReport _report;
+    std::mutex _cacheMutex;
+    std::mutex _styleMutex;
 };
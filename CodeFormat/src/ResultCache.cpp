@@ -0,0 +1,205 @@
+#include "ResultCache.h"
+#include <fstream>
+
+constexpr std::string_view CacheMagic = "EmmyLuaCodeStyleCache";
+
+// bump it when the layout of the cache file changes
+constexpr std::uint32_t CacheFormat = 3;
+
+constexpr std::uint64_t FnvPrime = 1099511628211ull;
+
+std::uint64_t ResultCache::Hash(std::string_view text, std::uint64_t seed) {
+    std::uint64_t hash = seed;
+    for (auto c: text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FnvPrime;
+    }
+    return hash;
+}
+
+std::uint64_t ResultCache::Mix(std::uint64_t hash, std::uint64_t value) {
+    for (std::size_t i = 0; i != sizeof(value); i++) {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= FnvPrime;
+    }
+    return hash;
+}
+
+std::uint64_t ResultCache::ConfigHash(const std::map<std::string, std::string, std::less<>> &configMap, std::uint64_t seed) {
+    auto hash = Mix(seed, configMap.size());
+    for (auto &[key, value]: configMap) {
+        hash = Mix(Hash(key, hash), key.size());
+        hash = Mix(Hash(value, hash), value.size());
+    }
+    return hash;
+}
+
+ResultCache::ResultCache(std::string_view cachePath)
+    : _cachePath(cachePath),
+      _hitCount(0),
+      _missCount(0) {
+}
+
+template<class T>
+static bool ReadValue(std::istream &in, T &value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+template<class T>
+static void WriteValue(std::ostream &out, T value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+static bool ReadString(std::istream &in, std::string &value) {
+    // 缓存中只有版本和诊断信息, 过长说明文件已损坏
+    constexpr std::uint32_t MaxStringSize = 64 * 1024;
+    std::uint32_t size = 0;
+    if (!ReadValue(in, size) || size > MaxStringSize) {
+        return false;
+    }
+    value.resize(size);
+    return static_cast<bool>(in.read(value.data(), size));
+}
+
+static void WriteString(std::ostream &out, std::string_view value) {
+    WriteValue(out, static_cast<std::uint32_t>(value.size()));
+    out.write(value.data(), value.size());
+}
+
+bool ResultCache::Load() {
+    std::fstream fin(_cachePath, std::ios::in | std::ios::binary);
+    if (!fin.is_open()) {
+        return false;
+    }
+
+    std::string magic;
+    std::string version;
+    std::uint32_t format = 0;
+    if (!ReadString(fin, magic) || magic != CacheMagic || !ReadValue(fin, format) || format != CacheFormat
+        || !ReadString(fin, version) || version != CodeFormatVersion) {
+        return false;
+    }
+
+    std::uint64_t count = 0;
+    if (!ReadValue(fin, count)) {
+        return false;
+    }
+
+    // 文件损坏时一条记录也不采用
+    std::unordered_map<std::uint64_t, Record> records;
+    for (std::uint64_t i = 0; i != count; i++) {
+        std::uint64_t key = 0;
+        std::uint8_t kind = 0;
+        std::uint8_t ok = 0;
+        std::uint8_t syntaxError = 0;
+        std::uint8_t truncated = 0;
+        std::uint32_t diagnosticCount = 0;
+        if (!ReadValue(fin, key) || !ReadValue(fin, kind) || kind >= static_cast<std::uint8_t>(CacheKind::Count) || !ReadValue(fin, ok) || !ReadValue(fin, syntaxError) || !ReadValue(fin, truncated) || !ReadValue(fin, diagnosticCount)) {
+            return false;
+        }
+        Record record;
+        record.Kind = static_cast<CacheKind>(kind);
+        record.Entry.Ok = ok != 0;
+        record.Entry.SyntaxError = syntaxError != 0;
+        record.Entry.Truncated = truncated != 0;
+        for (std::uint32_t j = 0; j != diagnosticCount; j++) {
+            auto &d = record.Entry.Diagnostics.emplace_back();
+            std::uint32_t startLine = 0;
+            std::uint32_t startChar = 0;
+            std::uint32_t endLine = 0;
+            std::uint32_t endChar = 0;
+            std::uint8_t type = 0;
+            if (!ReadValue(fin, startLine) || !ReadValue(fin, startChar) || !ReadValue(fin, endLine) || !ReadValue(fin, endChar) || !ReadValue(fin, type) || type > static_cast<std::uint8_t>(DiagnosticType::Spell) || !ReadString(fin, d.Message)) {
+                return false;
+            }
+            d.Type = static_cast<DiagnosticType>(type);
+            d.StartLine = startLine;
+            d.StartChar = startChar;
+            d.EndLine = endLine;
+            d.EndChar = endChar;
+        }
+        records.insert({key, std::move(record)});
+    }
+    _records = std::move(records);
+    return true;
+}
+
+bool ResultCache::Save(bool pruneUnused) {
+    std::fstream fout(_cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fout.is_open()) {
+        return false;
+    }
+
+    std::uint64_t count = 0;
+    for (auto &it: _records) {
+        if (!pruneUnused || !IsStale(it.second)) {
+            count++;
+        }
+    }
+
+    WriteString(fout, CacheMagic);
+    WriteValue(fout, CacheFormat);
+    WriteString(fout, CodeFormatVersion);
+    WriteValue(fout, count);
+    for (auto &[key, record]: _records) {
+        if (pruneUnused && IsStale(record)) {
+            continue;
+        }
+        auto &entry = record.Entry;
+        WriteValue(fout, key);
+        WriteValue(fout, static_cast<std::uint8_t>(record.Kind));
+        WriteValue(fout, static_cast<std::uint8_t>(entry.Ok));
+        WriteValue(fout, static_cast<std::uint8_t>(entry.SyntaxError));
+        WriteValue(fout, static_cast<std::uint8_t>(entry.Truncated));
+        WriteValue(fout, static_cast<std::uint32_t>(entry.Diagnostics.size()));
+        for (auto &d: entry.Diagnostics) {
+            WriteValue(fout, static_cast<std::uint32_t>(d.StartLine));
+            WriteValue(fout, static_cast<std::uint32_t>(d.StartChar));
+            WriteValue(fout, static_cast<std::uint32_t>(d.EndLine));
+            WriteValue(fout, static_cast<std::uint32_t>(d.EndChar));
+            WriteValue(fout, static_cast<std::uint8_t>(d.Type));
+            WriteString(fout, d.Message);
+        }
+    }
+    return static_cast<bool>(fout);
+}
+
+bool ResultCache::IsStale(const Record &record) const {
+    return _usedKinds[static_cast<std::size_t>(record.Kind)] && !record.Used;
+}
+
+CacheKey ResultCache::MakeKey(CacheKind kind, std::string_view text, std::uint64_t optionHash) const {
+    auto hash = Hash(CodeFormatVersion);
+    hash = Mix(hash, static_cast<std::uint64_t>(kind));
+    hash = Mix(hash, optionHash);
+    hash = Mix(hash, text.size());
+    return CacheKey{kind, Hash(text, hash)};
+}
+
+const CacheEntry *ResultCache::Find(const CacheKey &key) {
+    _usedKinds[static_cast<std::size_t>(key.Kind)] = true;
+    auto it = _records.find(key.Hash);
+    if (it == _records.end()) {
+        _missCount++;
+        return nullptr;
+    }
+    _hitCount++;
+    it->second.Used = true;
+    return &it->second.Entry;
+}
+
+void ResultCache::Put(const CacheKey &key, CacheEntry &&entry) {
+    _usedKinds[static_cast<std::size_t>(key.Kind)] = true;
+    auto &record = _records[key.Hash];
+    record.Kind = key.Kind;
+    record.Entry = std::move(entry);
+    record.Used = true;
+}
+
+std::size_t ResultCache::GetHitCount() const {
+    return _hitCount;
+}
+
+std::size_t ResultCache::GetMissCount() const {
+    return _missCount;
+}
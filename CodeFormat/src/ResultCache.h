@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CodeFormatVersion.h"
+#include "CodeFormatCore/Diagnostic/DiagnosticType.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class CacheKind : std::uint8_t {
+    Format,
+    Check,
+
+    Count
+};
+
+struct CacheKey {
+    CacheKind Kind = CacheKind::Format;
+    std::uint64_t Hash = 0;
+};
+
+struct CacheDiagnostic {
+    std::size_t StartLine = 0;
+    std::size_t StartChar = 0;
+    std::size_t EndLine = 0;
+    std::size_t EndChar = 0;
+    // syntax errors are None
+    DiagnosticType Type = DiagnosticType::None;
+    std::string Message;
+};
+
+struct CacheEntry {
+    // format: the source is already formatted
+    // check: the source has neither syntax error nor diagnostic
+    bool Ok = false;
+    bool SyntaxError = false;
+    bool Truncated = false;
+    std::vector<CacheDiagnostic> Diagnostics;
+};
+
+/*
+ * 以 (文件内容, 选项, 版本) 的hash为key的结果缓存
+ * 文件未改变时只需计算一次hash即可跳过格式化或检查
+ * 选项由调用者用配置文件的键值和命令行参数计算, 默认值和解析方式的变化由版本覆盖
+ */
+class ResultCache {
+public:
+    static std::uint64_t Hash(std::string_view text, std::uint64_t seed = 14695981039346656037ull);
+
+    static std::uint64_t Mix(std::uint64_t hash, std::uint64_t value);
+
+    static std::uint64_t ConfigHash(const std::map<std::string, std::string, std::less<>> &configMap, std::uint64_t seed);
+
+    explicit ResultCache(std::string_view cachePath);
+
+    bool Load();
+
+    // pruneUnused 时丢弃本次运行用到的种类中未被使用的记录, 其它种类的记录原样保留
+    bool Save(bool pruneUnused);
+
+    CacheKey MakeKey(CacheKind kind, std::string_view text, std::uint64_t optionHash) const;
+
+    const CacheEntry *Find(const CacheKey &key);
+
+    void Put(const CacheKey &key, CacheEntry &&entry);
+
+    std::size_t GetHitCount() const;
+
+    std::size_t GetMissCount() const;
+
+private:
+    struct Record {
+        CacheKind Kind = CacheKind::Format;
+        CacheEntry Entry;
+        bool Used = false;
+    };
+
+    bool IsStale(const Record &record) const;
+
+    std::string _cachePath;
+    std::unordered_map<std::uint64_t, Record> _records;
+    bool _usedKinds[static_cast<std::size_t>(CacheKind::Count)] = {};
+    std::size_t _hitCount;
+    std::size_t _missCount;
+};
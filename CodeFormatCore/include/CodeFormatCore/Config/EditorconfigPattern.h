@@ -1,6 +1,8 @@
 #pragma once
 
+#include "GlobAutomaton.h"
 #include "LuaParser/Lexer/TextReader.h"
+#include <cstdint>
 #include <set>
 #include <string>
 #include <string_view>
@@ -31,19 +33,34 @@ public:
         std::string_view String;
         std::vector<std::string_view> Strings;
         std::set<char> CharSet;
+        std::int64_t Min = 0;
+        std::int64_t Max = 0;
     };
 
     EditorconfigPattern();
 
+    // _matches 引用 _patternSource, 短字符串移动后地址会变, 所以复制时重新编译
+    EditorconfigPattern(const EditorconfigPattern &other);
+
+    EditorconfigPattern &operator=(const EditorconfigPattern &other);
+
     void Compile(std::string_view pattern);
 
     bool Match(std::string_view path);
 
-    std::string_view GetPattern();
+    // 回溯解释执行, 模式过于复杂而无法编译为自动机时使用
+    bool InterpretMatch(std::string_view path);
+
+    // 把模式作为 id 加入自动机, 多个模式可以合并到同一个自动机
+    void AddTo(GlobAutomaton &automaton, std::size_t id) const;
+
+    std::string_view GetPattern() const;
 
 private:
     MatchType Lex(TextReader &reader);
 
     std::string _patternSource;
     std::vector<MatchData> _matches;
+    GlobAutomaton _automaton;
+    bool _automatonCompiled;
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+ * 把一组 glob 编译为一个确定有限自动机
+ * 模式按片段依次添加, 构建时先得到 NFA, 再按字节等价类做子集构造
+ * 匹配时每个字节只查一次表, 不分配内存, 结果为路径末尾能匹配的所有模式 id
+ * '\\' 与 '/' 属于同一个字节类, 因此路径不需要预先规范化
+ */
+class GlobAutomaton {
+public:
+    static constexpr std::size_t DefaultMaxStates = 4096;
+
+    GlobAutomaton();
+
+    void BeginPattern(std::size_t id);
+
+    void Literal(std::string_view text);
+
+    // *
+    void AnyCharsExceptSep();
+
+    // **
+    void AnyChars();
+
+    // ? [abc] [!abc]
+    void CharOf(std::string_view chars, bool negate);
+
+    // {a,b,c}
+    void StringOf(const std::vector<std::string_view> &strings);
+
+    // {1..3}
+    void NumRange(std::int64_t min, std::int64_t max);
+
+    void EndPattern();
+
+    // 状态数超过 maxStates 时失败, 调用方应退回到其他匹配方式
+    bool Build(std::size_t maxStates = DefaultMaxStates);
+
+    bool IsBuilt() const;
+
+    // 匹配的模式 id, 按添加顺序升序
+    const std::vector<std::size_t> &Match(std::string_view path) const;
+
+    std::size_t GetStateCount() const;
+
+private:
+    using CharSet = std::bitset<256>;
+
+    struct NfaState {
+        std::vector<std::pair<std::size_t, std::uint32_t>> Edges;
+        std::vector<std::uint32_t> Epsilons;
+        std::vector<std::size_t> Accepts;
+    };
+
+    std::uint32_t NewState();
+
+    void AddEdge(std::uint32_t from, const CharSet &charSet, std::uint32_t to);
+
+    void Closure(std::vector<std::uint32_t> &states, std::vector<bool> &visited) const;
+
+    std::vector<NfaState> _nfa;
+    std::vector<CharSet> _charSets;
+    std::uint32_t _current;
+    std::size_t _currentId;
+    bool _tooComplex;
+
+    std::array<std::uint8_t, 256> _byteClass;
+    std::size_t _classCount;
+    std::vector<std::uint32_t> _table;
+    std::vector<std::vector<std::size_t>> _accepts;
+};
@@ -19,6 +19,11 @@ public:
 
     bool spell_check = true;
 
+    // 0 means no limit, once the limit is reached the analysis stops and the results are truncated
+    std::size_t max_diagnostic_count = 0;
+
+    std::size_t max_diagnostic_count_per_type = 0;
+
     std::vector<NameStyleRule> local_name_style = {NameStyleRule(NameStyleType::SnakeCase)};
 
     std::vector<NameStyleRule> function_param_name_style = {NameStyleRule(NameStyleType::SnakeCase)};
@@ -26,9 +26,26 @@ public:
 
     LuaStyle &Generate(std::string_view fileUri);
 
+    // 依次 Parse 这些配置即得到 Generate 的结果
+    std::vector<const std::map<std::string, std::string, std::less<>> *> GetConfigMaps(std::string_view fileUri);
+
+    const std::vector<Section> &GetSections() const;
+
 private:
+    // 收集需要匹配的 section, 没有配置项的 section 不影响结果
+    void CompileSections();
+
+    // 匹配的 section 下标, 按配置文件中的顺序
+    std::vector<std::size_t> MatchSections(const std::string &path);
 
     std::string _source;
     std::vector<Section> _sections;
+    // [*] [*.lua] 总是匹配
+    std::vector<std::size_t> _commonSections;
+    std::vector<std::size_t> _patternSections;
+    // 所有 _patternSections 合并成的自动机, id 为 section 下标
+    GlobAutomaton _sectionAutomaton;
     std::map<std::string, LuaStyle, std::less<>> _styleMap;
+    // 规范化路径 => _styleMap 中的 style, 配置更新时整个对象会被替换
+    std::map<std::string, LuaStyle *, std::less<>> _pathStyleCache;
 };
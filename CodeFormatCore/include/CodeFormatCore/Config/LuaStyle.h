@@ -154,6 +154,8 @@ public:
 
     bool break_before_braces = false;
 
+    bool layout_line_break = false;
+
     BreakTableList break_table_list = BreakTableList::Smart;
     // [preference]
     bool ignore_space_after_colon = false;
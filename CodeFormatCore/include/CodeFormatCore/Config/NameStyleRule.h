@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Util/CompiledRegex.h"
+#include <memory>
 #include <regex>
 #include <string>
 #include <set>
@@ -48,6 +50,8 @@ struct PatternNameStyleData : public NameStyleData {
         NameStyleType Rule;
     };
 
+    // 优先使用线性时间的 Compiled, 语法不支持时才编译 Re
+    std::shared_ptr<CompiledRegex> Compiled;
     std::regex Re;
     std::string PatternString;
     std::vector<Group> GroupRules;
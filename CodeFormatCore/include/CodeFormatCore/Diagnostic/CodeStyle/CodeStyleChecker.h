@@ -4,6 +4,7 @@
 #include "CodeFormatCore/Config/NameStyleRule.h"
 #include "CodeFormatCore/Format/FormatState.h"
 #include "LuaParser/Ast/LuaSyntaxTree.h"
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
@@ -13,12 +14,17 @@ class DiagnosticBuilder;
 
 class CodeStyleChecker {
 public:
+    // 遍历到的每个节点都会转发给订阅者, 其它检查可以复用这次遍历
+    using NodeHandle = std::function<void(LuaSyntaxNode &node, const LuaSyntaxTree &t)>;
+
     CodeStyleChecker();
 
     void Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t);
 
+    void Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t, const NodeHandle &subscriber);
+
 private:
-    void BasicStyleCheck(DiagnosticBuilder &d, const LuaSyntaxTree &t);
+    void BasicStyleCheck(DiagnosticBuilder &d, const LuaSyntaxTree &t, const NodeHandle &subscriber);
 
     void
     BasicResolve(LuaSyntaxNode syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve, DiagnosticBuilder &d);
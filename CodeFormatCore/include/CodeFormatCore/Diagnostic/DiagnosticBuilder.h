@@ -6,6 +6,9 @@
 #include "DiagnosticType.h"
 #include "NameStyle/NameStyleChecker.h"
 #include "Spell/CodeSpellChecker.h"
+#include <map>
+#include <optional>
+#include <set>
 
 class DiagnosticBuilder {
 public:
@@ -17,8 +20,23 @@ public:
 
     void SpellCheck(const LuaSyntaxTree &t, CodeSpellChecker& spellChecker);
 
+    // 代码风格检查只遍历一次语法树, 拼写检查订阅遍历中的 token, 结果与依次调用上面三个检查相同
+    // spellChecker 为空时不做拼写检查
+    void Check(const LuaSyntaxTree &t, CodeSpellChecker *spellChecker);
+
+    // 开启后 Check 让拼写和命名检查在其它线程与代码风格检查并发执行, 结果仍与串行相同
+    void SetParallelCheck(bool parallel);
+
     std::vector<LuaDiagnostic> GetDiagnosticResults(const LuaSyntaxTree &t);
 
+    // only check the lines [startLine, endLine]
+    void SetDiagnosticRange(const LuaSyntaxTree &t, std::size_t startLine, std::size_t endLine);
+
+    bool IsInDiagnosticRange(TextRange range) const;
+
+    // 范围之前的对齐组和忽略注释不会被遍历到, 需要在遍历前处理
+    void ResolveBeforeDiagnosticRange(const LuaSyntaxTree &t);
+
     void PushDiagnostic(DiagnosticType type,
                         std::size_t leftIndex,
                         TextRange range,
@@ -33,11 +51,32 @@ public:
 
     void ClearDiagnostic(std::size_t leftIndex);
 
+    // some diagnostics have been dropped because of max_diagnostic_count or max_diagnostic_count_per_type
+    bool IsTruncated() const;
+
+    bool IsLimitExceeded(DiagnosticType type) const;
+
     FormatState& GetState();
 private:
+    bool AcceptDiagnostic(DiagnosticType type);
+
+    void ParallelCheck(const LuaSyntaxTree &t, CodeSpellChecker *spellChecker);
+
+    // 按顺序重新走一遍数量限制, 与这些诊断当初直接提交的结果相同
+    void SubmitDiagnostics(std::vector<LuaDiagnostic> &diagnostics);
 
     LuaDiagnosticStyle _diagnosticStyle;
     FormatState _state;
     std::map<std::size_t, LuaDiagnostic> _nextDiagnosticMap;
     std::vector<LuaDiagnostic> _diagnostics;
+    std::size_t _diagnosticCount;
+    std::map<DiagnosticType, std::size_t> _typeCounts;
+    bool _isTotalExceeded;
+    std::set<DiagnosticType> _exceededTypes;
+    std::optional<TextRange> _diagnosticRange;
+    std::size_t _rangeStartIndex;
+    // 合并遍历时拼写检查的结果先暂存, 代码风格检查结束后再按原顺序提交, 保证计数和截断行为不变
+    std::optional<DiagnosticType> _deferredType;
+    std::vector<LuaDiagnostic> _deferredDiagnostics;
+    bool _parallelCheck;
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "CodeFormatCore/Config/NameStyleRule.h"
 #include "LuaParser/Ast/LuaSyntaxTree.h"
 #include "NameDefineType.h"
+#include "ScopeChain.h"
+#include "SymbolPool.h"
 #include <map>
 #include <set>
 #include <string>
@@ -44,7 +46,9 @@ private:
                                    const LuaSyntaxTree &t,
                                    const std::vector<NameStyleRule> &rules);
 
-    std::string _module;
-    std::vector<std::set<std::string, std::less<>>> _scopeStack;
+    std::string_view _module;
+    // 名字驻留为指向源码的 id, 作用域链按 id 记录局部变量
+    SymbolPool _symbols;
+    ScopeChain _scopes;
     std::vector<NameStyleInfo> _nameStyleCheckVector;
 };
@@ -20,4 +20,6 @@ private:
     static bool PascalCase(std::string_view text);
 
     static bool PatternMatch(std::string_view text, std::shared_ptr<PatternNameStyleData> data);
+
+    static bool GroupMatch(NameStyleType rule, std::string_view text);
 };
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * 局部变量的作用域链, 符号是 SymbolPool 分配的 id
+ * 每个符号记录当前可见的声明次数, 判断一个名字是否是局部变量只需 O(1)
+ * 所有作用域的声明按顺序记在同一个数组里, 退出作用域时撤销本作用域的声明
+ */
+class ScopeChain {
+public:
+    ScopeChain();
+
+    void EnterScope();
+
+    void ExitScope();
+
+    void Declare(std::uint32_t symbol);
+
+    bool IsDeclared(std::uint32_t symbol) const;
+
+    std::size_t GetDepth() const;
+
+private:
+    std::vector<std::uint32_t> _visibleCount;
+    std::vector<std::uint32_t> _declared;
+    std::vector<std::size_t> _scopeStart;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+ * 名字驻留池, 只保存指向源码的 string_view, 不复制文本, 源码必须比池活得久
+ * 相同文本得到相同的 id, id 从 0 开始连续分配
+ */
+class SymbolPool {
+public:
+    static constexpr std::uint32_t NotFound = 0xffffffff;
+
+    SymbolPool();
+
+    std::uint32_t Intern(std::string_view name);
+
+    std::uint32_t Find(std::string_view name) const;
+
+    std::string_view GetName(std::uint32_t id) const;
+
+    std::size_t GetSize() const;
+
+private:
+    static std::uint32_t Hash(std::string_view name);
+
+    void Rehash();
+
+    std::vector<std::string_view> _names;
+    std::vector<std::uint32_t> _hashes;
+    // 线性探测的开放寻址表, 存放 id + 1, 0 表示空槽位
+    std::vector<std::uint32_t> _slots;
+};
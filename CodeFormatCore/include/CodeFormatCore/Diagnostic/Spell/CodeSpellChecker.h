@@ -3,8 +3,11 @@
 #include "LuaParser/Ast/LuaSyntaxTree.h"
 #include "Util/StringUtil.h"
 #include "Util/SymSpell/SymSpell.h"
+#include "SpellResultCache.h"
 #include "Util.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -25,14 +28,27 @@ public:
 
     void Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t);
 
+    // 检查单个 token, 供合并遍历使用
+    void TokenAnalyze(DiagnosticBuilder &d, LuaSyntaxNode &token, const LuaSyntaxTree &t);
+
     // copy once
     std::vector<SuggestItem> GetSuggests(std::string word);
 
+    SpellResultCache::Statistics GetCacheStatistics() const;
+
 private:
+    // word 必须是小写
+    bool IsCorrectWord(std::string_view word);
+
     void IdentifyAnalyze(DiagnosticBuilder &d, LuaSyntaxNode &token, const LuaSyntaxTree &t);
 
     void TextAnalyze(DiagnosticBuilder &d, LuaSyntaxNode &token, const LuaSyntaxTree &t);
 
     std::shared_ptr<SymSpell> _symSpell;
     CustomDictionary _dictionary;
+    // 词典或自定义词典变化时递增, 缓存中旧代数的结果随之失效
+    std::atomic<std::uint64_t> _generation;
+    SpellResultCache _cache;
+    // SymSpell 首次查询时才生成删除串, 查询需要串行
+    std::mutex _lookUpMutex;
 };
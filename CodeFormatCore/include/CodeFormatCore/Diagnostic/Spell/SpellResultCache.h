@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Util/SymSpell/SuggestItem.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * 按词缓存拼写检查结果, 可以多线程同时访问
+ * 按词的 hash 分片加锁, 每个分片独立做 LRU 淘汰
+ * 结果带有词典代数, 词典变化后旧结果视为未命中
+ */
+class SpellResultCache {
+public:
+    static constexpr std::size_t DefaultCapacity = 65536;
+
+    struct Statistics {
+        std::uint64_t Hits = 0;
+        std::uint64_t Misses = 0;
+        std::size_t Size = 0;
+
+        double HitRate() const;
+    };
+
+    explicit SpellResultCache(std::size_t capacity = DefaultCapacity);
+
+    SpellResultCache(const SpellResultCache &) = delete;
+
+    SpellResultCache &operator=(const SpellResultCache &) = delete;
+
+    bool FindCorrect(std::string_view word, std::uint64_t generation, bool &correct);
+
+    bool FindSuggests(std::string_view word, std::uint64_t generation, std::vector<SuggestItem> &suggests);
+
+    void PutCorrect(std::string_view word, std::uint64_t generation, bool correct);
+
+    void PutSuggests(std::string_view word, std::uint64_t generation, const std::vector<SuggestItem> &suggests);
+
+    void Clear();
+
+    Statistics GetStatistics() const;
+
+private:
+    static constexpr std::size_t ShardCount = 16;
+
+    enum class WordState {
+        Unknown,
+        Correct,
+        Misspelled
+    };
+
+    struct Entry {
+        std::string Word;
+        std::uint64_t Generation = 0;
+        WordState State = WordState::Unknown;
+        bool HasSuggests = false;
+        std::vector<SuggestItem> Suggests;
+    };
+
+    // 链表头部是最近使用的词, 索引的 key 指向链表节点中的字符串
+    struct Shard {
+        mutable std::mutex Mutex;
+        std::list<Entry> Entries;
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> Index;
+    };
+
+    Shard &GetShard(std::string_view word);
+
+    // 返回当前代数的条目, 不存在或已过期时返回 nullptr, 调用时必须持有分片锁
+    Entry *Find(Shard &shard, std::string_view word, std::uint64_t generation);
+
+    // 查找或创建当前代数的条目, 调用时必须持有分片锁
+    Entry &FindOrInsert(Shard &shard, std::string_view word, std::uint64_t generation);
+
+    std::size_t _shardCapacity;
+    std::array<Shard, ShardCount> _shards;
+    std::atomic<std::uint64_t> _hits;
+    std::atomic<std::uint64_t> _misses;
+};
@@ -14,6 +14,11 @@ public:
 
     void Query(FormatState &f, LuaSyntaxNode syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve) override;
 
+    // 局部格式化时不会遍历到起始节点在index之前的对齐组
+    void ResolveGroupBefore(FormatState &f, std::size_t index, const LuaSyntaxTree &t);
+
+    const std::vector<AlignGroup> &GetAlignGroups() const;
+
 private:
     void PushAlignGroup(AlignStrategy strategy, std::vector<std::size_t> &data);
 
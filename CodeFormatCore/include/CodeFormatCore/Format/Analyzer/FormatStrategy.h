@@ -64,7 +64,8 @@ struct IndentData {
 enum class LineBreakStrategy {
     Standard,
     WhenMayExceed,
-    NotBreak
+    NotBreak,
+    Layout
 };
 
 struct LineBreakData {
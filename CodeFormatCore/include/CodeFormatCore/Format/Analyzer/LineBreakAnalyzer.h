@@ -47,5 +47,7 @@ private:
 
     bool CanCollapseLines(FormatState &f, LuaSyntaxNode &n, const LuaSyntaxTree &t);
 
+    void AnalyzeLayout(FormatState &f, const LuaSyntaxTree &t);
+
     std::unordered_map<std::size_t, LineBreakData> _lineBreaks;
 };
\ No newline at end of file
@@ -29,6 +29,8 @@ public:
 
     void SpaceIgnore(LuaSyntaxNode n);
 
+    std::size_t ProcessSpace(LuaSyntaxNode left, LuaSyntaxNode right, const LuaSyntaxTree &t);
+
 private:
     // workaround for mac 10.13
     struct OptionalInt {
@@ -52,8 +54,6 @@ private:
 
     OptionalInt GetRightSpace(LuaSyntaxNode n) const;
 
-    std::size_t ProcessSpace(LuaSyntaxNode left, LuaSyntaxNode right, const LuaSyntaxTree &t);
-
     std::unordered_map<std::size_t, SpaceData> _rightSpaces;
     std::unordered_set<std::size_t> _ignoreSpace;
 };
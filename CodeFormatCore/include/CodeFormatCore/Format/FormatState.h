@@ -5,6 +5,7 @@
 #include "Analyzer/FormatAnalyzer.h"
 #include "Types.h"
 #include <array>
+#include <optional>
 
 class FormatState {
 public:
@@ -63,6 +64,11 @@ public:
 
     void Analyze(const LuaSyntaxTree &t);
 
+    // 只分析这些节点, 默认分析整个文件
+    void SetAnalyzeNodes(std::vector<LuaSyntaxNode> &&nodes);
+
+    const std::vector<LuaSyntaxNode> &GetAnalyzeNodes(const LuaSyntaxTree &t) const;
+
     // 深度优先处理格式
     void DfsForeach(std::vector<LuaSyntaxNode> &startNodes,
                     const LuaSyntaxTree &t,
@@ -70,6 +76,9 @@ public:
 
     void StopDfsForeach();
 
+    // DfsForeach skips the subtrees which do not intersect with the range
+    void SetTraverseRange(TextRange range);
+
     Mode GetMode() const;
 
     void Notify(FormatEvent event, LuaSyntaxNode n, const LuaSyntaxTree &t);
@@ -83,5 +92,7 @@ private:
     Mode _mode;
     IndexRange _ignoreRange;
     bool _foreachContinue;
+    std::optional<TextRange> _traverseRange;
+    std::optional<std::vector<LuaSyntaxNode>> _analyzeNodes;
     std::array<std::unique_ptr<FormatAnalyzer>, static_cast<std::size_t>(FormatAnalyzerType::Count)> _analyzers;
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdlib>
+#include <vector>
+
+/*
+ * Oppen/Wadler 风格的行布局
+ * 文档由文本, 可选断点, 换行与分组组成, 断点的长度是它到同层或外层下一个断点(或换行)之间的平铺宽度,
+ * 当前行放不下这段内容时才打断, 嵌套分组因此优先保持平铺
+ * 断点长度由一次栈扫描求出, 每个断点只入栈出栈一次, 布局再顺序扫描一遍, 总体 O(n)
+ */
+class LineLayout {
+public:
+    explicit LineLayout(std::size_t maxLineWidth);
+
+    void Text(std::size_t width);
+
+    // 可选断点, 不打断时宽度为 flatWidth
+    void Line(std::size_t id, std::size_t flatWidth = 1);
+
+    // 已经存在的换行, 换行后位于 column 列, newIndent 表示该列同时作为之后分组缩进的基准
+    void HardLine(std::size_t column, bool newIndent = true);
+
+    // 必须换行, 换行后按所在分组缩进
+    void ForceLine();
+
+    // 分组内断点打断后相对分组开始时所在行的缩进
+    void GroupBegin(std::size_t indent);
+
+    void GroupEnd();
+
+    // 返回需要打断的断点 id, 按出现顺序
+    std::vector<std::size_t> Layout(std::size_t startColumn = 0) const;
+
+private:
+    enum class ItemKind {
+        Text,
+        Line,
+        HardLine,
+        ForceLine,
+        GroupBegin,
+        GroupEnd
+    };
+
+    struct Item {
+        Item(ItemKind kind, std::size_t value, std::size_t extra = 0)
+            : Kind(kind), Value(value), Extra(extra) {}
+
+        ItemKind Kind;
+        std::size_t Value;
+        std::size_t Extra;
+    };
+
+    std::size_t _maxLineWidth;
+    std::vector<Item> _items;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "FormatBuilder.h"
+
+/*
+ * 文件内并行格式化
+ * 在根语句块的安全边界(不被对齐组或 format disable 范围跨越, 且前后语句不在同一行)处切分,
+ * 每块使用独立的 FormatState 并发格式化, 再按顺序拼接, 结果与串行格式化逐字节一致
+ */
+class ParallelFormatBuilder : public FormatBuilder {
+public:
+    // threadCount 为 0 时使用硬件线程数, 每块至少包含 minChunkSize 个语法节点
+    explicit ParallelFormatBuilder(LuaStyle &style, std::size_t threadCount = 0, std::size_t minChunkSize = 4096);
+
+    std::string GetFormatResult(const LuaSyntaxTree &t) override;
+
+    // 最近一次格式化实际切分的块数, 1 表示回退到串行
+    std::size_t GetChunkCount() const;
+
+private:
+    // 返回每块第一个根语句在根语句块子节点中的位置
+    std::vector<std::size_t> SplitChunks(std::vector<LuaSyntaxNode> &children, const LuaSyntaxTree &t);
+
+    std::size_t _threadCount;
+    std::size_t _minChunkSize;
+    std::size_t _chunkCount;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "FormatBuilder.h"
+
+/*
+ * 不生成完整的格式化结果, 而是在写入时逐行与源码比较, 遇到第一个不同的字节即停止
+ */
+class VerifyFormatBuilder : public FormatBuilder {
+public:
+    explicit VerifyFormatBuilder(LuaStyle &style);
+
+    // return true if the source is already formatted
+    bool IsFormatted(const LuaSyntaxTree &t);
+
+    // offset in the source of the first differing byte, valid when IsFormatted return false
+    std::size_t GetDiffOffset() const;
+
+protected:
+    void WriteLine(std::size_t line) override;
+
+private:
+    void Verify(bool finish);
+
+    std::string_view _source;
+    std::size_t _verifiedOffset;
+    bool _isDiff;
+};
@@ -2,6 +2,10 @@
 
 #include "CodeFormatCore/Format/FormatBuilder.h"
 
+/*
+ * 只格式化范围所在的语句, 起始缩进取自原文
+ * 原文已经格式化时结果与全文格式化一致, 否则可能不同
+ */
 class RangeFormatBuilder : public FormatBuilder {
 public:
     enum class Valid {
@@ -31,6 +35,14 @@ protected:
 private:
     void CheckRange(LuaSyntaxNode &syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve);
 
+    // 范围所在的语句, 只分析和格式化这些语句, 缩进和起始列从原文推导
+    std::vector<LuaSyntaxNode> CollectLocalNodes(const LuaSyntaxTree &t);
+
+    void CollectInlineComments(LuaSyntaxNode firstNode, LuaSyntaxNode lastNode, const LuaSyntaxTree &t,
+                               std::vector<LuaSyntaxNode> &analyzeNodes);
+
+    std::size_t GetSourceWidth(std::string_view text) const;
+
     Valid _validRange;
     FormatRange _range;
 };
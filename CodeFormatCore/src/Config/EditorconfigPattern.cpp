@@ -4,10 +4,26 @@
 #include "Util/StringUtil.h"
 
 
-EditorconfigPattern::EditorconfigPattern() {
+EditorconfigPattern::EditorconfigPattern()
+    : _automatonCompiled(false) {
 
 }
 
+EditorconfigPattern::EditorconfigPattern(const EditorconfigPattern &other)
+    : _automatonCompiled(false) {
+    Compile(other._patternSource);
+}
+
+EditorconfigPattern &EditorconfigPattern::operator=(const EditorconfigPattern &other) {
+    if (this != &other) {
+        _matches.clear();
+        _automaton = GlobAutomaton();
+        _automatonCompiled = false;
+        Compile(other._patternSource);
+    }
+    return *this;
+}
+
 void EditorconfigPattern::Compile(std::string_view pattern) {
     _patternSource = pattern;
     TextReader reader(_patternSource);
@@ -45,6 +61,13 @@ void EditorconfigPattern::Compile(std::string_view pattern) {
                 }
                 break;
             }
+            case MatchType::NumRange: {
+                text = text.substr(1, text.size() - 2);
+                auto pos = text.find("..");
+                matchData.Min = std::stoll(std::string(text.substr(0, pos)));
+                matchData.Max = std::stoll(std::string(text.substr(pos + 2)));
+                break;
+            }
             default: {
                 break;
             }
@@ -52,6 +75,26 @@ void EditorconfigPattern::Compile(std::string_view pattern) {
     }
 }
 
+// {1..3} {-1..1}
+static bool IsNumRange(std::string_view text) {
+    if (text.size() < 2) {
+        return false;
+    }
+    text = text.substr(1, text.size() - 2);
+    auto pos = text.find("..");
+    if (pos == std::string_view::npos) {
+        return false;
+    }
+    auto isInteger = [](std::string_view s) {
+        if (!s.empty() && s.front() == '-') {
+            s = s.substr(1);
+        }
+        // 超过 18 位可能溢出
+        return !s.empty() && s.size() <= 18 && std::all_of(s.begin(), s.end(), [](char c) { return c >= '0' && c <= '9'; });
+    };
+    return isInteger(text.substr(0, pos)) && isInteger(text.substr(pos + 2));
+}
+
 EditorconfigPattern::MatchType EditorconfigPattern::Lex(TextReader &reader) {
     reader.ResetBuffer();
     int ch = reader.GetCurrentChar();
@@ -74,6 +117,9 @@ EditorconfigPattern::MatchType EditorconfigPattern::Lex(TextReader &reader) {
                     break;
                 }
             }
+            if (IsNumRange(reader.GetSaveText())) {
+                return MatchType::NumRange;
+            }
             return MatchType::StringOf;
         }
         case '[': {
@@ -116,6 +162,22 @@ EditorconfigPattern::MatchType EditorconfigPattern::Lex(TextReader &reader) {
 }
 
 bool EditorconfigPattern::Match(std::string_view filePath) {
+    if (filePath.empty()) {
+        return false;
+    }
+    // 第一次匹配时才构建, 合并到 section 自动机的模式不需要自己的自动机
+    if (!_automatonCompiled) {
+        AddTo(_automaton, 0);
+        _automaton.Build();
+        _automatonCompiled = true;
+    }
+    if (_automaton.IsBuilt()) {
+        return !_automaton.Match(filePath).empty();
+    }
+    return InterpretMatch(filePath);
+}
+
+bool EditorconfigPattern::InterpretMatch(std::string_view filePath) {
     if (filePath.empty()) {
         return false;
     }
@@ -224,6 +286,23 @@ bool EditorconfigPattern::Match(std::string_view filePath) {
                 }
                 break;
             }
+            case MatchType::NumRange: {
+                auto numStart = pathView.find_last_not_of("0123456789");
+                numStart = numStart == std::string_view::npos ? 0 : numStart + 1;
+                if (numStart > 0 && pathView[numStart - 1] == '-') {
+                    numStart--;
+                }
+                auto number = pathView.substr(numStart);
+                if (number.empty() || number == "-" || number.size() > 18) {
+                    return false;
+                }
+                auto value = std::stoll(std::string(number));
+                if (value < matchData.Min || value > matchData.Max) {
+                    return false;
+                }
+                pathView = pathView.substr(0, numStart);
+                break;
+            }
             default: {
                 return false;
             }
@@ -233,7 +312,49 @@ bool EditorconfigPattern::Match(std::string_view filePath) {
     return matchProcess == 0;
 }
 
-std::string_view EditorconfigPattern::GetPattern() {
+void EditorconfigPattern::AddTo(GlobAutomaton &automaton, std::size_t id) const {
+    automaton.BeginPattern(id);
+    for (auto &matchData: _matches) {
+        switch (matchData.Type) {
+            case MatchType::Path: {
+                automaton.Literal(matchData.String);
+                break;
+            }
+            case MatchType::AnyCharsExceptSep: {
+                automaton.AnyCharsExceptSep();
+                break;
+            }
+            case MatchType::AnyChars: {
+                automaton.AnyChars();
+                break;
+            }
+            case MatchType::AnyChar: {
+                automaton.CharOf("", true);
+                break;
+            }
+            case MatchType::AnyCharOf:
+            case MatchType::NotCharOf: {
+                std::string chars(matchData.CharSet.begin(), matchData.CharSet.end());
+                automaton.CharOf(chars, matchData.Type == MatchType::NotCharOf);
+                break;
+            }
+            case MatchType::StringOf: {
+                automaton.StringOf(matchData.Strings);
+                break;
+            }
+            case MatchType::NumRange: {
+                automaton.NumRange(matchData.Min, matchData.Max);
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+    automaton.EndPattern();
+}
+
+std::string_view EditorconfigPattern::GetPattern() const {
     return _patternSource;
 }
 
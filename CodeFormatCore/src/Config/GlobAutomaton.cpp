@@ -0,0 +1,230 @@
+#include "CodeFormatCore/Config/GlobAutomaton.h"
+#include <algorithm>
+#include <map>
+#include <string>
+
+// 展开 {min..max} 的上限, 更大的范围认为过于复杂
+constexpr std::int64_t MaxNumRange = 4096;
+
+static unsigned char NormalizeChar(unsigned char ch) {
+    return ch == '\\' ? '/' : ch;
+}
+
+GlobAutomaton::GlobAutomaton()
+    : _current(0),
+      _currentId(0),
+      _tooComplex(false),
+      _byteClass(),
+      _classCount(0) {
+    // 起始状态吃掉任意前缀, 模式只需要匹配路径的末尾
+    NewState();
+    CharSet all;
+    all.set();
+    AddEdge(0, all, 0);
+}
+
+std::uint32_t GlobAutomaton::NewState() {
+    _nfa.emplace_back();
+    return static_cast<std::uint32_t>(_nfa.size() - 1);
+}
+
+void GlobAutomaton::AddEdge(std::uint32_t from, const GlobAutomaton::CharSet &charSet, std::uint32_t to) {
+    auto it = std::find(_charSets.begin(), _charSets.end(), charSet);
+    auto index = static_cast<std::size_t>(it - _charSets.begin());
+    if (it == _charSets.end()) {
+        _charSets.push_back(charSet);
+    }
+    _nfa[from].Edges.emplace_back(index, to);
+}
+
+void GlobAutomaton::BeginPattern(std::size_t id) {
+    _currentId = id;
+    _current = NewState();
+    _nfa[0].Epsilons.push_back(_current);
+}
+
+void GlobAutomaton::Literal(std::string_view text) {
+    for (auto ch: text) {
+        CharSet charSet;
+        charSet.set(NormalizeChar(static_cast<unsigned char>(ch)));
+        auto next = NewState();
+        AddEdge(_current, charSet, next);
+        _current = next;
+    }
+}
+
+void GlobAutomaton::AnyCharsExceptSep() {
+    CharSet charSet;
+    charSet.set();
+    charSet.reset('/');
+    auto loop = NewState();
+    _nfa[_current].Epsilons.push_back(loop);
+    AddEdge(loop, charSet, loop);
+    _current = loop;
+}
+
+void GlobAutomaton::AnyChars() {
+    CharSet charSet;
+    charSet.set();
+    auto loop = NewState();
+    _nfa[_current].Epsilons.push_back(loop);
+    AddEdge(loop, charSet, loop);
+    _current = loop;
+}
+
+void GlobAutomaton::CharOf(std::string_view chars, bool negate) {
+    CharSet charSet;
+    for (auto ch: chars) {
+        charSet.set(NormalizeChar(static_cast<unsigned char>(ch)));
+    }
+    if (negate) {
+        charSet.flip();
+    }
+    auto next = NewState();
+    AddEdge(_current, charSet, next);
+    _current = next;
+}
+
+void GlobAutomaton::StringOf(const std::vector<std::string_view> &strings) {
+    auto start = _current;
+    auto end = NewState();
+    for (auto s: strings) {
+        _current = start;
+        Literal(s);
+        _nfa[_current].Epsilons.push_back(end);
+    }
+    _current = end;
+}
+
+void GlobAutomaton::NumRange(std::int64_t min, std::int64_t max) {
+    if (max - min > MaxNumRange) {
+        _tooComplex = true;
+        return;
+    }
+    std::vector<std::string> numbers;
+    for (auto i = min; i <= max; i++) {
+        numbers.push_back(std::to_string(i));
+    }
+    std::vector<std::string_view> strings(numbers.begin(), numbers.end());
+    StringOf(strings);
+}
+
+void GlobAutomaton::EndPattern() {
+    _nfa[_current].Accepts.push_back(_currentId);
+}
+
+void GlobAutomaton::Closure(std::vector<std::uint32_t> &states, std::vector<bool> &visited) const {
+    std::vector<std::uint32_t> stack = states;
+    for (auto s: states) {
+        visited[s] = true;
+    }
+    while (!stack.empty()) {
+        auto s = stack.back();
+        stack.pop_back();
+        for (auto next: _nfa[s].Epsilons) {
+            if (!visited[next]) {
+                visited[next] = true;
+                states.push_back(next);
+                stack.push_back(next);
+            }
+        }
+    }
+    for (auto s: states) {
+        visited[s] = false;
+    }
+    std::sort(states.begin(), states.end());
+}
+
+bool GlobAutomaton::Build(std::size_t maxStates) {
+    _table.clear();
+    _accepts.clear();
+    // DFA 的状态数通常不少于 NFA, NFA 已经过大时不必尝试
+    if (_tooComplex || _nfa.size() > maxStates) {
+        return false;
+    }
+
+    // 字节等价类: 在所有字符集中的归属都相同的字节无需区分
+    std::map<std::vector<bool>, std::uint8_t> classes;
+    std::vector<unsigned char> representatives;
+    for (std::size_t b = 0; b != 256; b++) {
+        auto ch = NormalizeChar(static_cast<unsigned char>(b));
+        std::vector<bool> signature(_charSets.size());
+        for (std::size_t i = 0; i != _charSets.size(); i++) {
+            signature[i] = _charSets[i].test(ch);
+        }
+        auto it = classes.find(signature);
+        if (it == classes.end()) {
+            it = classes.insert({signature, static_cast<std::uint8_t>(representatives.size())}).first;
+            representatives.push_back(ch);
+        }
+        _byteClass[b] = it->second;
+    }
+    _classCount = representatives.size();
+
+    std::vector<bool> visited(_nfa.size(), false);
+    std::map<std::vector<std::uint32_t>, std::uint32_t> dfaStates;
+    std::vector<std::vector<std::uint32_t>> pending;
+    auto addState = [&](std::vector<std::uint32_t> &&states) -> std::uint32_t {
+        auto it = dfaStates.find(states);
+        if (it != dfaStates.end()) {
+            return it->second;
+        }
+        auto id = static_cast<std::uint32_t>(_accepts.size());
+        auto &accepts = _accepts.emplace_back();
+        for (auto s: states) {
+            accepts.insert(accepts.end(), _nfa[s].Accepts.begin(), _nfa[s].Accepts.end());
+        }
+        std::sort(accepts.begin(), accepts.end());
+        accepts.erase(std::unique(accepts.begin(), accepts.end()), accepts.end());
+        dfaStates.insert({states, id});
+        pending.push_back(std::move(states));
+        return id;
+    };
+
+    std::vector<std::uint32_t> start = {0};
+    Closure(start, visited);
+    addState(std::move(start));
+    for (std::size_t i = 0; i != pending.size(); i++) {
+        if (pending.size() > maxStates) {
+            _table.clear();
+            _accepts.clear();
+            return false;
+        }
+        _table.resize(pending.size() * _classCount);
+        for (std::size_t c = 0; c != _classCount; c++) {
+            std::vector<std::uint32_t> next;
+            for (auto s: pending[i]) {
+                for (auto [charSetIndex, to]: _nfa[s].Edges) {
+                    if (_charSets[charSetIndex].test(representatives[c]) && !visited[to]) {
+                        visited[to] = true;
+                        next.push_back(to);
+                    }
+                }
+            }
+            for (auto s: next) {
+                visited[s] = false;
+            }
+            Closure(next, visited);
+            auto id = addState(std::move(next));
+            _table[i * _classCount + c] = id;
+        }
+    }
+    _table.resize(pending.size() * _classCount);
+    return true;
+}
+
+bool GlobAutomaton::IsBuilt() const {
+    return !_accepts.empty();
+}
+
+const std::vector<std::size_t> &GlobAutomaton::Match(std::string_view path) const {
+    std::uint32_t state = 0;
+    for (auto ch: path) {
+        state = _table[state * _classCount + _byteClass[static_cast<unsigned char>(ch)]];
+    }
+    return _accepts[state];
+}
+
+std::size_t GlobAutomaton::GetStateCount() const {
+    return _accepts.size();
+}
@@ -6,6 +6,11 @@
         op = n.AsBool();                           \
     }
 
+#define NUMBER_OPTION(op)                                                \
+    if (auto n = root.GetValue(#op); n.IsNumber() && n.AsInt() >= 0) { \
+        op = static_cast<std::size_t>(n.AsInt());                        \
+    }
+
 NameStyleRule MakeNameStyle(InfoNode n) {
     if (n.IsString()) {
         auto type = n.AsString();
@@ -53,7 +58,12 @@ NameStyleRule MakeNameStyle(InfoNode n) {
                     auto patternData = std::make_shared<PatternNameStyleData>();
                     auto patternString = paramNode.AsString();
                     try {
-                        patternData->Re = std::regex(patternString, std::regex_constants::ECMAScript);
+                        auto compiled = std::make_shared<CompiledRegex>();
+                        if (compiled->Compile(patternString)) {
+                            patternData->Compiled = compiled;
+                        } else {
+                            patternData->Re = std::regex(patternString, std::regex_constants::ECMAScript);
+                        }
                         patternData->PatternString = patternString;
                         for (auto pair: n.AsMap()) {
                             if (string_util::StartWith(pair.first, "$")) {
@@ -95,6 +105,10 @@ void LuaDiagnosticStyle::ParseTree(InfoTree &tree) {
 
     BOOL_OPTION(spell_check);
 
+    NUMBER_OPTION(max_diagnostic_count);
+
+    NUMBER_OPTION(max_diagnostic_count_per_type);
+
     std::vector<std::pair<std::vector<NameStyleRule> &, std::string>> name_styles = {
             {local_name_style,           "local_name_style"          },
             {function_param_name_style,  "function_param_name_style" },
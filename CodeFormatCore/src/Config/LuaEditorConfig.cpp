@@ -3,8 +3,11 @@
 
 #include <sstream>
 #include <fstream>
-#include <regex>
+#include <algorithm>
+#include <cctype>
+#include <iterator>
 
+#include "LuaParser/Lexer/TextReader.h"
 #include "Util/StringUtil.h"
 
 std::shared_ptr<LuaEditorConfig> LuaEditorConfig::LoadFromFile(const std::string &path) {
@@ -23,52 +26,128 @@ LuaEditorConfig::LuaEditorConfig(std::string &&source)
         : _source(source) {
 }
 
-void LuaEditorConfig::Parse() {
-    auto lines = string_util::Split(_source, "\n");
+static bool IsLineSpace(int c) {
+    return c > 0 && c != '\n' && std::isspace(c);
+}
+
+static bool IsKeyChar(int c) {
+    return c > 0 && (std::isalnum(c) || c == '_');
+}
+
+// [pattern], pattern 中可以包含 []
+static bool ScanSection(std::string_view line, std::string_view &pattern) {
+    if (line.empty() || line.front() != '[') {
+        return false;
+    }
+    auto close = line.find_last_of(']');
+    if (close == std::string_view::npos || close == 0 || !string_util::TrimSpace(line.substr(close + 1)).empty()) {
+        return false;
+    }
+    pattern = string_util::TrimSpace(line.substr(1, close - 1));
+    return !pattern.empty();
+}
+
+// key = value
+static bool ScanKeyValue(std::string_view line, std::string_view &key, std::string_view &value) {
+    TextReader reader(line);
+    reader.EatWhile(IsKeyChar);
+    if (!reader.HasSaveText()) {
+        return false;
+    }
+    key = reader.GetSaveText();
+    reader.ResetBuffer();
+    reader.EatWhile(IsLineSpace);
+    if (reader.GetCurrentChar() != '=') {
+        return false;
+    }
+    value = string_util::TrimSpace(line.substr(reader.GetPos() + 1));
+    return !value.empty();
+}
 
-    std::regex comment = std::regex(R"(^\s*(;|#))");
-    std::regex luaSection = std::regex(R"(^\s*\[\s*([^\]]+)\s*\]\s*$)");
-    std::regex valueRegex = std::regex(R"(^\s*([\w\d_]+)\s*=\s*(.+)$)");
+void LuaEditorConfig::Parse() {
+    std::string_view source = _source;
     bool sectionFounded = false;
 
-    for (auto &lineView: lines) {
-        std::string line(lineView);
-        if (std::regex_search(line, comment)) {
-            continue;
+    std::size_t lineStart = 0;
+    while (lineStart < source.size()) {
+        auto lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = source.size();
         }
+        auto line = source.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
 
-        std::smatch m;
+        TextReader reader(line);
+        reader.EatWhile(IsLineSpace);
+        line = line.substr(reader.GetPos());
+        if (line.empty() || line.front() == ';' || line.front() == '#') {
+            continue;
+        }
 
-        if (std::regex_search(line, m, luaSection)) {
-            auto pattern = m.str(1);
-            sectionFounded = (pattern.find("lua") != std::string::npos) || pattern == "*";
+        std::string_view pattern;
+        if (ScanSection(line, pattern)) {
+            sectionFounded = (pattern.find("lua") != std::string_view::npos) || pattern == "*";
             _sections.emplace_back(pattern);
             continue;
         }
 
-        if (sectionFounded) {
-            if (std::regex_search(line, m, valueRegex)) {
-                _sections.back().ConfigMap.insert({m.str(1), std::string(string_util::TrimSpace(m.str(2)))});
-            }
+        std::string_view key;
+        std::string_view value;
+        if (sectionFounded && ScanKeyValue(line, key, value)) {
+            _sections.back().ConfigMap.insert({std::string(key), std::string(value)});
         }
     }
+
+    CompileSections();
 }
 
-LuaStyle &LuaEditorConfig::Generate(std::string_view filePath) {
+const std::vector<LuaEditorConfig::Section> &LuaEditorConfig::GetSections() const {
+    return _sections;
+}
 
-    std::vector<std::size_t> patternSection;
+void LuaEditorConfig::CompileSections() {
+    _commonSections.clear();
+    _patternSections.clear();
+    _styleMap.clear();
+    _pathStyleCache.clear();
+    _sectionAutomaton = GlobAutomaton();
     for (std::size_t i = 0; i != _sections.size(); i++) {
-        auto &pattern = _sections[i].Pattern;
-
-        // [*] [*.lua]
-        if (pattern.GetPattern() == "*" || pattern.GetPattern() == "*.lua") {
-            patternSection.push_back(i);
+        auto &section = _sections[i];
+        if (section.ConfigMap.empty()) {
+            continue;
         }
-            // [{test.lua,lib.lua}]
-        else if (pattern.Match(filePath)) {
-            patternSection.push_back(i);
+        auto pattern = section.Pattern.GetPattern();
+        if (pattern == "*" || pattern == "*.lua") {
+            _commonSections.push_back(i);
+        } else {
+            _patternSections.push_back(i);
+            section.Pattern.AddTo(_sectionAutomaton, i);
         }
     }
+    _sectionAutomaton.Build();
+}
+
+static std::string NormalizePath(std::string_view filePath) {
+    std::string path(filePath);
+    for (auto &c: path) {
+        if (c == '\\') {
+            c = '/';
+        }
+    }
+    return path;
+}
+
+LuaStyle &LuaEditorConfig::Generate(std::string_view filePath) {
+    // 一个工作区的文件数有限, 超出时直接清空
+    constexpr std::size_t MaxPathStyleCache = 65536;
+
+    auto path = NormalizePath(filePath);
+    auto cacheIt = _pathStyleCache.find(path);
+    if (cacheIt != _pathStyleCache.end()) {
+        return *cacheIt->second;
+    }
+
+    auto patternSection = MatchSections(path);
 
     std::string patternKey;
     patternKey.reserve(64);
@@ -77,16 +156,47 @@ LuaStyle &LuaEditorConfig::Generate(std::string_view filePath) {
     }
 
     auto it = _styleMap.find(patternKey);
-    if (it != _styleMap.end()) {
-        return it->second;
+    if (it == _styleMap.end()) {
+        it = _styleMap.insert({patternKey, LuaStyle()}).first;
+        auto &luaStyle = it->second;
+        for (auto i: patternSection) {
+            auto &configMap = _sections[i].ConfigMap;
+            luaStyle.Parse(configMap);
+        }
     }
 
-    _styleMap.insert({patternKey, LuaStyle()});
-    auto &luaStyle = _styleMap.at(patternKey);
-    for (auto i: patternSection) {
-        auto &configMap = _sections[i].ConfigMap;
-        luaStyle.Parse(configMap);
+    if (_pathStyleCache.size() >= MaxPathStyleCache) {
+        _pathStyleCache.clear();
+    }
+    _pathStyleCache.insert({std::move(path), &it->second});
+    return it->second;
+}
+
+std::vector<const std::map<std::string, std::string, std::less<>> *> LuaEditorConfig::GetConfigMaps(std::string_view filePath) {
+    std::vector<const std::map<std::string, std::string, std::less<>> *> configMaps;
+    for (auto i: MatchSections(NormalizePath(filePath))) {
+        configMaps.push_back(&_sections[i].ConfigMap);
     }
+    return configMaps;
+}
 
-    return luaStyle;
+std::vector<std::size_t> LuaEditorConfig::MatchSections(const std::string &path) {
+    // [{test.lua,lib.lua}]
+    std::vector<std::size_t> matchSections;
+    if (_sectionAutomaton.IsBuilt()) {
+        if (!path.empty()) {
+            matchSections = _sectionAutomaton.Match(path);
+        }
+    } else {
+        for (auto i: _patternSections) {
+            if (_sections[i].Pattern.Match(path)) {
+                matchSections.push_back(i);
+            }
+        }
+    }
+
+    std::vector<std::size_t> patternSection;
+    std::merge(_commonSections.begin(), _commonSections.end(), matchSections.begin(), matchSections.end(),
+               std::back_inserter(patternSection));
+    return patternSection;
 }
@@ -272,6 +272,8 @@ void LuaStyle::Parse(std::map<std::string, std::string, std::less<>> &configMap)
 
     BOOL_OPTION(break_before_braces)
 
+    BOOL_OPTION(layout_line_break)
+
     if (configMap.count("break_table_list")) {
         if (configMap.at("break_table_list") == "never") {
             break_table_list = BreakTableList::Never;
@@ -9,19 +9,27 @@ CodeStyleChecker::CodeStyleChecker() {
 }
 
 void CodeStyleChecker::Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t) {
-    BasicStyleCheck(d, t);
+    Analyze(d, t, nullptr);
+}
+
+void CodeStyleChecker::Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t, const NodeHandle &subscriber) {
+    BasicStyleCheck(d, t, subscriber);
     EndWithNewLine(d, t);
 }
 
-void CodeStyleChecker::BasicStyleCheck(DiagnosticBuilder &d, const LuaSyntaxTree &t) {
+void CodeStyleChecker::BasicStyleCheck(DiagnosticBuilder &d, const LuaSyntaxTree &t, const NodeHandle &subscriber) {
     auto &state = d.GetState();
     state.Analyze(t);
+    d.ResolveBeforeDiagnosticRange(t);
 
     auto root = t.GetRootNode();
     std::vector<LuaSyntaxNode> startNodes = {root};
 
-    state.DfsForeach(startNodes, t, [this, &d](LuaSyntaxNode &syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve) {
+    state.DfsForeach(startNodes, t, [this, &d, &subscriber](LuaSyntaxNode &syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve) {
         BasicResolve(syntaxNode, t, resolve, d);
+        if (subscriber) {
+            subscriber(syntaxNode, t);
+        }
     });
 }
 
@@ -3,10 +3,18 @@
 
 #include "LuaParser/Lexer/LuaTokenTypeDetail.h"
 #include "CodeFormatCore/Diagnostic/CodeStyle/CodeStyleChecker.h"
+#include "CodeFormatCore/Format/Analyzer/AlignAnalyzer.h"
+#include "CodeFormatCore/Format/Analyzer/FormatDocAnalyze.h"
+#include <future>
+#include <limits>
 
 DiagnosticBuilder::DiagnosticBuilder(LuaStyle &style, LuaDiagnosticStyle &diagnosticStyle)
         : _diagnosticStyle(diagnosticStyle),
-          _state(FormatState::Mode::Diagnostic) {
+          _state(FormatState::Mode::Diagnostic),
+          _diagnosticCount(0),
+          _isTotalExceeded(false),
+          _rangeStartIndex(0),
+          _parallelCheck(false) {
     _state.SetFormatStyle(style);
     _state.SetDiagnosticStyle(diagnosticStyle);
 }
@@ -19,22 +27,164 @@ std::vector<LuaDiagnostic> DiagnosticBuilder::GetDiagnosticResults(const LuaSynt
     return _diagnostics;
 }
 
+void DiagnosticBuilder::SetDiagnosticRange(const LuaSyntaxTree &t, std::size_t startLine, std::size_t endLine) {
+    auto &file = t.GetFile();
+    auto startOffset = file.GetOffset(startLine, 0);
+    auto endOffset = file.GetOffset(endLine + 1, 0);
+    if (endOffset < startOffset) {
+        endOffset = startOffset;
+    }
+    _diagnosticRange = TextRange(startOffset, endOffset - startOffset);
+    _state.SetTraverseRange(_diagnosticRange.value());
+
+    auto firstToken = t.GetTokenBeforeOffset(startOffset);
+    if (firstToken.IsNull(t)) {
+        firstToken = t.GetRootNode().GetFirstToken(t);
+    } else if (firstToken.GetTextRange(t).StartOffset < startOffset) {
+        firstToken = firstToken.GetNextToken(t);
+    }
+    _rangeStartIndex = firstToken.IsNull(t) ? 0 : firstToken.GetIndex();
+
+    // 只分析与范围相交的根语句, 以及根语句块和全部注释(可能是 ---@format disable)
+    auto block = t.GetRootNode();
+    if (block.GetSyntaxKind(t) != LuaSyntaxNodeKind::Block) {
+        return;
+    }
+    auto &nodes = t.GetSyntaxNodes();
+    std::size_t startIndex = 0;
+    std::size_t endIndex = 0;
+    for (auto child: block.GetChildren(t)) {
+        if (!IsInDiagnosticRange(child.GetTextRange(t))) {
+            if (startIndex != 0) {
+                break;
+            }
+            continue;
+        }
+        if (startIndex == 0) {
+            startIndex = child.GetIndex();
+        }
+        auto next = child.GetNextSibling(t);
+        // 语法树按先序编号, 根语句及其子孙占据一段连续的编号
+        endIndex = next.IsNull(t) ? nodes.size() : next.GetIndex() - 1;
+    }
+
+    std::vector<LuaSyntaxNode> analyzeNodes = {block};
+    for (auto &n: nodes) {
+        if (n.GetTokenKind(t) == TK_SHORT_COMMENT && (n.GetIndex() < startIndex || n.GetIndex() > endIndex)) {
+            analyzeNodes.push_back(n);
+        }
+    }
+    if (startIndex != 0) {
+        analyzeNodes.insert(analyzeNodes.end(), nodes.begin() + startIndex - 1, nodes.begin() + endIndex);
+    }
+    _state.SetAnalyzeNodes(std::move(analyzeNodes));
+}
+
+void DiagnosticBuilder::ResolveBeforeDiagnosticRange(const LuaSyntaxTree &t) {
+    if (!_diagnosticRange.has_value() || _rangeStartIndex == 0) {
+        return;
+    }
+
+    auto formatDoc = _state.GetAnalyzer<FormatDocAnalyze>();
+    if (formatDoc) {
+        for (auto &ignore: formatDoc->GetIgnores()) {
+            if (ignore.StartIndex < _rangeStartIndex && ignore.EndIndex >= _rangeStartIndex) {
+                _state.AddIgnore(ignore);
+            }
+        }
+    }
+
+    auto alignAnalyzer = _state.GetAnalyzer<AlignAnalyzer>();
+    if (alignAnalyzer) {
+        alignAnalyzer->ResolveGroupBefore(_state, _rangeStartIndex, t);
+    }
+}
+
+bool DiagnosticBuilder::IsInDiagnosticRange(TextRange range) const {
+    if (!_diagnosticRange.has_value()) {
+        return true;
+    }
+    auto &diagnosticRange = _diagnosticRange.value();
+    return range.StartOffset < diagnosticRange.StartOffset + diagnosticRange.Length && range.StartOffset + range.Length >= diagnosticRange.StartOffset;
+}
+
 void
 DiagnosticBuilder::PushDiagnostic(DiagnosticType type,
                                   std::size_t leftIndex,
                                   TextRange range,
                                   std::string_view message,
                                   std::string_view data) {
-    _nextDiagnosticMap[leftIndex] = LuaDiagnostic(type, range, message, data);
+    if (!IsInDiagnosticRange(range)) {
+        return;
+    }
+
+    auto it = _nextDiagnosticMap.find(leftIndex);
+    if (it != _nextDiagnosticMap.end()) {
+        if (it->second.Type != type) {
+            // 旧的诊断作废, 新的诊断同样要经过数量限制, 被丢弃时位置上不再有诊断
+            _typeCounts[it->second.Type]--;
+            _diagnosticCount--;
+            if (!AcceptDiagnostic(type)) {
+                _nextDiagnosticMap.erase(it);
+                return;
+            }
+        }
+        it->second = LuaDiagnostic(type, range, message, data);
+        return;
+    }
+
+    if (AcceptDiagnostic(type)) {
+        _nextDiagnosticMap[leftIndex] = LuaDiagnostic(type, range, message, data);
+    }
 }
 
 void DiagnosticBuilder::PushDiagnostic(DiagnosticType type, TextRange range, std::string_view message,
                                        std::string_view data) {
-    _diagnostics.emplace_back(type, range, message, data);
+    if (!IsInDiagnosticRange(range)) {
+        return;
+    }
+
+    if (_deferredType == type) {
+        _deferredDiagnostics.emplace_back(type, range, message, data);
+        return;
+    }
+
+    if (AcceptDiagnostic(type)) {
+        _diagnostics.emplace_back(type, range, message, data);
+    }
+}
+
+bool DiagnosticBuilder::AcceptDiagnostic(DiagnosticType type) {
+    auto maxCount = _diagnosticStyle.max_diagnostic_count;
+    if (maxCount != 0 && _diagnosticCount >= maxCount) {
+        _isTotalExceeded = true;
+        // nothing can be reported any more, stop the code style traverse
+        _state.StopDfsForeach();
+        return false;
+    }
+
+    auto maxTypeCount = _diagnosticStyle.max_diagnostic_count_per_type;
+    auto &typeCount = _typeCounts[type];
+    if (maxTypeCount != 0 && typeCount >= maxTypeCount) {
+        _exceededTypes.insert(type);
+        return false;
+    }
+
+    typeCount++;
+    _diagnosticCount++;
+    return true;
+}
+
+bool DiagnosticBuilder::IsTruncated() const {
+    return _isTotalExceeded || !_exceededTypes.empty();
+}
+
+bool DiagnosticBuilder::IsLimitExceeded(DiagnosticType type) const {
+    return _isTotalExceeded || _exceededTypes.count(type) != 0;
 }
 
 void DiagnosticBuilder::CodeStyleCheck(const LuaSyntaxTree &t) {
-    if (!_diagnosticStyle.code_style_check) {
+    if (!_diagnosticStyle.code_style_check || _isTotalExceeded) {
         return;
     }
 
@@ -43,7 +193,7 @@ void DiagnosticBuilder::CodeStyleCheck(const LuaSyntaxTree &t) {
 }
 
 void DiagnosticBuilder::NameStyleCheck(const LuaSyntaxTree &t) {
-    if (!_diagnosticStyle.name_style_check) {
+    if (!_diagnosticStyle.name_style_check || IsLimitExceeded(DiagnosticType::NameStyle)) {
         return;
     }
 
@@ -52,16 +202,119 @@ void DiagnosticBuilder::NameStyleCheck(const LuaSyntaxTree &t) {
 }
 
 void DiagnosticBuilder::SpellCheck(const LuaSyntaxTree &t, CodeSpellChecker &spellChecker) {
-    if (!_diagnosticStyle.spell_check) {
+    if (!_diagnosticStyle.spell_check || IsLimitExceeded(DiagnosticType::Spell)) {
         return;
     }
 
     spellChecker.Analyze(*this, t);
 }
 
+void DiagnosticBuilder::Check(const LuaSyntaxTree &t, CodeSpellChecker *spellChecker) {
+    if (_parallelCheck) {
+        ParallelCheck(t, spellChecker);
+        return;
+    }
+
+    if (!_diagnosticStyle.code_style_check || _isTotalExceeded) {
+        if (spellChecker) {
+            SpellCheck(t, *spellChecker);
+        }
+        NameStyleCheck(t);
+        return;
+    }
+
+    bool spell = spellChecker && _diagnosticStyle.spell_check;
+    // 代码风格的遍历会跳过忽略区域和范围外的子树, 游标负责补上被跳过的 token
+    auto spellToken = t.GetRootNode().GetFirstToken(t);
+    auto spellUntil = [&](std::size_t index) {
+        for (; !spellToken.IsNull(t) && spellToken.GetIndex() <= index; spellToken = spellToken.GetNextToken(t)) {
+            // 超出数量限制后不会再恢复, 剩下的 token 不必检查
+            if (IsLimitExceeded(DiagnosticType::Spell)) {
+                spellToken = LuaSyntaxNode(0);
+                break;
+            }
+            spellChecker->TokenAnalyze(*this, spellToken, t);
+        }
+    };
+
+    CodeStyleChecker checker;
+    if (spell) {
+        _deferredType = DiagnosticType::Spell;
+        checker.Analyze(*this, t, [&](LuaSyntaxNode &node, const LuaSyntaxTree &t) {
+            if (node.IsToken(t)) {
+                spellUntil(node.GetIndex());
+            }
+        });
+        spellUntil(std::numeric_limits<std::size_t>::max());
+        _deferredType.reset();
+        SubmitDiagnostics(_deferredDiagnostics);
+    } else {
+        checker.Analyze(*this, t);
+    }
+
+    NameStyleCheck(t);
+}
+
+void DiagnosticBuilder::SetParallelCheck(bool parallel) {
+    _parallelCheck = parallel;
+}
+
+void DiagnosticBuilder::ParallelCheck(const LuaSyntaxTree &t, CodeSpellChecker *spellChecker) {
+    // 语法树构建后只读, 拼写和命名检查各自写入不限数量的缓冲区,
+    // 代码风格检查会清除已提交的诊断, 所以留在当前线程直接提交, 最后按串行顺序合并
+    LuaStyle style = _state.GetStyle();
+    auto unlimitedStyle = _diagnosticStyle;
+    unlimitedStyle.max_diagnostic_count = 0;
+    unlimitedStyle.max_diagnostic_count_per_type = 0;
+    auto runChecker = [&t, style, unlimitedStyle, range = _diagnosticRange](auto check) mutable {
+        DiagnosticBuilder d(style, unlimitedStyle);
+        d._diagnosticRange = range;
+        check(d);
+        return d.GetDiagnosticResults(t);
+    };
+
+    std::future<std::vector<LuaDiagnostic>> spellFuture;
+    if (spellChecker && _diagnosticStyle.spell_check) {
+        spellFuture = std::async(std::launch::async, runChecker, [&t, spellChecker](DiagnosticBuilder &d) {
+            spellChecker->Analyze(d, t);
+        });
+    }
+    std::future<std::vector<LuaDiagnostic>> nameStyleFuture;
+    if (_diagnosticStyle.name_style_check) {
+        nameStyleFuture = std::async(std::launch::async, runChecker, [&t](DiagnosticBuilder &d) {
+            NameStyleChecker checker;
+            checker.Analyze(d, t);
+        });
+    }
+
+    CodeStyleCheck(t);
+    if (spellFuture.valid()) {
+        auto diagnostics = spellFuture.get();
+        SubmitDiagnostics(diagnostics);
+    }
+    if (nameStyleFuture.valid()) {
+        auto diagnostics = nameStyleFuture.get();
+        SubmitDiagnostics(diagnostics);
+    }
+}
+
+void DiagnosticBuilder::SubmitDiagnostics(std::vector<LuaDiagnostic> &diagnostics) {
+    for (auto &diagnostic: diagnostics) {
+        if (IsLimitExceeded(diagnostic.Type)) {
+            break;
+        }
+        if (AcceptDiagnostic(diagnostic.Type)) {
+            _diagnostics.push_back(std::move(diagnostic));
+        }
+    }
+    diagnostics.clear();
+}
+
 void DiagnosticBuilder::ClearDiagnostic(std::size_t leftIndex) {
     auto it = _nextDiagnosticMap.find(leftIndex);
     if (it != _nextDiagnosticMap.end()) {
+        _typeCounts[it->second.Type]--;
+        _diagnosticCount--;
         _nextDiagnosticMap.erase(it);
     }
 }
@@ -23,20 +23,12 @@ NameStyleChecker::NameStyleChecker() {
 }
 
 void NameStyleChecker::RecordLocalVariable(LuaSyntaxNode &n, const LuaSyntaxTree &t) {
-    if (!_scopeStack.empty()) {
-        _scopeStack.back().insert(std::string(n.GetText(t)));
-    }
+    _scopes.Declare(_symbols.Intern(n.GetText(t)));
 }
 
 bool NameStyleChecker::CheckGlobal(LuaSyntaxNode &n, const LuaSyntaxTree &t) {
-    auto text = n.GetText(t);
-    for (auto &scope: _scopeStack) {
-        if (scope.find(text) != scope.end()) {
-            return false;
-        }
-    }
-
-    return true;
+    auto symbol = _symbols.Find(n.GetText(t));
+    return symbol == SymbolPool::NotFound || !_scopes.IsDeclared(symbol);
 }
 
 void NameStyleChecker::Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t) {
@@ -49,7 +41,7 @@ void NameStyleChecker::Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t) {
         auto returnExpr = exprList.GetChildSyntaxNode(LuaSyntaxMultiKind::Expression, t);
         if (returnExpr.GetSyntaxKind(t) == LuaSyntaxNodeKind::NameExpression) {
             auto name = returnExpr.GetChildToken(TK_NAME, t);
-            _module = std::string(name.GetText(t));
+            _module = name.GetText(t);
         }
     }
     EnterScope();
@@ -60,13 +52,11 @@ void NameStyleChecker::Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t) {
 }
 
 void NameStyleChecker::EnterScope() {
-    _scopeStack.emplace_back();
+    _scopes.EnterScope();
 }
 
 void NameStyleChecker::ExitScope() {
-    if (!_scopeStack.empty()) {
-        _scopeStack.pop_back();
-    }
+    _scopes.ExitScope();
 }
 
 void NameStyleChecker::CheckInNode(LuaSyntaxNode &n, const LuaSyntaxTree &t) {
@@ -74,7 +64,7 @@ void NameStyleChecker::CheckInNode(LuaSyntaxNode &n, const LuaSyntaxTree &t) {
         return;
     }
 
-    for (auto syntaxNode: n.GetChildren(t)) {
+    for (auto syntaxNode = n.GetFirstChild(t); !syntaxNode.IsNull(t); syntaxNode.ToNext(t)) {
         if (syntaxNode.IsNode(t)) {
             switch (syntaxNode.GetSyntaxKind(t)) {
                 case LuaSyntaxNodeKind::ClosureExpression: {
@@ -111,7 +101,7 @@ void NameStyleChecker::CheckInNode(LuaSyntaxNode &n, const LuaSyntaxTree &t) {
 }
 
 void NameStyleChecker::CheckInBody(LuaSyntaxNode &n, const LuaSyntaxTree &t) {
-    for (auto stmt: n.GetChildren(t)) {
+    for (auto stmt = n.GetFirstChild(t); !stmt.IsNull(t); stmt.ToNext(t)) {
         if (stmt.IsNode(t)) {
             switch (stmt.GetSyntaxKind(t)) {
                 case LuaSyntaxNodeKind::LocalStatement: {
@@ -133,7 +123,7 @@ void NameStyleChecker::CheckInBody(LuaSyntaxNode &n, const LuaSyntaxTree &t) {
                             matchSpecialRule = CheckSpecialVariableRule(name, expr, t);
                         }
                         if (!matchSpecialRule) {
-                            if (_scopeStack.size() == 1 && _module == name.GetText(t)) {
+                            if (_scopes.GetDepth() == 1 && _module == name.GetText(t)) {
                                 PushStyleCheck(NameDefineType::ModuleDefineName, name);
                                 break;
                             }
@@ -334,7 +324,13 @@ void NameStyleChecker::Diagnostic(DiagnosticBuilder &d, const LuaSyntaxTree &t)
     NameStyleRuleMatcher matcher;
     auto &state = d.GetState();
     for (auto &nameStyle: _nameStyleCheckVector) {
+        if (d.IsLimitExceeded(DiagnosticType::NameStyle)) {
+            break;
+        }
         auto n = LuaSyntaxNode(nameStyle.Index);
+        if (!d.IsInDiagnosticRange(n.GetTextRange(t))) {
+            continue;
+        }
         switch (nameStyle.Type) {
             case NameDefineType::LocalVariableName: {
                 if (LocalSpecialName.count(n.GetText(t))) {
@@ -255,48 +255,59 @@ bool NameStyleRuleMatcher::PascalCase(std::string_view text) {
 }
 
 bool NameStyleRuleMatcher::PatternMatch(std::string_view text, std::shared_ptr<PatternNameStyleData> data) {
+    if (data->Compiled) {
+        // 先用 DFA 判断是否匹配, 有分组规则时才计算捕获组
+        if (!data->Compiled->Match(text)) {
+            return false;
+        }
+        if (data->GroupRules.empty()) {
+            return true;
+        }
+        std::vector<std::string_view> groups;
+        if (!data->Compiled->Match(text, groups)) {
+            return false;
+        }
+        for (auto group: data->GroupRules) {
+            if (group.GroupId < groups.size() && !GroupMatch(group.Rule, groups[group.GroupId])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     std::match_results<std::string_view::const_iterator> mc;
     if (!std::regex_match(text.begin(), text.end(), mc, data->Re)) {
         return false;
     }
 
     for (auto group: data->GroupRules) {
-        if (group.GroupId < mc.size()) {
-            auto &subMatch = mc[group.GroupId];
-            switch (group.Rule) {
-                case NameStyleType::Off: {
-                    break;
-                }
-                case NameStyleType::CamelCase: {
-                    if (!CamelCase(subMatch.str())) {
-                        return false;
-                    }
-                    break;
-                }
-                case NameStyleType::PascalCase: {
-                    if (!PascalCase(subMatch.str())) {
-                        return false;
-                    }
-                    break;
-                }
-                case NameStyleType::SnakeCase: {
-                    if (!SnakeCase(subMatch.str())) {
-                        return false;
-                    }
-                    break;
-                }
-                case NameStyleType::UpperSnakeCase: {
-                    if (!UpperSnakeCase(subMatch.str())) {
-                        return false;
-                    }
-                    break;
-                }
-                default: {
-                    return false;
-                }
-            }
+        if (group.GroupId < mc.size() && !GroupMatch(group.Rule, mc[group.GroupId].str())) {
+            return false;
         }
     }
 
     return true;
 }
+
+bool NameStyleRuleMatcher::GroupMatch(NameStyleType rule, std::string_view text) {
+    switch (rule) {
+        case NameStyleType::Off: {
+            return true;
+        }
+        case NameStyleType::CamelCase: {
+            return CamelCase(text);
+        }
+        case NameStyleType::PascalCase: {
+            return PascalCase(text);
+        }
+        case NameStyleType::SnakeCase: {
+            return SnakeCase(text);
+        }
+        case NameStyleType::UpperSnakeCase: {
+            return UpperSnakeCase(text);
+        }
+        default: {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#include "CodeFormatCore/Diagnostic/NameStyle/ScopeChain.h"
+
+ScopeChain::ScopeChain() {
+}
+
+void ScopeChain::EnterScope() {
+    _scopeStart.push_back(_declared.size());
+}
+
+void ScopeChain::ExitScope() {
+    if (_scopeStart.empty()) {
+        return;
+    }
+    auto start = _scopeStart.back();
+    _scopeStart.pop_back();
+    for (auto i = start; i != _declared.size(); i++) {
+        _visibleCount[_declared[i]]--;
+    }
+    _declared.resize(start);
+}
+
+void ScopeChain::Declare(std::uint32_t symbol) {
+    if (_scopeStart.empty()) {
+        return;
+    }
+    if (symbol >= _visibleCount.size()) {
+        _visibleCount.resize(symbol + 1, 0);
+    }
+    _visibleCount[symbol]++;
+    _declared.push_back(symbol);
+}
+
+bool ScopeChain::IsDeclared(std::uint32_t symbol) const {
+    return symbol < _visibleCount.size() && _visibleCount[symbol] != 0;
+}
+
+std::size_t ScopeChain::GetDepth() const {
+    return _scopeStart.size();
+}
@@ -0,0 +1,74 @@
+#include "CodeFormatCore/Diagnostic/NameStyle/SymbolPool.h"
+
+SymbolPool::SymbolPool()
+    : _slots(64, 0) {
+}
+
+std::uint32_t SymbolPool::Intern(std::string_view name) {
+    auto hash = Hash(name);
+    auto mask = _slots.size() - 1;
+    auto slot = hash & mask;
+    while (_slots[slot] != 0) {
+        auto id = _slots[slot] - 1;
+        if (_hashes[id] == hash && _names[id] == name) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    auto id = static_cast<std::uint32_t>(_names.size());
+    _names.push_back(name);
+    _hashes.push_back(hash);
+    _slots[slot] = id + 1;
+    // 装载因子不超过 0.5
+    if (_names.size() * 2 > _slots.size()) {
+        Rehash();
+    }
+    return id;
+}
+
+std::uint32_t SymbolPool::Find(std::string_view name) const {
+    auto hash = Hash(name);
+    auto mask = _slots.size() - 1;
+    auto slot = hash & mask;
+    while (_slots[slot] != 0) {
+        auto id = _slots[slot] - 1;
+        if (_hashes[id] == hash && _names[id] == name) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NotFound;
+}
+
+std::string_view SymbolPool::GetName(std::uint32_t id) const {
+    if (id < _names.size()) {
+        return _names[id];
+    }
+    return "";
+}
+
+std::size_t SymbolPool::GetSize() const {
+    return _names.size();
+}
+
+std::uint32_t SymbolPool::Hash(std::string_view name) {
+    std::uint32_t hash = 2166136261u;
+    for (auto c: name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void SymbolPool::Rehash() {
+    _slots.assign(_slots.size() * 2, 0);
+    auto mask = _slots.size() - 1;
+    for (std::uint32_t id = 0; id != _names.size(); id++) {
+        auto slot = _hashes[id] & mask;
+        while (_slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        _slots[slot] = id + 1;
+    }
+}
@@ -7,24 +7,42 @@
 #include "Util/format.h"
 
 CodeSpellChecker::CodeSpellChecker()
-    : _symSpell(std::make_shared<SymSpell>(SymSpell::Strategy::LazyLoaded)) {
+    : _symSpell(std::make_shared<SymSpell>(SymSpell::Strategy::LazyLoaded)),
+      _generation(0) {
 }
 
 void CodeSpellChecker::LoadDictionary(std::string_view path) {
-    _symSpell->LoadWordDictionary(std::string(path));
+    // 优先按预先生成的索引加载, 否则按文本词典加载
+    std::string dictionaryPath(path);
+    if (!_symSpell->LoadDictionary(dictionaryPath)) {
+        _symSpell->LoadWordDictionary(dictionaryPath);
+    }
+    _generation++;
 }
 
 void CodeSpellChecker::LoadDictionaryFromBuffer(std::string_view buffer) {
     _symSpell->LoadWordDictionaryFromBuffer(buffer);
+    _generation++;
 }
 
 void CodeSpellChecker::Analyze(DiagnosticBuilder &d, const LuaSyntaxTree &t) {
-    for (auto &token: t.GetTokens()) {
-        if (token.GetTokenKind(t) == TK_NAME) {
-            IdentifyAnalyze(d, token, t);
-        } else if (token.GetTokenKind(t) == TK_STRING) {
-            TextAnalyze(d, token, t);
+    auto token = t.GetRootNode().GetFirstToken(t);
+    for (; !token.IsNull(t); token = token.GetNextToken(t)) {
+        if (d.IsLimitExceeded(DiagnosticType::Spell)) {
+            break;
         }
+        TokenAnalyze(d, token, t);
+    }
+}
+
+void CodeSpellChecker::TokenAnalyze(DiagnosticBuilder &d, LuaSyntaxNode &token, const LuaSyntaxTree &t) {
+    if (!d.IsInDiagnosticRange(token.GetTextRange(t))) {
+        return;
+    }
+    if (token.GetTokenKind(t) == TK_NAME) {
+        IdentifyAnalyze(d, token, t);
+    } else if (token.GetTokenKind(t) == TK_STRING) {
+        TextAnalyze(d, token, t);
     }
 }
 
@@ -86,7 +104,14 @@ std::vector<SuggestItem> CodeSpellChecker::GetSuggests(std::string word) {
         return suggests;
     }
 
-    suggests = _symSpell->LookUp(word);
+    auto generation = _generation.load();
+    if (!_cache.FindSuggests(word, generation, suggests)) {
+        {
+            std::lock_guard<std::mutex> lock(_lookUpMutex);
+            suggests = _symSpell->LookUp(word);
+        }
+        _cache.PutSuggests(word, generation, suggests);
+    }
 
     switch (state) {
         case ParseState::FirstUpper: {
@@ -135,7 +160,7 @@ void CodeSpellChecker::IdentifyAnalyze(DiagnosticBuilder &d, LuaSyntaxNode &toke
     }
     for (auto &word: words) {
         auto lowerItem = lowerString(word.Item);
-        if (!word.Item.empty() && customDict.count(lowerItem) == 0 && !_symSpell->IsCorrectWord(lowerItem)) {
+        if (!word.Item.empty() && !IsCorrectWord(lowerItem)) {
             auto tokenRange = token.GetTextRange(t);
             auto range = TextRange(tokenRange.StartOffset + word.Range.StartOffset,
                                    word.Range.Length);
@@ -151,7 +176,6 @@ void CodeSpellChecker::TextAnalyze(DiagnosticBuilder &d, LuaSyntaxNode &token, c
     if (identifiers.empty()) {
         return;
     }
-    auto &customDict = _dictionary;
 
     for (auto &identifier: identifiers) {
         auto identifyText = identifier.Item;
@@ -163,7 +187,7 @@ void CodeSpellChecker::TextAnalyze(DiagnosticBuilder &d, LuaSyntaxNode &token, c
         auto tokenRange = token.GetTextRange(t);
         for (auto &word: words) {
             auto lowerItem = lowerString(word.Item);
-            if (!word.Item.empty() && !_symSpell->IsCorrectWord(lowerItem) && customDict.count(lowerItem) == 0) {
+            if (!word.Item.empty() && !IsCorrectWord(lowerItem)) {
                 auto range = TextRange(tokenRange.StartOffset + identifier.Range.StartOffset + word.Range.StartOffset,
                                        word.Range.Length);
                 std::string originText(
@@ -177,4 +201,20 @@ void CodeSpellChecker::TextAnalyze(DiagnosticBuilder &d, LuaSyntaxNode &token, c
 
 void CodeSpellChecker::SetCustomDictionary(const CodeSpellChecker::CustomDictionary &dictionary) {
     _dictionary = dictionary;
+    _generation++;
+}
+
+SpellResultCache::Statistics CodeSpellChecker::GetCacheStatistics() const {
+    return _cache.GetStatistics();
+}
+
+bool CodeSpellChecker::IsCorrectWord(std::string_view word) {
+    auto generation = _generation.load();
+    bool correct = false;
+    if (_cache.FindCorrect(word, generation, correct)) {
+        return correct;
+    }
+    correct = _dictionary.count(std::string(word)) != 0 || _symSpell->IsCorrectWord(word);
+    _cache.PutCorrect(word, generation, correct);
+    return correct;
 }
@@ -0,0 +1,115 @@
+#include "CodeFormatCore/Diagnostic/Spell/SpellResultCache.h"
+#include <algorithm>
+#include <functional>
+
+double SpellResultCache::Statistics::HitRate() const {
+    auto total = Hits + Misses;
+    return total == 0 ? 0.0 : static_cast<double>(Hits) / static_cast<double>(total);
+}
+
+SpellResultCache::SpellResultCache(std::size_t capacity)
+    : _shardCapacity(std::max<std::size_t>(capacity / ShardCount, 1)),
+      _hits(0),
+      _misses(0) {
+}
+
+bool SpellResultCache::FindCorrect(std::string_view word, std::uint64_t generation, bool &correct) {
+    auto &shard = GetShard(word);
+    std::lock_guard<std::mutex> lock(shard.Mutex);
+    auto entry = Find(shard, word, generation);
+    if (!entry || entry->State == WordState::Unknown) {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    _hits.fetch_add(1, std::memory_order_relaxed);
+    correct = entry->State == WordState::Correct;
+    return true;
+}
+
+bool SpellResultCache::FindSuggests(std::string_view word, std::uint64_t generation,
+                                    std::vector<SuggestItem> &suggests) {
+    auto &shard = GetShard(word);
+    std::lock_guard<std::mutex> lock(shard.Mutex);
+    auto entry = Find(shard, word, generation);
+    if (!entry || !entry->HasSuggests) {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    _hits.fetch_add(1, std::memory_order_relaxed);
+    suggests = entry->Suggests;
+    return true;
+}
+
+void SpellResultCache::PutCorrect(std::string_view word, std::uint64_t generation, bool correct) {
+    auto &shard = GetShard(word);
+    std::lock_guard<std::mutex> lock(shard.Mutex);
+    FindOrInsert(shard, word, generation).State = correct ? WordState::Correct : WordState::Misspelled;
+}
+
+void SpellResultCache::PutSuggests(std::string_view word, std::uint64_t generation,
+                                   const std::vector<SuggestItem> &suggests) {
+    auto &shard = GetShard(word);
+    std::lock_guard<std::mutex> lock(shard.Mutex);
+    auto &entry = FindOrInsert(shard, word, generation);
+    entry.HasSuggests = true;
+    entry.Suggests = suggests;
+}
+
+void SpellResultCache::Clear() {
+    for (auto &shard: _shards) {
+        std::lock_guard<std::mutex> lock(shard.Mutex);
+        shard.Index.clear();
+        shard.Entries.clear();
+    }
+    _hits = 0;
+    _misses = 0;
+}
+
+SpellResultCache::Statistics SpellResultCache::GetStatistics() const {
+    Statistics statistics;
+    statistics.Hits = _hits.load(std::memory_order_relaxed);
+    statistics.Misses = _misses.load(std::memory_order_relaxed);
+    for (auto &shard: _shards) {
+        std::lock_guard<std::mutex> lock(shard.Mutex);
+        statistics.Size += shard.Entries.size();
+    }
+    return statistics;
+}
+
+SpellResultCache::Shard &SpellResultCache::GetShard(std::string_view word) {
+    return _shards[std::hash<std::string_view>{}(word) % ShardCount];
+}
+
+SpellResultCache::Entry *SpellResultCache::Find(Shard &shard, std::string_view word, std::uint64_t generation) {
+    auto it = shard.Index.find(word);
+    if (it == shard.Index.end()) {
+        return nullptr;
+    }
+    auto entryIt = it->second;
+    if (entryIt->Generation != generation) {
+        shard.Index.erase(it);
+        shard.Entries.erase(entryIt);
+        return nullptr;
+    }
+    shard.Entries.splice(shard.Entries.begin(), shard.Entries, entryIt);
+    return &*entryIt;
+}
+
+SpellResultCache::Entry &SpellResultCache::FindOrInsert(Shard &shard, std::string_view word, std::uint64_t generation) {
+    if (auto entry = Find(shard, word, generation); entry) {
+        return *entry;
+    }
+
+    if (shard.Entries.size() >= _shardCapacity) {
+        auto &last = shard.Entries.back();
+        shard.Index.erase(last.Word);
+        shard.Entries.pop_back();
+    }
+
+    shard.Entries.emplace_front();
+    auto &entry = shard.Entries.front();
+    entry.Word = std::string(word);
+    entry.Generation = generation;
+    shard.Index.emplace(entry.Word, shard.Entries.begin());
+    return entry;
+}
@@ -9,7 +9,7 @@ AlignAnalyzer::AlignAnalyzer() {
 }
 
 void AlignAnalyzer::Analyze(FormatState &f, const LuaSyntaxTree &t) {
-    for (auto syntaxNode: t.GetSyntaxNodes()) {
+    for (auto syntaxNode: f.GetAnalyzeNodes(t)) {
         if (syntaxNode.IsNode(t)) {
             switch (syntaxNode.GetSyntaxKind(t)) {
                 case LuaSyntaxNodeKind::Block: {
@@ -123,6 +123,20 @@ void AlignAnalyzer::Query(FormatState &f, LuaSyntaxNode syntaxNode, const LuaSyn
     }
 }
 
+void AlignAnalyzer::ResolveGroupBefore(FormatState &f, std::size_t index, const LuaSyntaxTree &t) {
+    for (auto [startIndex, alignGroupIndex]: _startNodeToGroupIndex) {
+        auto &alignGroup = _alignGroup[alignGroupIndex];
+        if (startIndex < index && !alignGroup.Resolve) {
+            ResolveAlignGroup(f, alignGroupIndex, alignGroup, t);
+            alignGroup.Resolve = true;
+        }
+    }
+}
+
+const std::vector<AlignGroup> &AlignAnalyzer::GetAlignGroups() const {
+    return _alignGroup;
+}
+
 void AlignAnalyzer::PushAlignGroup(AlignStrategy strategy, std::vector<std::size_t> &data) {
     auto pos = _alignGroup.size();
     _alignGroup.emplace_back(strategy, data);
@@ -8,7 +8,7 @@ FormatDocAnalyze::FormatDocAnalyze() {
 }
 
 void FormatDocAnalyze::Analyze(FormatState &f, const LuaSyntaxTree &t) {
-    for (auto syntaxNode: t.GetSyntaxNodes()) {
+    for (auto syntaxNode: f.GetAnalyzeNodes(t)) {
         switch (syntaxNode.GetTokenKind(t)) {
             case TK_SHORT_COMMENT: {
                 if (syntaxNode.GetParent(t).GetSyntaxKind(t) == LuaSyntaxNodeKind::Block) {
@@ -12,7 +12,7 @@ IndentationAnalyzer::IndentationAnalyzer() {
 }
 
 void IndentationAnalyzer::Analyze(FormatState &f, const LuaSyntaxTree &t) {
-    for (auto syntaxNode: t.GetSyntaxNodes()) {
+    for (auto syntaxNode: f.GetAnalyzeNodes(t)) {
         if (syntaxNode.IsNode(t)) {
             switch (syntaxNode.GetSyntaxKind(t)) {
                 case LuaSyntaxNodeKind::Block: {
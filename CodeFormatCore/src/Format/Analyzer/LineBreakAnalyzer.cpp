@@ -1,6 +1,7 @@
 #include "CodeFormatCore/Format/Analyzer/LineBreakAnalyzer.h"
 #include "CodeFormatCore/Format/Analyzer/SpaceAnalyzer.h"
 #include "CodeFormatCore/Format/FormatState.h"
+#include "CodeFormatCore/Format/LineLayout.h"
 #include "LuaParser/Lexer/LuaTokenTypeDetail.h"
 #include <algorithm>
 
@@ -10,7 +11,7 @@ LineBreakAnalyzer::LineBreakAnalyzer() {
 }
 
 void LineBreakAnalyzer::Analyze(FormatState &f, const LuaSyntaxTree &t) {
-    for (auto syntaxNode: t.GetSyntaxNodes()) {
+    for (auto syntaxNode: f.GetAnalyzeNodes(t)) {
         if (syntaxNode.IsToken(t)) {
             switch (syntaxNode.GetTokenKind(t)) {
                 case TK_SHEBANG:
@@ -37,7 +38,7 @@ void LineBreakAnalyzer::Analyze(FormatState &f, const LuaSyntaxTree &t) {
 }
 
 void LineBreakAnalyzer::ComplexAnalyze(FormatState &f, const LuaSyntaxTree &t) {
-    for (auto syntaxNode: t.GetSyntaxNodes()) {
+    for (auto syntaxNode: f.GetAnalyzeNodes(t)) {
         if (syntaxNode.IsNode(t)) {
             switch (syntaxNode.GetSyntaxKind(t)) {
                 case LuaSyntaxNodeKind::Block: {
@@ -179,6 +180,10 @@ void LineBreakAnalyzer::ComplexAnalyze(FormatState &f, const LuaSyntaxTree &t) {
             }
         }
     }
+
+    if (f.GetStyle().layout_line_break) {
+        AnalyzeLayout(f, t);
+    }
 }
 
 void LineBreakAnalyzer::Query(FormatState &f, LuaSyntaxNode syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve) {
@@ -209,6 +214,11 @@ void LineBreakAnalyzer::Query(FormatState &f, LuaSyntaxNode syntaxNode, const Lu
                 resolve.SetNextLineBreak(lineBreakData.Data.Line);
                 break;
             }
+            case LineBreakStrategy::Layout: {
+                f.Notify(FormatEvent::NodeExceedLinebreak, syntaxNode, t);
+                resolve.SetNextLineBreak(LineSpace(1, LineBreakReason::ExceedMaxLine));
+                break;
+            }
             case LineBreakStrategy::WhenMayExceed: {
                 auto lineWidth = f.CurrentWidth();
                 auto &style = f.GetStyle();
@@ -459,14 +469,15 @@ bool LineBreakAnalyzer::CanCollapseLines(FormatState &f, LuaSyntaxNode &n, const
     switch (n.GetSyntaxKind(t)) {
         case LuaSyntaxNodeKind::ParamList:
         case LuaSyntaxNodeKind::TableFieldList: {
+            // 若有注释禁止塌缩, 包括嵌套在字段中的注释
+            if (n.ContainsComment(t)) {
+                return false;
+            }
             auto children = n.GetChildren(t);
             auto lineWidth = startCol;
             for (auto child: children) {
-                auto tokenKind = child.GetTokenKind(t);
-                if (tokenKind == ',') {
+                if (child.GetTokenKind(t) == ',') {
                     lineWidth++;// ', '
-                } else if (tokenKind == TK_SHORT_COMMENT || tokenKind == TK_LONG_COMMENT) {
-                    return false;// 若有注释禁止塌缩
                 }
                 lineWidth += child.GetText(t).size();
             }
@@ -477,3 +488,116 @@ bool LineBreakAnalyzer::CanCollapseLines(FormatState &f, LuaSyntaxNode &n, const
         }
     }
 }
+
+void LineBreakAnalyzer::AnalyzeLayout(FormatState &f, const LuaSyntaxTree &t) {
+    auto &nodes = f.GetAnalyzeNodes(t);
+    if (nodes.empty()) {
+        return;
+    }
+    auto &style = f.GetStyle();
+    auto indentSize = style.indent_style == IndentStyle::Space ? style.indent_size : style.tab_width;
+    auto spaceAnalyzer = f.GetAnalyzer<SpaceAnalyzer>();
+    // 可以由布局决定是否打断的 token, 即列表分隔符与二元运算符之后
+    std::vector<bool> lineAfter(t.GetSyntaxNodes().size() + 1, false);
+    std::vector<std::size_t> groupEnds;
+    std::vector<std::size_t> lines;
+    LineLayout layout(style.max_line_length);
+    std::size_t startColumn = 0;
+    bool first = true;
+    for (auto n: nodes) {
+        if (n.IsNode(t)) {
+            std::size_t indent = indentSize;
+            switch (n.GetSyntaxKind(t)) {
+                case LuaSyntaxNodeKind::ExpressionList: {
+                    if (n.GetParent(t).GetSyntaxKind(t) != LuaSyntaxNodeKind::CallExpression) {
+                        indent = style.continuation_indent;
+                    }
+                    [[fallthrough]];
+                }
+                case LuaSyntaxNodeKind::ParamList:
+                case LuaSyntaxNodeKind::NameDefList: {
+                    for (auto comma: n.GetChildTokens(',', t)) {
+                        lineAfter[comma.GetIndex()] = true;
+                    }
+                    break;
+                }
+                case LuaSyntaxNodeKind::TableFieldList: {
+                    for (auto field: n.GetChildSyntaxNodes(LuaSyntaxNodeKind::TableField, t)) {
+                        if (field.GetNextSibling(t).IsNode(t)) {
+                            lineAfter[field.GetLastToken(t).GetIndex()] = true;
+                        }
+                    }
+                    break;
+                }
+                case LuaSyntaxNodeKind::BinaryExpression: {
+                    indent = style.continuation_indent;
+                    for (auto child = n.GetFirstChild(t); !child.IsNull(t); child.ToNext(t)) {
+                        auto kind = child.GetTokenKind(t);
+                        if (child.IsToken(t) && kind != TK_SHORT_COMMENT && kind != TK_LONG_COMMENT) {
+                            lineAfter[child.GetIndex()] = true;
+                        }
+                    }
+                    break;
+                }
+                default: {
+                    continue;
+                }
+            }
+            auto lastToken = n.GetLastToken(t);
+            if (lastToken.IsToken(t)) {
+                layout.GroupBegin(indent);
+                groupEnds.push_back(lastToken.GetIndex());
+            }
+            continue;
+        }
+
+        if (first) {
+            startColumn = n.GetStartCol(t);
+            first = false;
+        }
+        layout.Text(n.GetFirstLineWidth(t));
+        if (!n.IsSingleLineNode(t)) {
+            layout.HardLine(n.GetEndCol(t) + 1, false);
+        }
+        while (!groupEnds.empty() && groupEnds.back() <= n.GetIndex()) {
+            layout.GroupEnd();
+            groupEnds.pop_back();
+        }
+
+        auto next = n.GetNextToken(t);
+        if (next.IsNull(t)) {
+            continue;
+        }
+        bool newLine = next.GetStartLine(t) > n.GetEndLine(t);
+        auto space = spaceAnalyzer->ProcessSpace(n, next, t);
+        auto it = _lineBreaks.find(n.GetIndex());
+        if (it != _lineBreaks.end() && it->second.Strategy == LineBreakStrategy::NotBreak) {
+            layout.Text(space);
+        } else if (it != _lineBreaks.end() && it->second.Strategy == LineBreakStrategy::Standard) {
+            if (newLine) {
+                layout.HardLine(next.GetStartCol(t));
+            } else {
+                layout.ForceLine();
+            }
+        } else if (newLine) {
+            layout.HardLine(next.GetStartCol(t));
+        } else if (lineAfter[n.GetIndex()]) {
+            layout.Line(n.GetIndex(), space);
+            lines.push_back(n.GetIndex());
+        } else {
+            layout.Text(space);
+        }
+    }
+
+    // 布局接管这些位置, 贪心的 WhenMayExceed 不再生效
+    auto breaks = layout.Layout(startColumn);
+    auto breakIt = breaks.begin();
+    for (auto index: lines) {
+        if (breakIt != breaks.end() && *breakIt == index) {
+            _lineBreaks[index] = LineBreakData(LineBreakStrategy::Layout, t.GetNextToken(index));
+            breakIt++;
+        } else {
+            _lineBreaks.erase(index);
+        }
+    }
+}
@@ -11,7 +11,7 @@ void SemicolonAnalyzer::Analyze(FormatState &f, const LuaSyntaxTree &t) {
         return;// No analysis needed
     }
 
-    for (auto syntaxNode: t.GetSyntaxNodes()) {
+    for (auto syntaxNode: f.GetAnalyzeNodes(t)) {
         if (syntaxNode.IsNode(t)) {
             if (detail::multi_match::StatementMatch(syntaxNode.GetSyntaxKind(t))) {
                 switch (f.GetStyle().end_statement_with_semicolon) {
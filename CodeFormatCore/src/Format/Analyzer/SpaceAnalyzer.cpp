@@ -9,7 +9,7 @@ SpaceAnalyzer::SpaceAnalyzer() {
 }
 
 void SpaceAnalyzer::Analyze(FormatState &f, const LuaSyntaxTree &t) {
-    for (auto syntaxNode: t.GetSyntaxNodes()) {
+    for (auto syntaxNode: f.GetAnalyzeNodes(t)) {
         if (syntaxNode.IsToken(t)) {
             switch (syntaxNode.GetTokenKind(t)) {
                 // math operator
@@ -140,7 +140,7 @@ void SpaceAnalyzer::Analyze(FormatState &f, const LuaSyntaxTree &t) {
 }
 
 void SpaceAnalyzer::ComplexAnalyze(FormatState &f, const LuaSyntaxTree &t) {
-    for (auto syntaxNode: t.GetSyntaxNodes()) {
+    for (auto syntaxNode: f.GetAnalyzeNodes(t)) {
         if (syntaxNode.IsNode(t)) {
             switch (syntaxNode.GetSyntaxKind(t)) {
                 case LuaSyntaxNodeKind::CallExpression: {
@@ -69,6 +69,17 @@ void FormatState::Analyze(const LuaSyntaxTree &t) {
     }
 }
 
+void FormatState::SetAnalyzeNodes(std::vector<LuaSyntaxNode> &&nodes) {
+    _analyzeNodes = std::move(nodes);
+}
+
+const std::vector<LuaSyntaxNode> &FormatState::GetAnalyzeNodes(const LuaSyntaxTree &t) const {
+    if (_analyzeNodes.has_value()) {
+        return _analyzeNodes.value();
+    }
+    return t.GetSyntaxNodes();
+}
+
 void FormatState::AddRelativeIndent(LuaSyntaxNode syntaxNoe, std::size_t indent) {
     if (_indentStack.empty()) {
         _indentStack.emplace(syntaxNoe, 0, 0);
@@ -162,6 +173,13 @@ void FormatState::DfsForeach(std::vector<LuaSyntaxNode> &startNodes,
                     continue;
                 }
             }
+            if (_traverseRange.has_value()) {
+                auto textRange = traverse.Node.GetTextRange(t);
+                auto &range = _traverseRange.value();
+                if (textRange.StartOffset >= range.StartOffset + range.Length || textRange.StartOffset + textRange.Length < range.StartOffset) {
+                    continue;
+                }
+            }
             for (auto &analyzer: _analyzers) {
                 analyzer->Query(*this, traverse.Node, t, resolve);
             }
@@ -245,6 +263,10 @@ void FormatState::StopDfsForeach() {
     _foreachContinue = false;
 }
 
+void FormatState::SetTraverseRange(TextRange range) {
+    _traverseRange = range;
+}
+
 FormatState::Mode FormatState::GetMode() const {
     return _mode;
 }
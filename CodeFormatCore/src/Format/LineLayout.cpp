@@ -0,0 +1,139 @@
+#include "CodeFormatCore/Format/LineLayout.h"
+
+LineLayout::LineLayout(std::size_t maxLineWidth)
+    : _maxLineWidth(maxLineWidth) {
+}
+
+void LineLayout::Text(std::size_t width) {
+    if (width == 0) {
+        return;
+    }
+    if (!_items.empty() && _items.back().Kind == ItemKind::Text) {
+        _items.back().Value += width;
+        return;
+    }
+    _items.emplace_back(ItemKind::Text, width);
+}
+
+void LineLayout::Line(std::size_t id, std::size_t flatWidth) {
+    _items.emplace_back(ItemKind::Line, id, flatWidth);
+}
+
+void LineLayout::HardLine(std::size_t column, bool newIndent) {
+    _items.emplace_back(ItemKind::HardLine, column, newIndent ? 1 : 0);
+}
+
+void LineLayout::ForceLine() {
+    _items.emplace_back(ItemKind::ForceLine, 0);
+}
+
+void LineLayout::GroupBegin(std::size_t indent) {
+    _items.emplace_back(ItemKind::GroupBegin, indent);
+}
+
+void LineLayout::GroupEnd() {
+    _items.emplace_back(ItemKind::GroupEnd, 0);
+}
+
+std::vector<std::size_t> LineLayout::Layout(std::size_t startColumn) const {
+    struct PendingLine {
+        std::size_t Item;
+        std::size_t Depth;
+        std::size_t Start;
+    };
+
+    // 第一遍: 求每个断点到同层或外层下一个断点之间的平铺宽度
+    // 栈内断点的层级严格递增, 遇到同层或外层断点时弹出
+    std::vector<std::size_t> sizes(_items.size(), 0);
+    std::vector<PendingLine> pending;
+    std::size_t total = 0;
+    std::size_t depth = 0;
+    auto finish = [&](std::size_t minDepth) {
+        while (!pending.empty() && pending.back().Depth >= minDepth) {
+            auto &line = pending.back();
+            sizes[line.Item] = total - line.Start;
+            pending.pop_back();
+        }
+    };
+    for (std::size_t i = 0; i != _items.size(); i++) {
+        auto &item = _items[i];
+        switch (item.Kind) {
+            case ItemKind::Text: {
+                total += item.Value;
+                break;
+            }
+            case ItemKind::Line: {
+                finish(depth);
+                pending.push_back({i, depth, total});
+                total += item.Extra;
+                break;
+            }
+            case ItemKind::HardLine:
+            case ItemKind::ForceLine: {
+                finish(0);
+                break;
+            }
+            case ItemKind::GroupBegin: {
+                depth++;
+                break;
+            }
+            case ItemKind::GroupEnd: {
+                if (depth > 0) {
+                    depth--;
+                }
+                break;
+            }
+        }
+    }
+    finish(0);
+
+    // 第二遍: 顺序布局, 放不下时打断
+    std::vector<std::size_t> breaks;
+    std::vector<std::size_t> indents;
+    std::size_t column = startColumn;
+    std::size_t lineIndent = startColumn;
+    for (std::size_t i = 0; i != _items.size(); i++) {
+        auto &item = _items[i];
+        switch (item.Kind) {
+            case ItemKind::Text: {
+                column += item.Value;
+                break;
+            }
+            case ItemKind::Line: {
+                auto indent = indents.empty() ? lineIndent : indents.back();
+                // 打断后不能变得更短时没有意义
+                if (column + sizes[i] > _maxLineWidth && indent < column) {
+                    breaks.push_back(item.Value);
+                    column = indent;
+                    lineIndent = indent;
+                } else {
+                    column += item.Extra;
+                }
+                break;
+            }
+            case ItemKind::HardLine: {
+                column = item.Value;
+                if (item.Extra) {
+                    lineIndent = column;
+                }
+                break;
+            }
+            case ItemKind::ForceLine: {
+                column = indents.empty() ? lineIndent : indents.back();
+                lineIndent = column;
+                break;
+            }
+            case ItemKind::GroupBegin: {
+                indents.push_back(lineIndent + item.Value);
+                break;
+            }
+            case ItemKind::GroupEnd: {
+                if (!indents.empty()) {
+                    indents.pop_back();
+                }
+                break;
+            }
+        }
+    }
+    return breaks;
+}
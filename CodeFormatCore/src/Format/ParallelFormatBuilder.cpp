@@ -0,0 +1,174 @@
+#include "CodeFormatCore/Format/ParallelFormatBuilder.h"
+#include "CodeFormatCore/Format/Analyzer/AlignAnalyzer.h"
+#include "CodeFormatCore/Format/Analyzer/FormatDocAnalyze.h"
+#include "LuaParser/Lexer/LuaTokenTypeDetail.h"
+#include <algorithm>
+#include <future>
+#include <thread>
+
+namespace {
+// 只格式化根语句块中的一段语句
+// 仍然从根节点开始遍历, 保证缩进栈与串行时一致, 范围之外的根语句直接跳过
+class ChunkFormatBuilder : public FormatBuilder {
+public:
+    explicit ChunkFormatBuilder(LuaStyle &style)
+        : FormatBuilder(style) {
+    }
+
+    std::string FormatChunk(const LuaSyntaxTree &t, std::vector<LuaSyntaxNode> &&analyzeNodes, TextRange range) {
+        _state.SetAnalyzeNodes(std::move(analyzeNodes));
+        _state.SetTraverseRange(range);
+        _state.Analyze(t);
+        _formattedText.reserve(range.Length);
+        std::vector<LuaSyntaxNode> startNodes = {t.GetRootNode()};
+
+        _state.DfsForeach(startNodes, t, [this](LuaSyntaxNode &syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve) {
+            DoResolve(syntaxNode, t, resolve);
+        });
+        return std::move(_formattedText);
+    }
+};
+}// namespace
+
+ParallelFormatBuilder::ParallelFormatBuilder(LuaStyle &style, std::size_t threadCount, std::size_t minChunkSize)
+    : FormatBuilder(style),
+      _threadCount(threadCount),
+      _minChunkSize(std::max<std::size_t>(minChunkSize, 1)),
+      _chunkCount(1) {
+    if (_threadCount == 0) {
+        _threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+}
+
+std::string ParallelFormatBuilder::GetFormatResult(const LuaSyntaxTree &t) {
+    _chunkCount = 1;
+    auto block = t.GetRootNode();
+    if (_threadCount < 2 || block.GetSyntaxKind(t) != LuaSyntaxNodeKind::Block) {
+        return FormatBuilder::GetFormatResult(t);
+    }
+
+    auto children = block.GetChildren(t);
+    auto starts = SplitChunks(children, t);
+    if (starts.size() < 2) {
+        return FormatBuilder::GetFormatResult(t);
+    }
+    _chunkCount = starts.size();
+
+    auto &nodes = t.GetSyntaxNodes();
+    LuaStyle style = _state.GetStyle();
+    std::vector<std::future<std::string>> futures;
+    for (std::size_t i = 0; i != starts.size(); i++) {
+        auto first = children[starts[i]];
+        auto last = children[(i + 1 == starts.size() ? children.size() : starts[i + 1]) - 1];
+        // 语法树按先序编号, 连续的根语句及其子孙占据一段连续的编号
+        auto startIndex = first.GetIndex();
+        auto endIndex = i + 1 == starts.size() ? nodes.size() : children[starts[i + 1]].GetIndex() - 1;
+
+        std::vector<LuaSyntaxNode> analyzeNodes = {block};
+        analyzeNodes.insert(analyzeNodes.end(), nodes.begin() + startIndex - 1, nodes.begin() + endIndex);
+        auto startOffset = first.GetTextRange(t).StartOffset;
+        auto lastRange = last.GetTextRange(t);
+        TextRange range(startOffset, lastRange.StartOffset + lastRange.Length - startOffset);
+
+        futures.push_back(std::async(std::launch::async, [&t, style, range, analyzeNodes = std::move(analyzeNodes)]() mutable {
+            ChunkFormatBuilder builder(style);
+            return builder.FormatChunk(t, std::move(analyzeNodes), range);
+        }));
+    }
+
+    _formattedText.reserve(t.GetFile().GetSource().size());
+    for (auto &future: futures) {
+        _formattedText.append(future.get());
+    }
+
+    // 只为取得文件的换行符
+    _state.SetAnalyzeNodes(std::vector<LuaSyntaxNode>());
+    _state.Analyze(t);
+    DealEndWithNewLine(_state.GetStyle().insert_final_newline);
+    return _formattedText;
+}
+
+std::size_t ParallelFormatBuilder::GetChunkCount() const {
+    return _chunkCount;
+}
+
+std::vector<std::size_t> ParallelFormatBuilder::SplitChunks(std::vector<LuaSyntaxNode> &children, const LuaSyntaxTree &t) {
+    std::vector<std::size_t> starts = {0};
+    if (children.size() < 2) {
+        return starts;
+    }
+
+    auto total = t.GetSyntaxNodes().size() + 1 - children.front().GetIndex();
+    auto chunkCount = std::min(_threadCount, total / _minChunkSize);
+    if (chunkCount < 2) {
+        return starts;
+    }
+
+    std::vector<std::size_t> childIndexes;
+    childIndexes.reserve(children.size());
+    for (auto child: children) {
+        childIndexes.push_back(child.GetIndex());
+    }
+    auto position = [&](std::size_t index) -> std::size_t {
+        auto it = std::upper_bound(childIndexes.begin(), childIndexes.end(), index);
+        return it == childIndexes.begin() ? 0 : it - childIndexes.begin() - 1;
+    };
+
+    // crosses[i] > 0 表示第 i 个根语句之前的边界被跨越
+    std::vector<int> crosses(children.size() + 1, 0);
+    auto markCross = [&](std::size_t startIndex, std::size_t endIndex) {
+        auto lo = position(startIndex);
+        auto hi = position(endIndex);
+        if (lo < hi) {
+            crosses[lo + 1]++;
+            crosses[hi + 1]--;
+        }
+    };
+
+    // 只需要分析根语句块与注释就能得到所有可能跨越根语句的对齐组和忽略范围
+    auto block = children.front().GetParent(t);
+    std::vector<LuaSyntaxNode> analyzeNodes = {block};
+    for (auto &n: t.GetSyntaxNodes()) {
+        if (n.GetTokenKind(t) == TK_SHORT_COMMENT) {
+            analyzeNodes.push_back(n);
+        }
+    }
+    FormatState state;
+    LuaStyle style = _state.GetStyle();
+    state.SetFormatStyle(style);
+    state.SetAnalyzeNodes(std::move(analyzeNodes));
+
+    AlignAnalyzer alignAnalyzer;
+    alignAnalyzer.Analyze(state, t);
+    for (auto &group: alignAnalyzer.GetAlignGroups()) {
+        if (!group.SyntaxGroup.empty()) {
+            auto [minIt, maxIt] = std::minmax_element(group.SyntaxGroup.begin(), group.SyntaxGroup.end());
+            markCross(*minIt, *maxIt);
+        }
+    }
+
+    FormatDocAnalyze formatDocAnalyze;
+    formatDocAnalyze.Analyze(state, t);
+    for (auto &range: formatDocAnalyze.GetIgnores()) {
+        markCross(range.StartIndex, range.EndIndex);
+    }
+
+    auto target = total / chunkCount;
+    auto chunkStart = childIndexes.front();
+    int cross = crosses[0];
+    for (std::size_t i = 1; i < children.size(); i++) {
+        cross += crosses[i];
+        if (cross > 0 || childIndexes[i] - chunkStart < target) {
+            continue;
+        }
+        if (children[i].GetStartLine(t) <= children[i - 1].GetEndLine(t)) {
+            continue;
+        }
+        starts.push_back(i);
+        chunkStart = childIndexes[i];
+        if (starts.size() == chunkCount) {
+            break;
+        }
+    }
+    return starts;
+}
@@ -0,0 +1,78 @@
+#include "CodeFormatCore/Format/VerifyFormatBuilder.h"
+
+VerifyFormatBuilder::VerifyFormatBuilder(LuaStyle &style)
+    : FormatBuilder(style),
+      _verifiedOffset(0),
+      _isDiff(false) {
+}
+
+bool VerifyFormatBuilder::IsFormatted(const LuaSyntaxTree &t) {
+    _state.Analyze(t);
+    _source = t.GetFile().GetSource();
+    _verifiedOffset = 0;
+    _isDiff = false;
+    auto root = t.GetRootNode();
+    std::vector<LuaSyntaxNode> startNodes = {root};
+
+    _state.DfsForeach(startNodes, t, [this](LuaSyntaxNode &syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve) {
+        DoResolve(syntaxNode, t, resolve);
+    });
+
+    if (_isDiff) {
+        return false;
+    }
+
+    if (_verifiedOffset == 0) {
+        DealEndWithNewLine(_state.GetStyle().insert_final_newline);
+    } else {
+        // the verified part always ends with a non line break char, so only the buffer need to be trimmed
+        auto lastIndex = _formattedText.find_last_not_of("\r\n");
+        _formattedText.resize(lastIndex == std::string::npos ? 0 : lastIndex + 1);
+        if (_state.GetStyle().insert_final_newline) {
+            if (_formattedText.empty()) {
+                AddEndOfLine(1);
+            } else {
+                FormatBuilder::WriteLine(1);
+            }
+        }
+    }
+    Verify(true);
+    if (!_isDiff && _verifiedOffset != _source.size()) {
+        _isDiff = true;
+    }
+    return !_isDiff;
+}
+
+std::size_t VerifyFormatBuilder::GetDiffOffset() const {
+    return _verifiedOffset;
+}
+
+void VerifyFormatBuilder::WriteLine(std::size_t line) {
+    FormatBuilder::WriteLine(line);
+    if (line != 0 && !_isDiff) {
+        Verify(false);
+    }
+}
+
+void VerifyFormatBuilder::Verify(bool finish) {
+    auto end = _formattedText.size();
+    if (!finish) {
+        // trailing line breaks may still be trimmed, and the trailing space trim of WriteLine
+        // needs a non-space tail, so keep them in the buffer
+        while (end > 0 && (_formattedText[end - 1] == '\n' || _formattedText[end - 1] == '\r')) {
+            end--;
+        }
+    }
+
+    for (std::size_t i = 0; i != end; i++) {
+        if (_verifiedOffset + i >= _source.size() || _source[_verifiedOffset + i] != _formattedText[i]) {
+            _verifiedOffset += i;
+            _isDiff = true;
+            _state.StopDfsForeach();
+            return;
+        }
+    }
+
+    _verifiedOffset += end;
+    _formattedText.erase(0, end);
+}
@@ -1,12 +1,20 @@
 #include "CodeFormatCore/RangeFormat/RangeFormatBuilder.h"
+#include "CodeFormatCore/Format/Analyzer/AlignAnalyzer.h"
 #include "CodeFormatCore/Format/Analyzer/FormatDocAnalyze.h"
 #include "LuaParser/Lexer/LuaTokenTypeDetail.h"
+#include "Util/StringUtil.h"
+#include <algorithm>
 
 RangeFormatBuilder::RangeFormatBuilder(LuaStyle &style, FormatRange &range)
     : FormatBuilder(style), _validRange(Valid::Init), _range(range) {
 }
 
 std::string RangeFormatBuilder::GetFormatResult(const LuaSyntaxTree &t) {
+    auto startNodes = CollectLocalNodes(t);
+    if (startNodes.empty()) {
+        startNodes.push_back(t.GetRootNode());
+    }
+
     _state.Analyze(t);
 
     auto formatDoc = _state.GetAnalyzer<FormatDocAnalyze>();
@@ -21,8 +29,10 @@ std::string RangeFormatBuilder::GetFormatResult(const LuaSyntaxTree &t) {
         }
     }
 
-    auto root = t.GetRootNode();
-    std::vector<LuaSyntaxNode> startNodes = {root};
+    auto alignAnalyzer = _state.GetAnalyzer<AlignAnalyzer>();
+    if (alignAnalyzer) {
+        alignAnalyzer->ResolveGroupBefore(_state, startNodes.front().GetIndex(), t);
+    }
 
     _state.DfsForeach(startNodes, t, [this](LuaSyntaxNode &syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve) {
         CheckRange(syntaxNode, t, resolve);
@@ -113,6 +123,158 @@ void RangeFormatBuilder::WriteText(std::string_view text) {
     }
 }
 
+std::vector<LuaSyntaxNode> RangeFormatBuilder::CollectLocalNodes(const LuaSyntaxTree &t) {
+    std::vector<LuaSyntaxNode> localNodes;
+    auto &file = t.GetFile();
+    auto startOffset = file.GetOffset(_range.StartLine, 0);
+    auto endOffset = file.GetOffset(_range.EndLine + 1, 0);
+    if (startOffset > file.GetSource().size() || endOffset == 0) {
+        return localNodes;
+    }
+
+    auto firstToken = t.GetTokenBeforeOffset(startOffset);
+    if (firstToken.IsNull(t)) {
+        firstToken = t.GetRootNode().GetFirstToken(t);
+    } else if (firstToken.GetEndLine(t) < _range.StartLine) {
+        firstToken = firstToken.GetNextToken(t);
+    }
+    auto lastToken = t.GetTokenBeforeOffset(endOffset - 1);
+    if (firstToken.IsNull(t) || lastToken.IsNull(t) || lastToken.GetIndex() < firstToken.GetIndex()) {
+        return localNodes;
+    }
+
+    // 两端token的公共祖先所在的block
+    std::vector<LuaSyntaxNode> firstAncestors;
+    for (auto n = firstToken.GetParent(t); !n.IsNull(t); n = n.GetParent(t)) {
+        firstAncestors.push_back(n);
+    }
+    auto block = lastToken.GetParent(t);
+    while (!block.IsNull(t)) {
+        if (block.GetSyntaxKind(t) == LuaSyntaxNodeKind::Block && std::find_if(firstAncestors.begin(), firstAncestors.end(), [&block](LuaSyntaxNode &n) {
+                return n.GetIndex() == block.GetIndex();
+            }) != firstAncestors.end()) {
+            break;
+        }
+        block = block.GetParent(t);
+    }
+    if (block.IsNull(t)) {
+        return localNodes;
+    }
+
+    auto firstStmt = firstToken;
+    while (firstStmt.GetParent(t).GetIndex() != block.GetIndex()) {
+        firstStmt = firstStmt.GetParent(t);
+    }
+    auto lastStmt = lastToken;
+    while (lastStmt.GetParent(t).GetIndex() != block.GetIndex()) {
+        lastStmt = lastStmt.GetParent(t);
+    }
+    for (auto n = firstStmt; !n.IsNull(t); n.ToNext(t)) {
+        localNodes.push_back(n);
+        if (n.GetIndex() == lastStmt.GetIndex()) {
+            break;
+        }
+    }
+
+    // block 本身决定语句间的换行和对齐, 之前的注释可能是 ---@format disable
+    std::vector<LuaSyntaxNode> analyzeNodes;
+    auto child = firstStmt;
+    for (auto parent = block; !parent.IsNull(t); parent = parent.GetParent(t)) {
+        if (parent.GetSyntaxKind(t) == LuaSyntaxNodeKind::Block) {
+            for (auto prev = child.GetPrevSibling(t); !prev.IsNull(t); prev.ToPrev(t)) {
+                if (prev.GetTokenKind(t) == TK_SHORT_COMMENT) {
+                    analyzeNodes.push_back(prev);
+                }
+            }
+        }
+        child = parent;
+    }
+    analyzeNodes.push_back(block);
+
+    auto lastNode = lastStmt;
+    while (!lastNode.GetLastChild(t).IsNull(t)) {
+        lastNode = lastNode.GetLastChild(t);
+    }
+    for (auto index = firstStmt.GetIndex(); index <= lastNode.GetIndex(); index++) {
+        analyzeNodes.emplace_back(index);
+    }
+    if (_state.GetStyle().align_continuous_inline_comment) {
+        CollectInlineComments(firstStmt, lastNode, t, analyzeNodes);
+    }
+    std::sort(analyzeNodes.begin(), analyzeNodes.end(), [](const LuaSyntaxNode &x, const LuaSyntaxNode &y) {
+        return x.GetIndex() < y.GetIndex();
+    });
+    _state.SetAnalyzeNodes(std::move(analyzeNodes));
+
+    auto startToken = firstStmt.GetFirstToken(t);
+    auto tokenOffset = startToken.GetTextRange(t).StartOffset;
+    auto indentRange = file.GetIndentRange(tokenOffset);
+    auto indent = GetSourceWidth(file.Slice(indentRange));
+    _state.AddAbsoluteIndent(block, indent);
+    if (indentRange.StartOffset + indentRange.Length < tokenOffset) {
+        _state.CurrentWidth() = indent + file.GetColumn(tokenOffset) - indentRange.Length;
+    }
+    return localNodes;
+}
+
+static bool IsInlineComment(LuaSyntaxNode n, const LuaSyntaxTree &t) {
+    if (n.GetTokenKind(t) != TK_SHORT_COMMENT) {
+        return false;
+    }
+    auto prevToken = n.GetPrevToken(t);
+    return !prevToken.IsNull(t) && prevToken.GetEndLine(t) == n.GetStartLine(t) && !string_util::StartWith(n.GetText(t), "---@");
+}
+
+void RangeFormatBuilder::CollectInlineComments(LuaSyntaxNode firstNode, LuaSyntaxNode lastNode, const LuaSyntaxTree &t,
+                                               std::vector<LuaSyntaxNode> &analyzeNodes) {
+    // 连续的行尾注释会跨越范围对齐, 相距不超过2行的都属于同一组
+    auto firstToken = firstNode.GetFirstToken(t);
+    auto lastToken = lastNode.GetLastToken(t);
+    if (firstToken.IsNull(t) || lastToken.IsNull(t)) {
+        return;
+    }
+
+    auto startLine = firstToken.GetStartLine(t);
+    for (auto token = firstToken; !token.IsNull(t) && token.GetIndex() <= lastToken.GetIndex() && token.GetStartLine(t) <= startLine + 2; token = token.GetNextToken(t)) {
+        if (IsInlineComment(token, t)) {
+            auto line = token.GetStartLine(t);
+            for (auto prev = firstToken.GetPrevToken(t); !prev.IsNull(t) && prev.GetEndLine(t) + 2 >= line; prev = prev.GetPrevToken(t)) {
+                if (IsInlineComment(prev, t)) {
+                    analyzeNodes.push_back(prev);
+                    line = prev.GetStartLine(t);
+                }
+            }
+            break;
+        }
+    }
+
+    auto endLine = lastToken.GetEndLine(t);
+    for (auto token = lastToken; !token.IsNull(t) && token.GetIndex() >= firstToken.GetIndex() && token.GetEndLine(t) + 2 >= endLine; token = token.GetPrevToken(t)) {
+        if (IsInlineComment(token, t)) {
+            auto line = token.GetEndLine(t);
+            for (auto next = lastToken.GetNextToken(t); !next.IsNull(t) && next.GetStartLine(t) <= line + 2; next = next.GetNextToken(t)) {
+                if (IsInlineComment(next, t)) {
+                    analyzeNodes.push_back(next);
+                    line = next.GetEndLine(t);
+                }
+            }
+            break;
+        }
+    }
+}
+
+std::size_t RangeFormatBuilder::GetSourceWidth(std::string_view text) const {
+    std::size_t width = 0;
+    for (auto ch: text) {
+        if (ch == '\t') {
+            width += _state.GetStyle().tab_width;
+        } else {
+            width++;
+        }
+    }
+    return width;
+}
+
 void RangeFormatBuilder::CheckRange(LuaSyntaxNode &syntaxNode, const LuaSyntaxTree &t, FormatResolve &resolve) {
     if (syntaxNode.IsToken(t)) {
         LuaSyntaxNode startNode = syntaxNode;
@@ -131,7 +293,16 @@ void RangeFormatBuilder::CheckRange(LuaSyntaxNode &syntaxNode, const LuaSyntaxTr
                     auto tokenStartLine = startNode.GetStartLine(t);
                     if (tokenStartLine < _range.StartLine) {
                         _range.StartLine = tokenStartLine;
-                        _range.StartCol = startNode.GetStartCol(t);
+                        // 行首的token会连同缩进一起输出
+                        auto prevToken = startNode.GetPrevToken(t);
+                        if (!prevToken.IsNull(t) && prevToken.GetEndLine(t) == tokenStartLine) {
+                            _range.StartCol = startNode.GetStartCol(t);
+                        } else {
+                            _range.StartCol = 0;
+                        }
+                    }
+                    if (tokenEndLine > _range.EndLine) {
+                        _range.EndLine = tokenEndLine;
                     }
                 }
                 break;
@@ -1,5 +1,8 @@
 ﻿#include "LuaCodeFormat.h"
 #include "lua.hpp"
+#include "Util/format.h"
+#include <new>
+#include <stdexcept>
 
 #ifdef _MSC_VER
 #define EXPORT __declspec(dllexport)
@@ -50,7 +53,32 @@ std::string GetDiagnosisString(DiagnosticType type) {
     return "";
 }
 
-int format(lua_State *L) {
+// open 返回的文档句柄, 关闭后指针为空
+constexpr const char *DocumentMetatable = "code_format.document";
+
+std::shared_ptr<LuaDocument> *toDocumentHandle(lua_State *L, int idx) {
+    return static_cast<std::shared_ptr<LuaDocument> *>(luaL_testudata(L, idx, DocumentMetatable));
+}
+
+// 第一个参数可以是 open 返回的文档, 也可以是文件名和文本
+// 返回其余参数的起始位置, 参数不匹配时返回 0
+int getDocument(lua_State *L, std::shared_ptr<LuaDocument> &document) {
+    if (auto handle = toDocumentHandle(L, 1)) {
+        if (!*handle) {
+            throw std::runtime_error("document is closed");
+        }
+        document = *handle;
+        return 2;
+    }
+
+    if (lua_gettop(L) >= 2 && lua_isstring(L, 1) && lua_isstring(L, 2)) {
+        document = std::make_shared<LuaDocument>(lua_tostring(L, 1), lua_tostring(L, 2));
+        return 3;
+    }
+    return 0;
+}
+
+int document_open(lua_State *L) {
     int top = lua_gettop(L);
 
     if (top < 2) {
@@ -59,33 +87,46 @@ int format(lua_State *L) {
 
     if (lua_isstring(L, 1) && lua_isstring(L, 2)) {
         try {
-            std::string filename = lua_tostring(L, 1);
-            std::string text = lua_tostring(L, 2);
-            LuaCodeFormat::ConfigMap configMap;
+            std::string uri = lua_tostring(L, 1);
+            std::size_t len = 0;
+            auto text = lua_tolstring(L, 2, &len);
+            auto document = std::make_shared<LuaDocument>(uri, std::string(text, len));
 
-            if (top == 3 && lua_istable(L, 3)) {
-                lua_pushnil(L);
-                while (lua_next(L, -2) != 0) {
-                    auto key = luaToString(L, -2);
-                    auto value = luaToString(L, -1);
+            lua_pushboolean(L, true);
+            auto handle = static_cast<std::shared_ptr<LuaDocument> *>(
+                    lua_newuserdatauv(L, sizeof(std::shared_ptr<LuaDocument>), 0));
+            new (handle) std::shared_ptr<LuaDocument>(std::move(document));
+            luaL_setmetatable(L, DocumentMetatable);
+            return 2;
+        } catch (std::exception &e) {
+            std::string err = e.what();
+            lua_settop(L, top);
+            lua_pushboolean(L, false);
+            lua_pushlstring(L, err.c_str(), err.size());
+            return 2;
+        }
+    }
+    return 0;
+}
 
-                    if (key != "nil") {
-                        configMap.insert({key, value});
-                    }
+int document_update(lua_State *L) {
+    int top = lua_gettop(L);
 
-                    lua_pop(L, 1);
-                }
-            }
+    if (top < 2) {
+        return 0;
+    }
 
-            auto formattedTextResult = LuaCodeFormat::GetInstance().Reformat(filename, std::move(text), configMap);
-            if (formattedTextResult.Type == ResultType::Err) {
-                lua_pushboolean(L, false);
-                return 1;
+    auto handle = toDocumentHandle(L, 1);
+    if (handle && lua_isstring(L, 2)) {
+        try {
+            if (!*handle) {
+                throw std::runtime_error("document is closed");
             }
-            auto &formattedText = formattedTextResult.Data;
+            std::size_t len = 0;
+            auto text = lua_tolstring(L, 2, &len);
+            (*handle)->Update(std::string(text, len));
             lua_pushboolean(L, true);
-            lua_pushlstring(L, formattedText.c_str(), formattedText.size());
-            return 2;
+            return 1;
         } catch (std::exception &e) {
             std::string err = e.what();
             lua_settop(L, top);
@@ -97,6 +138,69 @@ int format(lua_State *L) {
     return 0;
 }
 
+int document_close(lua_State *L) {
+    auto handle = toDocumentHandle(L, 1);
+    if (!handle) {
+        return 0;
+    }
+
+    handle->reset();
+    lua_pushboolean(L, true);
+    return 1;
+}
+
+// 空的 shared_ptr 不持有资源, 只 reset 而不析构, 重复调用也是安全的
+int document_gc(lua_State *L) {
+    auto handle = toDocumentHandle(L, 1);
+    if (handle && *handle) {
+        handle->reset();
+    }
+    return 0;
+}
+
+int format(lua_State *L) {
+    int top = lua_gettop(L);
+
+    try {
+        std::shared_ptr<LuaDocument> document;
+        int next = getDocument(L, document);
+        if (next == 0) {
+            return 0;
+        }
+
+        LuaCodeFormat::ConfigMap configMap;
+        if (top == next && lua_istable(L, next)) {
+            lua_pushnil(L);
+            while (lua_next(L, -2) != 0) {
+                auto key = luaToString(L, -2);
+                auto value = luaToString(L, -1);
+
+                if (key != "nil") {
+                    configMap.insert({key, value});
+                }
+
+                lua_pop(L, 1);
+            }
+        }
+
+        auto formattedTextResult = LuaCodeFormat::GetInstance().Reformat(*document, configMap);
+        if (formattedTextResult.Type == ResultType::Err) {
+            lua_pushboolean(L, false);
+            return 1;
+        }
+        auto &formattedText = formattedTextResult.Data;
+        lua_pushboolean(L, true);
+        lua_pushlstring(L, formattedText.c_str(), formattedText.size());
+        return 2;
+    } catch (std::exception &e) {
+        std::string err = e.what();
+        lua_settop(L, top);
+        lua_pushboolean(L, false);
+        lua_pushlstring(L, err.c_str(), err.size());
+        return 2;
+    }
+}
+
 enum class UpdateType {
     Created = 1,
     Changed = 2,
@@ -106,191 +210,190 @@ enum class UpdateType {
 int range_format(lua_State *L) {
     int top = lua_gettop(L);
 
-    if (top < 4) {
-        return 0;
-    }
+    try {
+        std::shared_ptr<LuaDocument> document;
+        int next = getDocument(L, document);
+        if (next == 0) {
+            return 0;
+        }
 
-    if (lua_isstring(L, 1) && lua_isstring(L, 2) && lua_isinteger(L, 3) && lua_isinteger(L, 4)) {
-        try {
-            std::string filename = lua_tostring(L, 1);
-            std::string text = lua_tostring(L, 2);
-            auto startLine = lua_tointeger(L, 3);
-            auto endLine = lua_tointeger(L, 4);
-
-            if (startLine < 0 || endLine < 0) {
-                lua_pushboolean(L, false);
-                lua_pushstring(L, "start line or end line < 0");
-                return 2;
-            }
+        if (!lua_isinteger(L, next) || !lua_isinteger(L, next + 1)) {
+            return 0;
+        }
 
-            LuaCodeFormat::ConfigMap configMap;
+        auto startLine = lua_tointeger(L, next);
+        auto endLine = lua_tointeger(L, next + 1);
 
-            if (top == 5 && lua_istable(L, 5)) {
-                lua_pushnil(L);
-                while (lua_next(L, -2) != 0) {
-                    auto key = luaToString(L, -2);
-                    auto value = luaToString(L, -1);
+        if (startLine < 0 || endLine < 0) {
+            lua_pushboolean(L, false);
+            lua_pushstring(L, "start line or end line < 0");
+            return 2;
+        }
 
-                    if (key != "nil") {
-                        configMap.insert({key, value});
-                    }
+        LuaCodeFormat::ConfigMap configMap;
+        if (top == next + 2 && lua_istable(L, next + 2)) {
+            lua_pushnil(L);
+            while (lua_next(L, -2) != 0) {
+                auto key = luaToString(L, -2);
+                auto value = luaToString(L, -1);
 
-                    lua_pop(L, 1);
+                if (key != "nil") {
+                    configMap.insert({key, value});
                 }
-            }
 
-            FormatRange range(static_cast<std::size_t>(startLine), static_cast<std::size_t>(endLine));
-            auto formattedTextResult = LuaCodeFormat::GetInstance().RangeFormat(filename, range, std::move(text),
-                                                                                configMap);
-            if (formattedTextResult.Type == ResultType::Err) {
-                lua_pushboolean(L, false);
-                return 1;
-            }
-            auto &formattedText = formattedTextResult.Data;
-            if (formattedText.empty()) {
-                lua_pushboolean(L, false);
-                return 1;
+                lua_pop(L, 1);
             }
+        }
 
-            lua_pushboolean(L, true);
-            lua_pushlstring(L, formattedText.c_str(), formattedText.size());
-            lua_pushinteger(L, range.StartLine);
-            lua_pushinteger(L, range.EndLine);
-
-            return 4;
-        } catch (std::exception &e) {
-            std::string err = e.what();
-            lua_settop(L, top);
+        FormatRange range(static_cast<std::size_t>(startLine), static_cast<std::size_t>(endLine));
+        auto formattedTextResult = LuaCodeFormat::GetInstance().RangeFormat(*document, range, configMap);
+        if (formattedTextResult.Type == ResultType::Err) {
             lua_pushboolean(L, false);
-            lua_pushlstring(L, err.c_str(), err.size());
-            return 2;
+            return 1;
+        }
+        auto &formattedText = formattedTextResult.Data;
+        if (formattedText.empty()) {
+            lua_pushboolean(L, false);
+            return 1;
         }
+
+        lua_pushboolean(L, true);
+        lua_pushlstring(L, formattedText.c_str(), formattedText.size());
+        lua_pushinteger(L, range.StartLine);
+        lua_pushinteger(L, range.EndLine);
+
+        return 4;
+    } catch (std::exception &e) {
+        std::string err = e.what();
+        lua_settop(L, top);
+        lua_pushboolean(L, false);
+        lua_pushlstring(L, err.c_str(), err.size());
+        return 2;
     }
-    return 0;
 }
 
 
 int type_format(lua_State *L) {
     int top = lua_gettop(L);
 
-    if (top < 4) {
-        return 0;
-    }
+    try {
+        std::shared_ptr<LuaDocument> document;
+        int next = getDocument(L, document);
+        if (next == 0) {
+            return 0;
+        }
 
-    if (lua_isstring(L, 1) && lua_isstring(L, 2) && lua_isinteger(L, 3) && lua_isinteger(L, 4)) {
-        try {
-            std::string filename = lua_tostring(L, 1);
-            std::string text = lua_tostring(L, 2);
-            auto line = lua_tointeger(L, 3);
-            auto character = lua_tointeger(L, 4);
-
-            if (line < 0 || character < 0) {
-                lua_pushboolean(L, false);
-                lua_pushstring(L, "line or character param error");
-                return 2;
-            }
+        if (!lua_isinteger(L, next) || !lua_isinteger(L, next + 1)) {
+            return 0;
+        }
 
-            LuaCodeFormat::ConfigMap configMap;
+        auto line = lua_tointeger(L, next);
+        auto character = lua_tointeger(L, next + 1);
 
-            if (top == 5 && lua_istable(L, 5)) {
-                lua_pushnil(L);
-                while (lua_next(L, -2) != 0) {
-                    auto key = luaToString(L, -2);
-                    auto value = luaToString(L, -1);
+        if (line < 0 || character < 0) {
+            lua_pushboolean(L, false);
+            lua_pushstring(L, "line or character param error");
+            return 2;
+        }
 
-                    if (key != "nil") {
-                        configMap.insert({key, value});
-                    }
+        LuaCodeFormat::ConfigMap configMap;
+        if (top == next + 2 && lua_istable(L, next + 2)) {
+            lua_pushnil(L);
+            while (lua_next(L, -2) != 0) {
+                auto key = luaToString(L, -2);
+                auto value = luaToString(L, -1);
 
-                    lua_pop(L, 1);
+                if (key != "nil") {
+                    configMap.insert({key, value});
                 }
-            }
 
-            LuaCodeFormat::ConfigMap stringTypeOptions;
-            if (top == 6 && lua_istable(L, 6)) {
-                lua_pushnil(L);
-                while (lua_next(L, -2) != 0) {
-                    auto key = luaToString(L, -2);
-                    auto value = luaToString(L, -1);
+                lua_pop(L, 1);
+            }
+        }
 
-                    if (key != "nil") {
-                        stringTypeOptions.insert({key, value});
-                    }
+        LuaCodeFormat::ConfigMap stringTypeOptions;
+        if (top == next + 3 && lua_istable(L, next + 3)) {
+            lua_pushnil(L);
+            while (lua_next(L, -2) != 0) {
+                auto key = luaToString(L, -2);
+                auto value = luaToString(L, -1);
 
-                    lua_pop(L, 1);
+                if (key != "nil") {
+                    stringTypeOptions.insert({key, value});
                 }
+
+                lua_pop(L, 1);
             }
-            auto typeFormatResult = LuaCodeFormat::GetInstance()
-                                            .TypeFormat(filename,
-                                                        static_cast<std::size_t>(line), static_cast<std::size_t>(character),
-                                                        std::move(text), configMap, stringTypeOptions);
-
-            if (typeFormatResult.Type == ResultType::Err) {
-                lua_pushboolean(L, false);
-                return 1;
-            }
-            auto &typeFormats = typeFormatResult.Data;
-            if (typeFormats.empty()) {
-                lua_pushboolean(L, false);
-                return 1;
-            }
+        }
+        auto typeFormatResult = LuaCodeFormat::GetInstance()
+                                        .TypeFormat(*document,
+                                                    static_cast<std::size_t>(line), static_cast<std::size_t>(character),
+                                                    configMap, stringTypeOptions);
 
-            lua_pushboolean(L, true);
-            auto &result = typeFormats.front();
-            // 结果
-            lua_newtable(L);
+        if (typeFormatResult.Type == ResultType::Err) {
+            lua_pushboolean(L, false);
+            return 1;
+        }
+        auto &typeFormats = typeFormatResult.Data;
+        if (typeFormats.empty()) {
+            lua_pushboolean(L, false);
+            return 1;
+        }
 
-            //message
-            {
-                lua_pushstring(L, "newText");
-                lua_pushlstring(L, result.Text.c_str(), result.Text.size());
-                lua_rawset(L, -3);
-            }
+        lua_pushboolean(L, true);
+        auto &result = typeFormats.front();
+        // 结果
+        lua_newtable(L);
 
-            // range
-            {
-                lua_pushstring(L, "range");
-                //range table
-                lua_newtable(L);
-
-                lua_pushstring(L, "start");
-                // start table
-                lua_newtable(L);
-                lua_pushstring(L, "line");
-                lua_pushinteger(L, result.Range.StartLine);
-                lua_rawset(L, -3);
+        //message
+        {
+            lua_pushstring(L, "newText");
+            lua_pushlstring(L, result.Text.c_str(), result.Text.size());
+            lua_rawset(L, -3);
+        }
 
-                lua_pushstring(L, "character");
-                lua_pushinteger(L, result.Range.StartCol);
-                lua_rawset(L, -3);
+        // range
+        {
+            lua_pushstring(L, "range");
+            //range table
+            lua_newtable(L);
 
-                lua_rawset(L, -3);// set start = {}
+            lua_pushstring(L, "start");
+            // start table
+            lua_newtable(L);
+            lua_pushstring(L, "line");
+            lua_pushinteger(L, result.Range.StartLine);
+            lua_rawset(L, -3);
 
-                lua_pushstring(L, "end");
-                // end table
-                lua_newtable(L);
-                lua_pushstring(L, "line");
-                lua_pushinteger(L, result.Range.EndLine);
-                lua_rawset(L, -3);
+            lua_pushstring(L, "character");
+            lua_pushinteger(L, result.Range.StartCol);
+            lua_rawset(L, -3);
 
-                lua_pushstring(L, "character");
-                lua_pushinteger(L, result.Range.EndCol);
-                lua_rawset(L, -3);
+            lua_rawset(L, -3);// set start = {}
 
-                lua_rawset(L, -3);// set end = {}
+            lua_pushstring(L, "end");
+            // end table
+            lua_newtable(L);
+            lua_pushstring(L, "line");
+            lua_pushinteger(L, result.Range.EndLine);
+            lua_rawset(L, -3);
 
-                lua_rawset(L, -3);// set range = {}
-            }
-            return 2;
-        } catch (std::exception &e) {
-            std::string err = e.what();
-            lua_settop(L, top);
-            lua_pushboolean(L, false);
-            lua_pushlstring(L, err.c_str(), err.size());
-            return 2;
+            lua_pushstring(L, "character");
+            lua_pushinteger(L, result.Range.EndCol);
+            lua_rawset(L, -3);
+
+            lua_rawset(L, -3);// set end = {}
+
+            lua_rawset(L, -3);// set range = {}
         }
+        return 2;
+    } catch (std::exception &e) {
+        std::string err = e.what();
+        lua_settop(L, top);
+        lua_pushboolean(L, false);
+        lua_pushlstring(L, err.c_str(), err.size());
+        return 2;
     }
-    return 0;
 }
 
 
@@ -401,34 +504,31 @@ void PushDiagnosticToLua(lua_State *L, std::vector<LuaDiagnosticInfo> &diagnosti
 int diagnose_file(lua_State *L) {
     int top = lua_gettop(L);
 
-    if (top < 2) {
-        return 0;
-    }
-
-    if (lua_isstring(L, 1) && lua_isstring(L, 2)) {
-        try {
-            std::string filename = lua_tostring(L, 1);
-            std::string text = lua_tostring(L, 2);
-            auto diagnosticResult = LuaCodeFormat::GetInstance().Diagnostic(filename, std::move(text));
-            if (diagnosticResult.Type == ResultType::Err) {
-                lua_pushboolean(L, false);
-                return 1;
-            }
-
-            auto &diagnostics = diagnosticResult.Data;
-            lua_pushboolean(L, true);
-            PushDiagnosticToLua(L, diagnostics);
+    try {
+        std::shared_ptr<LuaDocument> document;
+        int next = getDocument(L, document);
+        if (next == 0) {
+            return 0;
+        }
 
-            return 2;
-        } catch (std::exception &e) {
-            std::string err = e.what();
-            lua_settop(L, top);
+        auto diagnosticResult = LuaCodeFormat::GetInstance().Diagnostic(*document);
+        if (diagnosticResult.Type == ResultType::Err) {
             lua_pushboolean(L, false);
-            lua_pushlstring(L, err.c_str(), err.size());
-            return 2;
+            return 1;
         }
+
+        auto &diagnostics = diagnosticResult.Data;
+        lua_pushboolean(L, true);
+        PushDiagnosticToLua(L, diagnostics);
+
+        return 2;
+    } catch (std::exception &e) {
+        std::string err = e.what();
+        lua_settop(L, top);
+        lua_pushboolean(L, false);
+        lua_pushlstring(L, err.c_str(), err.size());
+        return 2;
     }
-    return 0;
 }
 
 int set_default_config(lua_State *L) {
@@ -543,46 +643,41 @@ int spell_load_dictionary_from_buffer(lua_State *L) {
 int spell_analysis(lua_State *L) {
     int top = lua_gettop(L);
 
-    if (top < 2) {
-        return 0;
-    }
-
-    if (lua_isstring(L, 1) && lua_isstring(L, 2)) {
-        try {
-            std::string filename = lua_tostring(L, 1);
-            std::string text = lua_tostring(L, 2);
-
-            CodeSpellChecker::CustomDictionary tempDict;
-
-            if (top == 3 && lua_istable(L, 3)) {
-                lua_pushnil(L);
-                while (lua_next(L, -2) != 0) {
-                    auto value = luaToString(L, -1);
-                    tempDict.insert(value);
-                    lua_pop(L, 1);
-                }
-            }
+    try {
+        std::shared_ptr<LuaDocument> document;
+        int next = getDocument(L, document);
+        if (next == 0) {
+            return 0;
+        }
 
-            auto spellResult = LuaCodeFormat::GetInstance().SpellCheck(filename, std::move(text), tempDict);
-            if (spellResult.Type == ResultType::Err) {
-                lua_pushboolean(L, false);
-                return 1;
+        CodeSpellChecker::CustomDictionary tempDict;
+        if (top == next && lua_istable(L, next)) {
+            lua_pushnil(L);
+            while (lua_next(L, -2) != 0) {
+                auto value = luaToString(L, -1);
+                tempDict.insert(value);
+                lua_pop(L, 1);
             }
+        }
 
-            auto &diagnostics = spellResult.Data;
-            lua_pushboolean(L, true);
-            PushDiagnosticToLua(L, diagnostics);
-
-            return 2;
-        } catch (std::exception &e) {
-            std::string err = e.what();
-            lua_settop(L, top);
+        auto diagnosticResult = LuaCodeFormat::GetInstance().SpellCheck(*document, tempDict);
+        if (diagnosticResult.Type == ResultType::Err) {
             lua_pushboolean(L, false);
-            lua_pushlstring(L, err.c_str(), err.size());
-            return 2;
+            return 1;
         }
+
+        auto &diagnostics = diagnosticResult.Data;
+        lua_pushboolean(L, true);
+        PushDiagnosticToLua(L, diagnostics);
+
+        return 2;
+    } catch (std::exception &e) {
+        std::string err = e.what();
+        lua_settop(L, top);
+        lua_pushboolean(L, false);
+        lua_pushlstring(L, err.c_str(), err.size());
+        return 2;
     }
-    return 0;
 }
 
 InfoNode CreateFromLua(InfoTree &t, lua_State *L) {
@@ -659,35 +754,31 @@ int update_name_style_config(lua_State *L) {
 int name_style_analysis(lua_State *L) {
     int top = lua_gettop(L);
 
-    if (top < 2) {
-        return 0;
-    }
-
-    if (lua_isstring(L, 1) && lua_isstring(L, 2)) {
-        try {
-            std::string filename = lua_tostring(L, 1);
-            std::string text = lua_tostring(L, 2);
-
-            auto nameStyleResult = LuaCodeFormat::GetInstance().NameStyleCheck(filename, std::move(text));
-            if (nameStyleResult.Type == ResultType::Err) {
-                lua_pushboolean(L, false);
-                return 1;
-            }
-
-            auto &diagnostics = nameStyleResult.Data;
-            lua_pushboolean(L, true);
-            PushDiagnosticToLua(L, diagnostics);
+    try {
+        std::shared_ptr<LuaDocument> document;
+        int next = getDocument(L, document);
+        if (next == 0) {
+            return 0;
+        }
 
-            return 2;
-        } catch (std::exception &e) {
-            std::string err = e.what();
-            lua_settop(L, top);
+        auto diagnosticResult = LuaCodeFormat::GetInstance().NameStyleCheck(*document);
+        if (diagnosticResult.Type == ResultType::Err) {
             lua_pushboolean(L, false);
-            lua_pushlstring(L, err.c_str(), err.size());
-            return 2;
+            return 1;
         }
+
+        auto &diagnostics = diagnosticResult.Data;
+        lua_pushboolean(L, true);
+        PushDiagnosticToLua(L, diagnostics);
+
+        return 2;
+    } catch (std::exception &e) {
+        std::string err = e.what();
+        lua_settop(L, top);
+        lua_pushboolean(L, false);
+        lua_pushlstring(L, err.c_str(), err.size());
+        return 2;
     }
-    return 0;
 }
 
 int spell_suggest(lua_State *L) {
@@ -727,12 +818,190 @@ int spell_suggest(lua_State *L) {
     return 0;
 }
 
+// files 为 { {uri, text}, ... }, 也接受 { uri = ..., text = ... } 的写法
+std::vector<LuaDocument> readBatchDocuments(lua_State *L, int idx) {
+    std::vector<LuaDocument> documents;
+    auto len = luaL_len(L, idx);
+    documents.reserve(static_cast<std::size_t>(len));
+    for (lua_Integer i = 1; i <= len; i++) {
+        lua_geti(L, idx, i);
+        if (!lua_istable(L, -1)) {
+            throw std::runtime_error(util::format("files[{}] is not a table", i));
+        }
+        if (lua_geti(L, -1, 1) == LUA_TNIL) {
+            lua_pop(L, 1);
+            lua_getfield(L, -1, "uri");
+        }
+        if (lua_geti(L, -2, 2) == LUA_TNIL) {
+            lua_pop(L, 1);
+            lua_getfield(L, -2, "text");
+        }
+        if (!lua_isstring(L, -2) || !lua_isstring(L, -1)) {
+            throw std::runtime_error(util::format("files[{}] needs uri and text", i));
+        }
+        std::size_t textLen = 0;
+        auto text = lua_tolstring(L, -1, &textLen);
+        documents.emplace_back(lua_tostring(L, -2), std::string(text, textLen));
+        lua_pop(L, 3);
+    }
+    return documents;
+}
+
+// 在结果表中为第 index 个文件创建结果并留在栈顶
+void pushBatchResult(lua_State *L, int resultsIdx, std::size_t index, LuaDocument &document, bool ok,
+                     const std::string &error) {
+    lua_newtable(L);
+    lua_pushstring(L, "uri");
+    lua_pushlstring(L, document.GetUri().c_str(), document.GetUri().size());
+    lua_rawset(L, -3);
+
+    lua_pushstring(L, "ok");
+    lua_pushboolean(L, ok);
+    lua_rawset(L, -3);
+
+    if (!error.empty()) {
+        lua_pushstring(L, "err");
+        lua_pushlstring(L, error.c_str(), error.size());
+        lua_rawset(L, -3);
+    }
+
+    lua_pushvalue(L, -1);
+    lua_rawseti(L, resultsIdx, static_cast<lua_Integer>(index + 1));
+}
+
+// 回调在结果生成后按输入顺序调用, 回调出错时记录第一个错误, 批处理照常完成
+void callBatchCallback(lua_State *L, int callbackIdx, std::size_t index, std::string &callbackError) {
+    if (callbackIdx == 0 || !callbackError.empty()) {
+        return;
+    }
+    lua_pushvalue(L, callbackIdx);
+    lua_pushinteger(L, static_cast<lua_Integer>(index + 1));
+    lua_pushvalue(L, -3);
+    if (lua_pcall(L, 2, 0, 0) != LUA_OK) {
+        callbackError = luaToString(L, -1);
+        lua_pop(L, 1);
+    }
+}
+
+int format_batch(lua_State *L) {
+    int top = lua_gettop(L);
+
+    if (top < 1 || !lua_istable(L, 1)) {
+        return 0;
+    }
+
+    try {
+        LuaCodeFormat::ConfigMap configMap;
+        if (top >= 2 && lua_istable(L, 2)) {
+            lua_pushvalue(L, 2);
+            lua_pushnil(L);
+            while (lua_next(L, -2) != 0) {
+                auto key = luaToString(L, -2);
+                auto value = luaToString(L, -1);
+
+                if (key != "nil") {
+                    configMap.insert({key, value});
+                }
+
+                lua_pop(L, 1);
+            }
+            lua_pop(L, 1);
+        }
+        int callbackIdx = top >= 3 && lua_isfunction(L, 3) ? 3 : 0;
+
+        auto documents = readBatchDocuments(L, 1);
+        lua_newtable(L);
+        int resultsIdx = lua_gettop(L);
+        std::string callbackError;
+        LuaCodeFormat::GetInstance().FormatBatch(
+                documents, configMap,
+                [&](std::size_t index, Result<std::string> &&result, const std::string &error) {
+                    bool ok = result.Type == ResultType::Ok;
+                    pushBatchResult(L, resultsIdx, index, documents[index], ok, error);
+                    if (ok) {
+                        lua_pushstring(L, "text");
+                        lua_pushlstring(L, result.Data.c_str(), result.Data.size());
+                        lua_rawset(L, -3);
+                    }
+                    callBatchCallback(L, callbackIdx, index, callbackError);
+                    lua_pop(L, 1);
+                });
+
+        if (!callbackError.empty()) {
+            lua_settop(L, top);
+            lua_pushboolean(L, false);
+            lua_pushlstring(L, callbackError.c_str(), callbackError.size());
+            return 2;
+        }
+        lua_pushboolean(L, true);
+        lua_insert(L, -2);
+        return 2;
+    } catch (std::exception &e) {
+        std::string err = e.what();
+        lua_settop(L, top);
+        lua_pushboolean(L, false);
+        lua_pushlstring(L, err.c_str(), err.size());
+        return 2;
+    }
+}
+
+int check_batch(lua_State *L) {
+    int top = lua_gettop(L);
+
+    if (top < 1 || !lua_istable(L, 1)) {
+        return 0;
+    }
+
+    try {
+        int callbackIdx = top >= 2 && lua_isfunction(L, 2) ? 2 : 0;
+
+        auto documents = readBatchDocuments(L, 1);
+        lua_newtable(L);
+        int resultsIdx = lua_gettop(L);
+        std::string callbackError;
+        LuaCodeFormat::GetInstance().CheckBatch(
+                documents,
+                [&](std::size_t index, Result<std::vector<LuaDiagnosticInfo>> &&result, const std::string &error) {
+                    bool ok = result.Type == ResultType::Ok;
+                    pushBatchResult(L, resultsIdx, index, documents[index], ok, error);
+                    if (ok) {
+                        lua_pushstring(L, "diagnostics");
+                        PushDiagnosticToLua(L, result.Data);
+                        lua_rawset(L, -3);
+                    }
+                    callBatchCallback(L, callbackIdx, index, callbackError);
+                    lua_pop(L, 1);
+                });
+
+        if (!callbackError.empty()) {
+            lua_settop(L, top);
+            lua_pushboolean(L, false);
+            lua_pushlstring(L, callbackError.c_str(), callbackError.size());
+            return 2;
+        }
+        lua_pushboolean(L, true);
+        lua_insert(L, -2);
+        return 2;
+    } catch (std::exception &e) {
+        std::string err = e.what();
+        lua_settop(L, top);
+        lua_pushboolean(L, false);
+        lua_pushlstring(L, err.c_str(), err.size());
+        return 2;
+    }
+}
+
 static const luaL_Reg lib[] = {
+        {"open",                              document_open                    },
+        {"update",                            document_update                  },
+        {"close",                             document_close                   },
         {"format",                            format                           },
+        {"format_batch",                      format_batch                     },
         {"range_format",                      range_format                     },
         {"type_format",                       type_format                      },
         {"update_config",                     update_config                    },
         {"diagnose_file",                     diagnose_file                    },
+        {"check_batch",                       check_batch                      },
         {"set_default_config",                set_default_config               },
         {"spell_load_dictionary_from_path",   spell_load_dictionary_from_path  },
         {"spell_load_dictionary_from_buffer", spell_load_dictionary_from_buffer},
@@ -744,7 +1013,21 @@ static const luaL_Reg lib[] = {
         {nullptr,                             nullptr                          }
 };
 
+static const luaL_Reg documentMeta[] = {
+        {"__gc",    document_gc   },
+        {"__close", document_close},
+        {nullptr,   nullptr       }
+};
+
 extern "C" EXPORT int luaopen_code_format(lua_State *L) {
+    if (luaL_newmetatable(L, DocumentMetatable)) {
+        luaL_setfuncs(L, documentMeta, 0);
+        // 对 lua 隐藏元表, 避免手动调用 __gc
+        lua_pushstring(L, DocumentMetatable);
+        lua_setfield(L, -2, "__metatable");
+    }
+    lua_pop(L, 1);
+
     luaL_newlibtable(L, lib);
     luaL_setfuncs(L, lib, 0);
     return 1;
@@ -4,6 +4,52 @@
 #include "Util/StringUtil.h"
 #include "LuaParser/Parse/LuaParser.h"
 #include "CodeFormatCore/RangeFormat/RangeFormatBuilder.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+struct ThreadJoiner {
+    std::vector<std::thread> &Threads;
+
+    ~ThreadJoiner() {
+        for (auto &thread: Threads) {
+            thread.join();
+        }
+    }
+};
+
+// 工作线程按原子计数领取任务, 全部线程结束后才在调用线程按输入顺序交付结果
+// handle 会操作 lua 栈, lua 出错时 longjmp 不能发生在工作线程仍在运行的时候
+template<class T, class Work>
+void RunBatch(std::size_t count, Work &&work, const LuaCodeFormat::BatchHandle<T> &handle) {
+    std::vector<Result<T>> results(count, Result<T>(ResultType::Err));
+    std::vector<std::string> errors(count);
+
+    {
+        auto threadCount = std::min<std::size_t>(std::max<std::size_t>(std::thread::hardware_concurrency(), 1), count);
+        std::atomic<std::size_t> next = 0;
+        std::vector<std::thread> threads;
+        ThreadJoiner joiner{threads};
+        for (std::size_t i = 0; i != threadCount; i++) {
+            threads.emplace_back([&results, &errors, &work, &next, count]() {
+                for (auto index = next++; index < count; index = next++) {
+                    try {
+                        results[index] = work(index);
+                    } catch (std::exception &e) {
+                        errors[index] = e.what();
+                    } catch (...) {
+                        errors[index] = "unknown error";
+                    }
+                }
+            });
+        }
+    }
+
+    for (std::size_t i = 0; i != count; i++) {
+        handle(i, std::move(results[i]), errors[i]);
+    }
+}
+}// namespace
 
 LuaCodeFormat &LuaCodeFormat::GetInstance() {
     static LuaCodeFormat instance;
@@ -67,168 +113,130 @@ void LuaCodeFormat::LoadSpellDictionaryFromBuffer(const std::string &buffer) {
     _spellChecker.LoadDictionaryFromBuffer(buffer);
 }
 
-Result<std::string> LuaCodeFormat::Reformat(const std::string &uri, std::string &&text, ConfigMap &configMap) {
-    auto file = std::make_shared<LuaSource>(std::move(text));
-    LuaLexer luaLexer(file);
-    if (_supportNonStandardSymbol){
-        luaLexer.SupportNonStandardSymbol();
-    }
-    luaLexer.Parse();
+Result<std::string> LuaCodeFormat::Reformat(LuaDocument &document, ConfigMap &configMap) {
+    LuaStyle style = GetStyle(document.GetUri());
+    CalculateTempStyle(style, configMap);
 
-    LuaParser p(file, std::move(luaLexer.GetTokens()));
-    p.Parse();
+    return FormatDocument(document, style);
+}
 
-    if (p.HasError()) {
+Result<std::string> LuaCodeFormat::FormatDocument(LuaDocument &document, LuaStyle &style) {
+    auto t = document.GetSyntaxTree(_supportNonStandardSymbol);
+    if (!t) {
         return ResultType::Err;
     }
 
-    LuaSyntaxTree t;
-    t.BuildTree(p);
-
-    LuaStyle style = GetStyle(uri);
-    CalculateTempStyle(style, configMap);
-
     FormatBuilder f(style);
 
-    return f.GetFormatResult(t);
+    return f.GetFormatResult(*t);
 }
 
-Result<std::string> LuaCodeFormat::RangeFormat(const std::string &uri, FormatRange &range,
-                                               std::string &&text,
-                                               ConfigMap &configMap) {
-    auto file = std::make_shared<LuaSource>(std::move(text));
-    LuaLexer luaLexer(file);
-    if (_supportNonStandardSymbol){
-        luaLexer.SupportNonStandardSymbol();
-    }
-    luaLexer.Parse();
-
-    LuaParser p(file, std::move(luaLexer.GetTokens()));
-    p.Parse();
-
-    if (p.HasError()) {
+Result<std::string> LuaCodeFormat::RangeFormat(LuaDocument &document, FormatRange &range, ConfigMap &configMap) {
+    auto t = document.GetSyntaxTree(_supportNonStandardSymbol);
+    if (!t) {
         return ResultType::Err;
     }
 
-    LuaSyntaxTree t;
-    t.BuildTree(p);
-
-    LuaStyle style = GetStyle(uri);
+    LuaStyle style = GetStyle(document.GetUri());
     CalculateTempStyle(style, configMap);
 
     RangeFormatBuilder f(style, range);
 
-    auto formattedText = f.GetFormatResult(t);
+    auto formattedText = f.GetFormatResult(*t);
     range = f.GetReplaceRange();
     return formattedText;
 }
 
 Result<std::vector<LuaTypeFormat::Result>>
-LuaCodeFormat::TypeFormat(const std::string &uri, std::size_t line, std::size_t character, std::string &&text,
+LuaCodeFormat::TypeFormat(LuaDocument &document, std::size_t line, std::size_t character,
                           ConfigMap &configMap, ConfigMap &stringTypeOptions) {
-    auto file = std::make_shared<LuaSource>(std::move(text));
-    LuaLexer luaLexer(file);
-    if (_supportNonStandardSymbol){
-        luaLexer.SupportNonStandardSymbol();
-    }
-    luaLexer.Parse();
-
-    LuaParser p(file, std::move(luaLexer.GetTokens()));
-    p.Parse();
-
-    if (p.HasError()) {
+    auto t = document.GetSyntaxTree(_supportNonStandardSymbol);
+    if (!t) {
         return ResultType::Err;
     }
 
-    LuaSyntaxTree t;
-    t.BuildTree(p);
-
-    LuaStyle style = GetStyle(uri);
+    LuaStyle style = GetStyle(document.GetUri());
     CalculateTempStyle(style, configMap);
 
     LuaTypeFormatFeatures typeFormatOptions = LuaTypeFormatFeatures::From(stringTypeOptions);
 
     LuaTypeFormat tf(typeFormatOptions);
-    tf.Analyze("\n", line, character, t, style);
+    tf.Analyze("\n", line, character, *t, style);
     return tf.GetResult();
 }
 
-Result<std::vector<LuaDiagnosticInfo>> LuaCodeFormat::Diagnostic(const std::string &uri, std::string &&text) {
-    auto file = std::make_shared<LuaSource>(std::move(text));
-    LuaLexer luaLexer(file);
-    if (_supportNonStandardSymbol){
-        luaLexer.SupportNonStandardSymbol();
-    }
-    luaLexer.Parse();
+Result<std::vector<LuaDiagnosticInfo>> LuaCodeFormat::Diagnostic(LuaDocument &document) {
+    LuaStyle style = GetStyle(document.GetUri());
 
-    LuaParser p(file, std::move(luaLexer.GetTokens()));
-    p.Parse();
+    return CheckDocument(document, style);
+}
 
-    if (p.HasError()) {
+Result<std::vector<LuaDiagnosticInfo>> LuaCodeFormat::CheckDocument(LuaDocument &document, LuaStyle &style) {
+    auto t = document.GetSyntaxTree(_supportNonStandardSymbol);
+    if (!t) {
         return ResultType::Err;
     }
 
-    LuaSyntaxTree t;
-    t.BuildTree(p);
-
-    LuaStyle style = GetStyle(uri);
-
     DiagnosticBuilder diagnosticBuilder(style, _diagnosticStyle);
-    diagnosticBuilder.CodeStyleCheck(t);
-    return MakeDiagnosticInfo(diagnosticBuilder.GetDiagnosticResults(t), file);
+    diagnosticBuilder.CodeStyleCheck(*t);
+    return MakeDiagnosticInfo(diagnosticBuilder.GetDiagnosticResults(*t), document.GetSource());
 }
 
-Result<std::vector<LuaDiagnosticInfo>> LuaCodeFormat::SpellCheck(const std::string &uri, std::string &&text,
+Result<std::vector<LuaDiagnosticInfo>> LuaCodeFormat::SpellCheck(LuaDocument &document,
                                                                  const CodeSpellChecker::CustomDictionary &tempDict) {
-    auto file = LuaSource::From(std::move(text));
-    LuaLexer luaLexer(file);
-    if (_supportNonStandardSymbol){
-        luaLexer.SupportNonStandardSymbol();
-    }
-    luaLexer.Parse();
-
-    LuaParser p(file, std::move(luaLexer.GetTokens()));
-    p.Parse();
-
-    if (p.HasError()) {
+    auto t = document.GetSyntaxTree(_supportNonStandardSymbol);
+    if (!t) {
         return ResultType::Err;
     }
 
-    LuaSyntaxTree t;
-    t.BuildTree(p);
-
-    LuaStyle style = GetStyle(uri);
+    LuaStyle style = GetStyle(document.GetUri());
 
     DiagnosticBuilder diagnosticBuilder(style, _diagnosticStyle);
     _spellChecker.SetCustomDictionary(tempDict);
-    diagnosticBuilder.SpellCheck(t, _spellChecker);
-    return MakeDiagnosticInfo(diagnosticBuilder.GetDiagnosticResults(t), file);
+    diagnosticBuilder.SpellCheck(*t, _spellChecker);
+    return MakeDiagnosticInfo(diagnosticBuilder.GetDiagnosticResults(*t), document.GetSource());
 }
 
-Result<std::vector<LuaDiagnosticInfo>> LuaCodeFormat::NameStyleCheck(const std::string &uri, std::string &&text) {
-    auto file = LuaSource::From(std::move(text));
-    LuaLexer luaLexer(file);
-    if (_supportNonStandardSymbol){
-        luaLexer.SupportNonStandardSymbol();
+Result<std::vector<LuaDiagnosticInfo>> LuaCodeFormat::NameStyleCheck(LuaDocument &document) {
+    auto t = document.GetSyntaxTree(_supportNonStandardSymbol);
+    if (!t) {
+        return ResultType::Err;
     }
-    luaLexer.Parse();
 
-    LuaParser p(file, std::move(luaLexer.GetTokens()));
-    p.Parse();
+    LuaStyle style = GetStyle(document.GetUri());
 
-    if (p.HasError()) {
-        return ResultType::Err;
-    }
+    DiagnosticBuilder diagnosticBuilder(style, _diagnosticStyle);
+
+    diagnosticBuilder.NameStyleCheck(*t);
+    return MakeDiagnosticInfo(diagnosticBuilder.GetDiagnosticResults(*t), document.GetSource());
+}
 
-    LuaSyntaxTree t;
-    t.BuildTree(p);
+void LuaCodeFormat::FormatBatch(std::vector<LuaDocument> &documents, ConfigMap &configMap,
+                                const BatchHandle<std::string> &handle) {
+    // 编辑器配置按路径缓存样式, 不能在工作线程中查询
+    std::vector<LuaStyle> styles;
+    styles.reserve(documents.size());
+    for (auto &document: documents) {
+        auto &style = styles.emplace_back(GetStyle(document.GetUri()));
+        CalculateTempStyle(style, configMap);
+    }
 
-    LuaStyle style = GetStyle(uri);
+    RunBatch<std::string>(documents.size(), [this, &documents, &styles](std::size_t i) {
+        return FormatDocument(documents[i], styles[i]);
+    }, handle);
+}
 
-    DiagnosticBuilder diagnosticBuilder(style, _diagnosticStyle);
+void LuaCodeFormat::CheckBatch(std::vector<LuaDocument> &documents,
+                               const BatchHandle<std::vector<LuaDiagnosticInfo>> &handle) {
+    std::vector<LuaStyle> styles;
+    styles.reserve(documents.size());
+    for (auto &document: documents) {
+        styles.emplace_back(GetStyle(document.GetUri()));
+    }
 
-    diagnosticBuilder.NameStyleCheck(t);
-    return MakeDiagnosticInfo(diagnosticBuilder.GetDiagnosticResults(t), file);
+    RunBatch<std::vector<LuaDiagnosticInfo>>(documents.size(), [this, &documents, &styles](std::size_t i) {
+        return CheckDocument(documents[i], styles[i]);
+    }, handle);
 }
 
 std::vector<SuggestItem> LuaCodeFormat::SpellCorrect(const std::string &word) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -10,6 +11,7 @@
 #include "CodeFormatCore/Diagnostic/Spell/CodeSpellChecker.h"
 #include "CodeFormatCore/TypeFormat/LuaTypeFormat.h"
 #include "CodeFormatCore/Diagnostic/DiagnosticBuilder.h"
+#include "LuaDocument.h"
 #include "Types.h"
 
 
@@ -17,6 +19,10 @@ class LuaCodeFormat {
 public:
     using ConfigMap = std::map<std::string, std::string, std::less<>>;
 
+    // 批量处理全部完成后在调用线程上按输入顺序逐个交付结果, 处理抛出异常时 error 为异常信息
+    template<class T>
+    using BatchHandle = std::function<void(std::size_t index, Result<T> &&result, const std::string &error)>;
+
     static LuaCodeFormat &GetInstance();
 
     LuaCodeFormat();
@@ -35,25 +41,36 @@ public:
 
     void LoadSpellDictionaryFromBuffer(const std::string &buffer);
 
-    Result<std::string> Reformat(const std::string &uri, std::string &&text, ConfigMap &configMap);
+    Result<std::string> Reformat(LuaDocument &document, ConfigMap &configMap);
 
-    Result<std::string> RangeFormat(const std::string &uri, FormatRange &range, std::string &&text, ConfigMap &configMap);
+    Result<std::string> RangeFormat(LuaDocument &document, FormatRange &range, ConfigMap &configMap);
 
     Result<std::vector<LuaTypeFormat::Result>>
-    TypeFormat(const std::string &uri, std::size_t line, std::size_t character, std::string &&text,
+    TypeFormat(LuaDocument &document, std::size_t line, std::size_t character,
                ConfigMap &configMap, ConfigMap &stringTypeOptions);
 
-    Result<std::vector<LuaDiagnosticInfo>> Diagnostic(const std::string &uri, std::string &&text);
+    Result<std::vector<LuaDiagnosticInfo>> Diagnostic(LuaDocument &document);
+
+    Result<std::vector<LuaDiagnosticInfo>> SpellCheck(LuaDocument &document,
+                                                      const CodeSpellChecker::CustomDictionary &tempDict);
+
+    Result<std::vector<LuaDiagnosticInfo>> NameStyleCheck(LuaDocument &document);
 
-    Result<std::vector<LuaDiagnosticInfo>> SpellCheck(const std::string &uri, std::string &&text,
-                                          const CodeSpellChecker::CustomDictionary &tempDict);
+    // 样式在调用线程上确定, 解析和格式化在线程池中进行
+    void FormatBatch(std::vector<LuaDocument> &documents, ConfigMap &configMap,
+                     const BatchHandle<std::string> &handle);
 
-    Result<std::vector<LuaDiagnosticInfo>> NameStyleCheck(const std::string &uri, std::string &&text);
+    void CheckBatch(std::vector<LuaDocument> &documents,
+                    const BatchHandle<std::vector<LuaDiagnosticInfo>> &handle);
 
     std::vector<SuggestItem> SpellCorrect(const std::string &word);
 
     LuaStyle &GetStyle(const std::string &uri);
 private:
+    Result<std::string> FormatDocument(LuaDocument &document, LuaStyle &style);
+
+    Result<std::vector<LuaDiagnosticInfo>> CheckDocument(LuaDocument &document, LuaStyle &style);
+
     std::vector<LuaDiagnosticInfo> MakeDiagnosticInfo(const std::vector<LuaDiagnostic>& diagnostics,
                                                       std::shared_ptr<LuaSource> file);
 
@@ -0,0 +1,59 @@
+#include "LuaDocument.h"
+#include "LuaParser/Lexer/LuaLexer.h"
+#include "LuaParser/Parse/LuaParser.h"
+
+LuaDocument::LuaDocument(std::string_view uri, std::string &&text)
+    : _uri(uri),
+      _source(LuaSource::From(std::move(text))),
+      _parsed(false),
+      _nonStandardSymbol(false) {
+}
+
+void LuaDocument::Update(std::string &&text) {
+    if (_source->GetSource() == text) {
+        return;
+    }
+
+    _source = LuaSource::From(std::move(text));
+    _tree.reset();
+    _parsed = false;
+}
+
+const std::string &LuaDocument::GetUri() const {
+    return _uri;
+}
+
+std::shared_ptr<LuaSource> LuaDocument::GetSource() const {
+    return _source;
+}
+
+const LuaSyntaxTree *LuaDocument::GetSyntaxTree(bool nonStandardSymbol) {
+    if (_parsed && _nonStandardSymbol == nonStandardSymbol) {
+        return _tree.get();
+    }
+
+    // 行表是词法分析时填充的, 重新解析需要新的 LuaSource
+    if (_parsed) {
+        _source = LuaSource::From(std::string(_source->GetSource()));
+    }
+    _parsed = true;
+    _nonStandardSymbol = nonStandardSymbol;
+    _tree.reset();
+
+    LuaLexer luaLexer(_source);
+    if (nonStandardSymbol) {
+        luaLexer.SupportNonStandardSymbol();
+    }
+    luaLexer.Parse();
+
+    LuaParser p(_source, std::move(luaLexer.GetTokens()));
+    p.Parse();
+
+    if (p.HasError()) {
+        return nullptr;
+    }
+
+    _tree = std::make_unique<LuaSyntaxTree>();
+    _tree->BuildTree(p);
+    return _tree.get();
+}
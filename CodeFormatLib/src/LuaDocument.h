@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "LuaParser/Ast/LuaSyntaxTree.h"
+#include "LuaParser/File/LuaSource.h"
+
+/*
+ * 编辑器打开的一个缓冲区
+ * 语法树和行表在第一次使用时生成, 之后格式化, 诊断和拼写检查都复用, 直到文本发生变化
+ */
+class LuaDocument {
+public:
+    LuaDocument(std::string_view uri, std::string &&text);
+
+    // 文本没有变化时保留已有的语法树
+    void Update(std::string &&text);
+
+    const std::string &GetUri() const;
+
+    std::shared_ptr<LuaSource> GetSource() const;
+
+    // 解析出错时返回 nullptr
+    const LuaSyntaxTree *GetSyntaxTree(bool nonStandardSymbol);
+
+private:
+    std::string _uri;
+    std::shared_ptr<LuaSource> _source;
+    std::unique_ptr<LuaSyntaxTree> _tree;
+    bool _parsed;
+    bool _nonStandardSymbol;
+};
@@ -1,7 +1,7 @@
 #include "FileDB.h"
 
 FileDB::FileDB()
-        : SharedDBBase<std::size_t, std::string>(), _fileIdCounter(1) {
+        : SharedDBBase<std::size_t, std::string>(), _fileIdCounter(1), _versionCounter(0) {
 
 }
 
@@ -12,8 +12,22 @@ std::size_t FileDB::AllocFileId() {
 void FileDB::ApplyFileUpdate(std::size_t fileId, std::string &&text) {
     auto ptr = std::make_shared<std::string>(std::move(text));
     Input(fileId, std::move(ptr));
+    _versions[fileId] = ++_versionCounter;
 }
 
 void FileDB::ApplyFileUpdate(std::vector<lsp::TextDocumentContentChangeEvent> &changeEvent) {
 
 }
+
+void FileDB::Delete(const std::size_t &fileId) {
+    SharedDBBase<std::size_t, std::string>::Delete(fileId);
+    _versions.erase(fileId);
+}
+
+std::size_t FileDB::GetVersion(std::size_t fileId) const {
+    auto it = _versions.find(fileId);
+    if (it != _versions.end()) {
+        return it->second;
+    }
+    return 0;
+}
@@ -2,6 +2,7 @@
 
 #include "DBBase.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "LSP/LSP.h"
 
@@ -15,6 +16,13 @@ public:
 
     void ApplyFileUpdate(std::vector<lsp::TextDocumentContentChangeEvent>& changeEvent);
 
+    void Delete(const std::size_t &fileId) override;
+
+    // every update gets a new version, versions are never reused, 0 means the file does not exist
+    std::size_t GetVersion(std::size_t fileId) const;
+
 private:
     std::size_t _fileIdCounter;
+    std::size_t _versionCounter;
+    std::unordered_map<std::size_t, std::size_t> _versions;
 };
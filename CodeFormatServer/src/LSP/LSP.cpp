@@ -647,6 +647,12 @@ void lsp::DocumentDiagnosticParams::Deserialize(nlohmann::json json)
 	}
 }
 
+void lsp::DocumentRangeDiagnosticParams::Deserialize(nlohmann::json json)
+{
+	textDocument.Deserialize(json["textDocument"]);
+	range.Deserialize(json["range"]);
+}
+
 nlohmann::json lsp::DocumentDiagnosticReport::Serialize()
 {
 	auto object = nlohmann::json::object();
@@ -661,6 +667,11 @@ nlohmann::json lsp::DocumentDiagnosticReport::Serialize()
 		object["resultId"] = resultId;
 	}
 
+	if(truncated)
+	{
+		object["truncated"] = true;
+	}
+
 	return object;
 }
 
@@ -612,6 +612,16 @@ public:
 	void Deserialize(nlohmann::json json) override;
 };
 
+// not part of the protocol, diagnostic only for the visible range of a document
+class DocumentRangeDiagnosticParams : public Serializable
+{
+public:
+	TextDocument textDocument;
+	Range range;
+
+	void Deserialize(nlohmann::json json) override;
+};
+
 namespace DocumentDiagnosticReportKind {
 static constexpr std::string_view Full = "full";
 static constexpr std::string_view Unchanged = "unchanged";
@@ -627,6 +637,9 @@ public:
 
 	std::vector<Diagnostic> items;
 
+	// not part of the protocol, true if the items are cut by the diagnostic limit
+	bool truncated = false;
+
 	nlohmann::json Serialize() override;
 };
 
@@ -42,6 +42,7 @@ bool LSPHandle::Initialize() {
     JsonProtocol("workspace/didChangeConfiguration", &LSPHandle::OnWorkspaceDidChangeConfiguration);
     JsonProtocol("textDocument/diagnostic", &LSPHandle::OnTextDocumentDiagnostic);
     JsonProtocol("workspace/diagnostic", &LSPHandle::OnWorkspaceDiagnostic);
+    JsonProtocol("diagnostic/range", &LSPHandle::OnRangeDiagnostic);
     return true;
 }
 
@@ -175,6 +176,10 @@ std::shared_ptr<lsp::Serializable> LSPHandle::OnFormatting(
 
 std::shared_ptr<lsp::Serializable> LSPHandle::OnClose(
         std::shared_ptr<lsp::DidCloseTextDocumentParams> params) {
+    auto opFileId = _server->GetVFS().GetUriDB().Query(params->textDocument.uri);
+    if (opFileId.has_value()) {
+        _server->GetService<DiagnosticService>()->ClearCache(opFileId.value());
+    }
     _server->GetVFS().ClearFile(params->textDocument.uri);
     return nullptr;
 }
@@ -314,6 +319,14 @@ std::shared_ptr<lsp::DocumentDiagnosticReport> LSPHandle::OnTextDocumentDiagnost
         return report;
     }
 
+    auto cache = _server->GetService<DiagnosticService>()->GetCache(opFileId.value());
+    if (cache) {
+        report->resultId = std::to_string(opFileId.value());
+        report->truncated = cache->Truncated;
+        report->items = cache->Items;
+        return report;
+    }
+
     auto opSyntaxTree = vfs.GetVirtualFile(params->textDocument.uri).GetSyntaxTree(vfs);
     if (!opSyntaxTree.has_value()) {
         return report;
@@ -328,7 +341,7 @@ std::shared_ptr<lsp::DocumentDiagnosticReport> LSPHandle::OnTextDocumentDiagnost
     LuaStyle &luaStyle = _server->GetService<ConfigService>()->GetLuaStyle(params->textDocument.uri);
 
     auto diagnostics = _server->GetService<DiagnosticService>()->Diagnostic(
-            opFileId.value(), syntaxTree, luaStyle
+            opFileId.value(), syntaxTree, luaStyle, report->truncated
     );
     report->resultId = std::to_string(opFileId.value());
 
@@ -342,6 +355,71 @@ std::shared_ptr<lsp::WorkspaceDiagnosticReport> LSPHandle::OnWorkspaceDiagnostic
     return nullptr;
 }
 
+std::shared_ptr<lsp::DocumentDiagnosticReport> LSPHandle::OnRangeDiagnostic(
+        std::shared_ptr<lsp::DocumentRangeDiagnosticParams> params) {
+    auto report = std::make_shared<lsp::DocumentDiagnosticReport>();
+    report->kind = lsp::DocumentDiagnosticReportKind::Full;
+
+    auto &vfs = _server->GetVFS();
+    auto opFileId = vfs.GetUriDB().Query(params->textDocument.uri);
+    if (!opFileId.has_value()) {
+        return report;
+    }
+    auto fileId = opFileId.value();
+    auto diagnosticService = _server->GetService<DiagnosticService>();
+
+    auto cache = diagnosticService->GetCache(fileId);
+    if (cache) {
+        report->resultId = std::to_string(fileId);
+        report->truncated = cache->Truncated;
+        for (auto &diagnostic: cache->Items) {
+            if (diagnostic.range.start.line <= params->range.end.line
+                && diagnostic.range.end.line >= params->range.start.line) {
+                report->items.push_back(diagnostic);
+            }
+        }
+        return report;
+    }
+
+    auto opSyntaxTree = vfs.GetVirtualFile(fileId).GetSyntaxTree(vfs);
+    if (!opSyntaxTree.has_value()) {
+        return report;
+    }
+
+    auto &syntaxTree = opSyntaxTree.value();
+    if (syntaxTree.HasError()) {
+        return report;
+    }
+
+    LuaStyle &luaStyle = _server->GetService<ConfigService>()->GetLuaStyle(params->textDocument.uri);
+    report->items = diagnosticService->RangeDiagnostic(
+            fileId, syntaxTree, luaStyle, params->range, report->truncated
+    );
+    report->resultId = std::to_string(fileId);
+
+    // 可见区域先返回, 整个文件的诊断在之后的空闲时间完成, 完成后通知客户端重新拉取
+    asio::post(_server->GetIOContext(), [this, fileId, uri = params->textDocument.uri]() {
+        auto &vfs = _server->GetVFS();
+        if (vfs.GetFileDB().GetVersion(fileId) == 0) {
+            return;
+        }
+        auto diagnosticService = _server->GetService<DiagnosticService>();
+        if (diagnosticService->GetCache(fileId)) {
+            return;
+        }
+        auto opSyntaxTree = vfs.GetVirtualFile(fileId).GetSyntaxTree(vfs);
+        if (!opSyntaxTree.has_value() || opSyntaxTree.value().HasError()) {
+            return;
+        }
+        bool truncated = false;
+        LuaStyle &luaStyle = _server->GetService<ConfigService>()->GetLuaStyle(uri);
+        diagnosticService->Diagnostic(fileId, opSyntaxTree.value(), luaStyle, truncated);
+        _server->SendRequest("workspace/diagnostic/refresh", nullptr);
+    });
+    return report;
+}
+
 void LSPHandle::RefreshDiagnostic() {
+    _server->GetService<DiagnosticService>()->ClearCache();
     _server->SendRequest("workspace/diagnostic/refresh", nullptr);
 }
\ No newline at end of file
@@ -72,6 +72,8 @@ private:
 
 	std::shared_ptr<lsp::WorkspaceDiagnosticReport> OnWorkspaceDiagnostic(std::shared_ptr<lsp::WorkspaceDiagnosticParams> param);
 
+	std::shared_ptr<lsp::DocumentDiagnosticReport> OnRangeDiagnostic(std::shared_ptr<lsp::DocumentRangeDiagnosticParams> param);
+
 	std::map<std::string, MessageHandle, std::less<>> _handles;
 
     LanguageServer* _server;
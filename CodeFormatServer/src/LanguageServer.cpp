@@ -84,6 +84,11 @@ int LanguageServer::Run() {
     if (_session) {
         int ret = _session->Run(*this);
         _session = nullptr;
+        for (auto &service: _services) {
+            if (service) {
+                service->Shutdown();
+            }
+        }
         return ret;
     }
     return 1;
@@ -11,6 +11,11 @@ ConfigService::ConfigService(LanguageServer *owner)
 }
 
 LuaStyle &ConfigService::GetLuaStyle(std::string_view fileUri) {
+    auto it = _styleCache.find(fileUri);
+    if (it != _styleCache.end()) {
+        return *it->second;
+    }
+
     std::shared_ptr<LuaEditorConfig> editorConfig = nullptr;
     std::size_t matchProcess = 0;
     for (auto &config: _styleConfigs) {
@@ -22,14 +27,17 @@ LuaStyle &ConfigService::GetLuaStyle(std::string_view fileUri) {
         }
     }
 
+    LuaStyle *style = &_defaultStyle;
     if (editorConfig) {
         auto filePath = url::UrlToFilePath(fileUri);
-        return editorConfig->Generate(filePath);
+        style = &editorConfig->Generate(filePath);
     }
-    return _defaultStyle;
+    _styleCache.insert({std::string(fileUri), style});
+    return *style;
 }
 
 void ConfigService::LoadEditorconfig(std::string_view workspace, std::string_view filePath) {
+    _styleCache.clear();
     std::string path(filePath);
     for (auto &config: _styleConfigs) {
         if (config.Workspace == workspace) {
@@ -67,6 +75,7 @@ void ConfigService::LoadLanguageTranslator(std::string_view filePath) {
 }
 
 void ConfigService::RemoveEditorconfig(std::string_view workspace) {
+    _styleCache.clear();
     for (auto it = _styleConfigs.begin(); it != _styleConfigs.end(); it++) {
         if (it->Workspace == workspace) {
             _styleConfigs.erase(it);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <vector>
 #include "LSP/LSP.h"
 #include "Service.h"
@@ -35,6 +36,8 @@ public:
 
 private:
     std::vector<LuaConfig> _styleConfigs;
+    // uri => style, editorconfig 变化时清空
+    std::map<std::string, LuaStyle *, std::less<>> _styleCache;
     LuaStyle _defaultStyle;
     LuaDiagnosticStyle _diagnosticStyle;
 };
\ No newline at end of file
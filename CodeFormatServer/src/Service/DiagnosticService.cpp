@@ -3,6 +3,9 @@
 #include "CodeFormatCore/Diagnostic/DiagnosticBuilder.h"
 #include "CodeActionService.h"
 #include "ConfigService.h"
+#include "Util/format.h"
+#include <iostream>
+#include <thread>
 
 DiagnosticService::DiagnosticService(LanguageServer *owner)
         : Service(owner),
@@ -10,18 +13,71 @@ DiagnosticService::DiagnosticService(LanguageServer *owner)
 
 }
 
+void DiagnosticService::Shutdown() {
+    // stdout 用于通信, 统计信息输出到 stderr
+    auto statistics = _spellChecker->GetCacheStatistics();
+    if (statistics.Hits + statistics.Misses == 0) {
+        return;
+    }
+    std::cerr << util::format("spell cache: {} hits, {} misses, {} entries, hit rate {}%",
+                              statistics.Hits, statistics.Misses, statistics.Size,
+                              static_cast<int>(statistics.HitRate() * 100))
+              << std::endl;
+}
+
 std::vector<lsp::Diagnostic>
 DiagnosticService::Diagnostic(std::size_t fileId,
-                              const LuaSyntaxTree &luaSyntaxTree, LuaStyle &luaStyle) {
+                              const LuaSyntaxTree &luaSyntaxTree, LuaStyle &luaStyle, bool &truncated) {
     LuaDiagnosticStyle& diagnosticStyle = _owner->GetService<ConfigService>()->GetDiagnosticStyle();
 
     DiagnosticBuilder d(luaStyle, diagnosticStyle);
+    d.SetParallelCheck(std::thread::hardware_concurrency() > 1);
+
+    d.Check(luaSyntaxTree, _spellChecker.get());
+
+    auto diagnostics = MakeDiagnostics(fileId, d, luaSyntaxTree, truncated);
+    auto &cache = _diagnosticCache[fileId];
+    cache.Version = _owner->GetVFS().GetFileDB().GetVersion(fileId);
+    cache.Truncated = truncated;
+    cache.Items = diagnostics;
+    return diagnostics;
+}
 
-    d.CodeStyleCheck(luaSyntaxTree);
-    d.SpellCheck(luaSyntaxTree, *_spellChecker);
-    d.NameStyleCheck(luaSyntaxTree);
+std::vector<lsp::Diagnostic>
+DiagnosticService::RangeDiagnostic(std::size_t fileId, const LuaSyntaxTree &luaSyntaxTree, LuaStyle &luaStyle,
+                                   lsp::Range range, bool &truncated) {
+    LuaDiagnosticStyle &diagnosticStyle = _owner->GetService<ConfigService>()->GetDiagnosticStyle();
+
+    DiagnosticBuilder d(luaStyle, diagnosticStyle);
+    d.SetDiagnosticRange(luaSyntaxTree, range.start.line, range.end.line);
+
+    d.Check(luaSyntaxTree, _spellChecker.get());
+
+    return MakeDiagnostics(fileId, d, luaSyntaxTree, truncated);
+}
 
+const DiagnosticService::DiagnosticCache *DiagnosticService::GetCache(std::size_t fileId) {
+    auto it = _diagnosticCache.find(fileId);
+    if (it != _diagnosticCache.end() && it->second.Version != 0
+        && it->second.Version == _owner->GetVFS().GetFileDB().GetVersion(fileId)) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+void DiagnosticService::ClearCache() {
+    _diagnosticCache.clear();
+}
+
+void DiagnosticService::ClearCache(std::size_t fileId) {
+    _diagnosticCache.erase(fileId);
+}
+
+std::vector<lsp::Diagnostic>
+DiagnosticService::MakeDiagnostics(std::size_t fileId, DiagnosticBuilder &d, const LuaSyntaxTree &luaSyntaxTree,
+                                   bool &truncated) {
     auto results = d.GetDiagnosticResults(luaSyntaxTree);
+    truncated = d.IsTruncated();
     std::vector<lsp::Diagnostic> diagnostics;
     auto &vfs = _owner->GetVFS();
     auto vFile = vfs.GetVirtualFile(fileId);
@@ -82,6 +138,14 @@ DiagnosticService::Diagnostic(std::size_t fileId,
         }
 
     }
+
+    if (truncated) {
+        auto &diag = diagnostics.emplace_back();
+        diag.message = util::format("Too many diagnostics, only {} of them are reported", results.size());
+        diag.range = lsp::Range(lsp::Position(0, 0), lsp::Position(0, 0));
+        diag.source = "EmmyLua";
+        diag.severity = lsp::DiagnosticSeverity::Information;
+    }
     return diagnostics;
 }
 
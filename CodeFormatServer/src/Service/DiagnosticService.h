@@ -7,6 +7,8 @@
 #include "LSP/LSP.h"
 #include "CodeFormatCore/Diagnostic/Spell/CodeSpellChecker.h"
 #include "CodeFormatCore/Diagnostic/NameStyle/NameStyleChecker.h"
+#include "CodeFormatCore/Diagnostic/DiagnosticBuilder.h"
+#include <unordered_map>
 
 class DiagnosticService : public Service {
 public:
@@ -14,13 +16,37 @@ public:
 
     explicit DiagnosticService(LanguageServer *owner);
 
+    void Shutdown() override;
+
+    struct DiagnosticCache {
+        // FileDB version of the text that was diagnosed
+        std::size_t Version = 0;
+        bool Truncated = false;
+        std::vector<lsp::Diagnostic> Items;
+    };
+
     std::vector<lsp::Diagnostic>
     Diagnostic(std::size_t fileId,
-               const LuaSyntaxTree &luaSyntaxTree, LuaStyle &luaStyle);
+               const LuaSyntaxTree &luaSyntaxTree, LuaStyle &luaStyle, bool &truncated);
+
+    std::vector<lsp::Diagnostic>
+    RangeDiagnostic(std::size_t fileId,
+                    const LuaSyntaxTree &luaSyntaxTree, LuaStyle &luaStyle, lsp::Range range, bool &truncated);
+
+    // the result of the last whole file diagnostic, if the text is not changed since then
+    const DiagnosticCache *GetCache(std::size_t fileId);
+
+    void ClearCache();
+
+    void ClearCache(std::size_t fileId);
 
     std::shared_ptr<CodeSpellChecker> GetSpellChecker();
 
 private:
+    std::vector<lsp::Diagnostic>
+    MakeDiagnostics(std::size_t fileId, DiagnosticBuilder &d, const LuaSyntaxTree &luaSyntaxTree, bool &truncated);
+
     std::shared_ptr<CodeSpellChecker> _spellChecker;
+    std::unordered_map<std::size_t, DiagnosticCache> _diagnosticCache;
 };
 
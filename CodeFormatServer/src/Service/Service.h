@@ -18,6 +18,9 @@ public:
 
 	virtual void Start() {};
 
+	// 会话结束后调用
+	virtual void Shutdown() {};
+
 protected:
 	LanguageServer* _owner;
 };
@@ -91,6 +91,8 @@ public:
 
     std::size_t GetFirstLineWidth(const LuaSyntaxTree &t) const;
 
+    bool ContainsComment(const LuaSyntaxTree &t) const;
+
     std::size_t CountTokenChild(LuaTokenKind kind, const LuaSyntaxTree &t);
 
     std::size_t CountNodeChild(LuaSyntaxNodeKind kind, const LuaSyntaxTree &t);
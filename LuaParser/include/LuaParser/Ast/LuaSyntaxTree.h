@@ -23,6 +23,18 @@ public:
 
     TextRange GetTokenRange(std::size_t index) const;
 
+    std::size_t GetStartLine(std::size_t index) const;
+
+    std::size_t GetStartCol(std::size_t index) const;
+
+    std::size_t GetEndLine(std::size_t index) const;
+
+    std::size_t GetEndCol(std::size_t index) const;
+
+    std::size_t GetFirstLineWidth(std::size_t index) const;
+
+    bool ContainsComment(std::size_t index) const;
+
     std::size_t GetNextSibling(std::size_t index) const;
 
     std::size_t GetPrevSibling(std::size_t index) const;
@@ -81,9 +93,15 @@ private:
 
     void BuildToken(LuaToken &token);
 
+    void BuildTokenPosition();
+
+    void BuildNodeMetrics();
+
     std::shared_ptr<LuaSource> _source;
     std::vector<NodeOrToken> _nodeOrTokens;
     std::vector<IncrementalToken> _tokens;
+    std::vector<TokenPosition> _tokenPositions;
+    std::vector<NodeMetrics> _nodeMetrics;
     std::vector<LuaSyntaxNode> _syntaxNodes;
     std::stack<std::size_t> _nodePosStack;
     std::size_t _tokenIndex;
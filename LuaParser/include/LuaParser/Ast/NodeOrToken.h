@@ -23,6 +23,25 @@ struct IncrementalToken {
     std::size_t NodeIndex;
 };
 
+// token 的行列, 构建语法树时一次计算
+struct TokenPosition {
+    std::size_t StartLine = 0;
+    std::size_t StartCol = 0;
+    std::size_t EndLine = 0;
+    std::size_t EndCol = 0;
+};
+
+// 节点的度量, 构建语法树时自底向上一次计算
+struct NodeMetrics {
+    std::size_t FirstToken = 0;
+    std::size_t LastToken = 0;
+    // 首行宽度, 与 utf8::Utf8nLenAtFirstLine(GetText) 一致
+    std::size_t FirstLineWidth = 0;
+    // 首个 token 不在节点文本开头(空子节点)时无法缓存首行宽度
+    bool HasFirstLineWidth = false;
+    bool ContainsComment = false;
+};
+
 struct NodeOrToken {
     explicit NodeOrToken(LuaSyntaxNodeKind nodeKind)
             : Type(NodeOrTokenType::Node),
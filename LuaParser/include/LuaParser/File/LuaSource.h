@@ -23,6 +23,9 @@ public:
 
     std::size_t GetOffset(std::size_t line, std::size_t character) const;
 
+    // 行首的偏移, 超出最后一行时为文件长度
+    std::size_t GetLineStartOffset(std::size_t line) const;
+
     std::size_t GetTotalLine() const;
 
     void PushLine(std::size_t offset);
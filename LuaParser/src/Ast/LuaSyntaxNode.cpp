@@ -1,7 +1,6 @@
 ﻿#include "LuaParser/Ast/LuaSyntaxNode.h"
 #include "LuaParser/Ast/LuaSyntaxTree.h"
 #include "LuaParser/Lexer/LuaTokenTypeDetail.h"
-#include "Util/Utf8.h"
 
 LuaSyntaxNode::LuaSyntaxNode(std::size_t index)
     : _index(index) {
@@ -23,19 +22,19 @@ TextRange LuaSyntaxNode::GetTextRange(const LuaSyntaxTree &t) const {
 }
 
 std::size_t LuaSyntaxNode::GetStartLine(const LuaSyntaxTree &t) const {
-    return t.GetFile().GetLine(t.GetStartOffset(_index));
+    return t.GetStartLine(_index);
 }
 
 std::size_t LuaSyntaxNode::GetStartCol(const LuaSyntaxTree &t) const {
-    return t.GetFile().GetColumn(t.GetStartOffset(_index));
+    return t.GetStartCol(_index);
 }
 
 std::size_t LuaSyntaxNode::GetEndLine(const LuaSyntaxTree &t) const {
-    return t.GetFile().GetLine(t.GetEndOffset(_index));
+    return t.GetEndLine(_index);
 }
 
 std::size_t LuaSyntaxNode::GetEndCol(const LuaSyntaxTree &t) const {
-    return t.GetFile().GetColumn(t.GetEndOffset(_index));
+    return t.GetEndCol(_index);
 }
 
 std::string_view LuaSyntaxNode::GetText(const LuaSyntaxTree &t) const {
@@ -263,8 +262,11 @@ LuaSyntaxNode LuaSyntaxNode::GetLastToken(const LuaSyntaxTree &t) const {
 }
 
 std::size_t LuaSyntaxNode::GetFirstLineWidth(const LuaSyntaxTree &t) const {
-    auto text = GetText(t);
-    return utf8::Utf8nLenAtFirstLine(text.data(), text.size());
+    return t.GetFirstLineWidth(_index);
+}
+
+bool LuaSyntaxNode::ContainsComment(const LuaSyntaxTree &t) const {
+    return t.ContainsComment(_index);
 }
 
 std::size_t LuaSyntaxNode::CountTokenChild(LuaTokenKind kind, const LuaSyntaxTree &t) {
@@ -2,6 +2,7 @@
 #include "LuaParser/Lexer/LuaTokenTypeDetail.h"
 #include "LuaParser/Parse/LuaParser.h"
 #include "Util/format.h"
+#include "Util/Utf8.h"
 #include <algorithm>
 
 LuaSyntaxTree::LuaSyntaxTree()
@@ -69,6 +70,9 @@ void LuaSyntaxTree::BuildTree(LuaParser &p) {
             _syntaxNodes.emplace_back(i + 1);
         }
     }
+
+    BuildTokenPosition();
+    BuildNodeMetrics();
 }
 
 void LuaSyntaxTree::StartNode(LuaSyntaxNodeKind kind, LuaParser &p) {
@@ -184,6 +188,150 @@ void LuaSyntaxTree::BuildToken(LuaToken &token) {
     }
 }
 
+void LuaSyntaxTree::BuildTokenPosition() {
+    _tokenPositions.resize(_tokens.size());
+    if (_tokens.empty()) {
+        return;
+    }
+
+    // token 按偏移有序, 只需向前扫描一遍, 列与 LuaSource::GetColumn 的结果一致
+    auto source = _source->GetSource();
+    std::size_t line = 0;
+    std::size_t nextLineOffset = _source->GetOffset(1, 0);
+    std::size_t columnOffset = 0;
+    std::size_t column = 0;
+    bool columnStop = false;
+    auto countColumn = [&](std::size_t offset) -> std::size_t {
+        if (columnStop || offset <= columnOffset) {
+            return column;
+        }
+        return column + utf8::Utf8nLen(source.data() + columnOffset, offset - columnOffset);
+    };
+    auto moveLine = [&](std::size_t offset) {
+        while (offset >= nextLineOffset) {
+            line++;
+            columnOffset = nextLineOffset;
+            column = 0;
+            columnStop = false;
+            nextLineOffset = _source->GetOffset(line + 1, 0);
+        }
+    };
+
+    for (std::size_t i = 0; i != _tokens.size(); i++) {
+        auto &token = _tokens[i];
+        auto &position = _tokenPositions[i];
+        moveLine(token.Start);
+        auto startColumn = countColumn(token.Start);
+        if (!columnStop && token.Start > columnOffset) {
+            columnStop = source.substr(columnOffset, token.Start - columnOffset).find('\0') != std::string_view::npos;
+            columnOffset = token.Start;
+            column = startColumn;
+        }
+        position.StartLine = line;
+        position.StartCol = startColumn;
+
+        auto endOffset = token.Length != 0 ? token.Start + token.Length - 1 : token.Start;
+        moveLine(endOffset);
+        position.EndLine = line;
+        position.EndCol = countColumn(endOffset);
+    }
+}
+
+// 与 utf8::Utf8nLenAtFirstLine 一致, 额外返回是否遇到了行尾
+static std::size_t FirstLineLen(std::string_view source, std::size_t start, std::size_t byteNum, bool &lineEnd) {
+    auto end = start + byteNum;
+    auto pos = start;
+    std::size_t length = 0;
+    while (pos < end) {
+        auto c = source[pos];
+        if (c == '\0' || c == '\r' || c == '\n') {
+            lineEnd = true;
+            break;
+        }
+        if (0xf0 == (0xf8 & c)) {
+            pos += 4;
+        } else if (0xe0 == (0xf0 & c)) {
+            pos += 3;
+        } else if (0xc0 == (0xe0 & c)) {
+            pos += 2;
+        } else {
+            pos += 1;
+        }
+        length++;
+    }
+    if (pos > end) {
+        length--;
+    }
+    return length;
+}
+
+void LuaSyntaxTree::BuildNodeMetrics() {
+    _nodeMetrics.resize(_nodeOrTokens.size());
+    if (_nodeOrTokens.empty()) {
+        return;
+    }
+
+    auto source = _source->GetSource();
+    // 子树中实际的首尾 token, 与 GetFirstToken/GetLastToken 不同, 会跳过空子节点
+    std::vector<std::size_t> realFirst(_nodeOrTokens.size(), 0);
+    std::vector<std::size_t> realLast(_nodeOrTokens.size(), 0);
+    // 首行宽度计算时是否遇到了行尾
+    std::vector<bool> lineEnd(_nodeOrTokens.size(), false);
+    // 节点下标为先序, 逆序遍历时子节点总是先于父节点
+    for (auto index = _nodeOrTokens.size() - 1; index > 0; index--) {
+        auto &n = _nodeOrTokens[index];
+        auto &metrics = _nodeMetrics[index];
+        if (n.Type == NodeOrTokenType::Token) {
+            auto &token = _tokens[n.Data.TokenIndex];
+            bool end = false;
+            metrics.FirstToken = index;
+            metrics.LastToken = index;
+            metrics.FirstLineWidth = FirstLineLen(source, token.Start, token.Length, end);
+            metrics.HasFirstLineWidth = true;
+            metrics.ContainsComment = token.Kind == TK_SHORT_COMMENT || token.Kind == TK_LONG_COMMENT;
+            realFirst[index] = index;
+            realLast[index] = index;
+            lineEnd[index] = end;
+            continue;
+        }
+
+        metrics.FirstToken = IsNode(n.FirstChild) ? _nodeMetrics[n.FirstChild].FirstToken : n.FirstChild;
+        metrics.LastToken = IsNode(n.LastChild) ? _nodeMetrics[n.LastChild].LastToken : n.LastChild;
+        std::size_t width = 0;
+        bool end = false;
+        std::size_t prevEnd = 0;
+        for (auto child = n.FirstChild; child != 0; child = _nodeOrTokens[child].NextSibling) {
+            metrics.ContainsComment = metrics.ContainsComment || _nodeMetrics[child].ContainsComment;
+            if (realFirst[child] == 0) {
+                continue;
+            }
+            if (realFirst[index] == 0) {
+                realFirst[index] = realFirst[child];
+                width = _nodeMetrics[child].FirstLineWidth;
+                end = lineEnd[child];
+            } else if (!end) {
+                // 子节点之间只有空白, 行宽按原文累加
+                auto start = _tokens[_nodeOrTokens[realFirst[child]].Data.TokenIndex].Start;
+                width += FirstLineLen(source, prevEnd, start - prevEnd, end);
+                if (!end) {
+                    width += _nodeMetrics[child].FirstLineWidth;
+                    end = lineEnd[child];
+                }
+            }
+            realLast[index] = realLast[child];
+            auto &lastToken = _tokens[_nodeOrTokens[realLast[child]].Data.TokenIndex];
+            prevEnd = lastToken.Start + lastToken.Length;
+        }
+        metrics.FirstLineWidth = width;
+        lineEnd[index] = end;
+        // 文本范围与实际首尾 token 一致时, 首行宽度与按文本计算的结果相同
+        metrics.HasFirstLineWidth = realFirst[index] != 0
+                                    && metrics.FirstToken == realFirst[index]
+                                    && metrics.LastToken == realLast[index]
+                                    && _tokens[_nodeOrTokens[realLast[index]].Data.TokenIndex].Length != 0;
+    }
+}
+
 const LuaSource &LuaSyntaxTree::GetFile() const {
     return *_source;
 }
@@ -195,10 +343,7 @@ std::size_t LuaSyntaxTree::GetStartOffset(std::size_t index) const {
     if (index < _nodeOrTokens.size()) {
         auto &n = _nodeOrTokens[index];
         if (n.Type == NodeOrTokenType::Node) {
-            auto child = n.FirstChild;
-            while (IsNode(child)) {
-                child = GetFirstChild(child);
-            }
+            auto child = GetFirstToken(index);
             if (child != 0) {
                 return _tokens[_nodeOrTokens[child].Data.TokenIndex].Start;
             } else {
@@ -224,10 +369,7 @@ std::size_t LuaSyntaxTree::GetEndOffset(std::size_t index) const {
     if (index < _nodeOrTokens.size()) {
         auto &n = _nodeOrTokens[index];
         if (n.Type == NodeOrTokenType::Node) {
-            auto child = n.LastChild;
-            while (IsNode(child)) {
-                child = GetLastChild(child);
-            }
+            auto child = GetLastToken(index);
             if (child != 0) {
                 nodeOrTokenIndex = child;
             } else {
@@ -269,6 +411,56 @@ TextRange LuaSyntaxTree::GetTokenRange(std::size_t index) const {
     return TextRange();
 }
 
+std::size_t LuaSyntaxTree::GetStartLine(std::size_t index) const {
+    auto token = GetFirstToken(index);
+    if (IsToken(token)) {
+        return _tokenPositions[_nodeOrTokens[token].Data.TokenIndex].StartLine;
+    }
+    return _source->GetLine(GetStartOffset(index));
+}
+
+std::size_t LuaSyntaxTree::GetStartCol(std::size_t index) const {
+    auto token = GetFirstToken(index);
+    if (IsToken(token)) {
+        return _tokenPositions[_nodeOrTokens[token].Data.TokenIndex].StartCol;
+    }
+    return _source->GetColumn(GetStartOffset(index));
+}
+
+std::size_t LuaSyntaxTree::GetEndLine(std::size_t index) const {
+    auto token = GetLastToken(index);
+    if (IsToken(token)) {
+        return _tokenPositions[_nodeOrTokens[token].Data.TokenIndex].EndLine;
+    }
+    return _source->GetLine(GetEndOffset(index));
+}
+
+std::size_t LuaSyntaxTree::GetEndCol(std::size_t index) const {
+    auto token = GetLastToken(index);
+    if (IsToken(token)) {
+        return _tokenPositions[_nodeOrTokens[token].Data.TokenIndex].EndCol;
+    }
+    return _source->GetColumn(GetEndOffset(index));
+}
+
+std::size_t LuaSyntaxTree::GetFirstLineWidth(std::size_t index) const {
+    if (index == 0) {
+        return 0;
+    }
+    if (index < _nodeMetrics.size() && _nodeMetrics[index].HasFirstLineWidth) {
+        return _nodeMetrics[index].FirstLineWidth;
+    }
+    auto text = LuaSyntaxNode(index).GetText(*this);
+    return utf8::Utf8nLenAtFirstLine(text.data(), text.size());
+}
+
+bool LuaSyntaxTree::ContainsComment(std::size_t index) const {
+    if (index < _nodeMetrics.size()) {
+        return _nodeMetrics[index].ContainsComment;
+    }
+    return false;
+}
+
 std::size_t LuaSyntaxTree::GetNextSibling(std::size_t index) const {
     if (index < _nodeOrTokens.size()) {
         return _nodeOrTokens[index].NextSibling;
@@ -298,6 +490,9 @@ std::size_t LuaSyntaxTree::GetLastChild(std::size_t index) const {
 }
 
 std::size_t LuaSyntaxTree::GetFirstToken(std::size_t index) const {
+    if (index < _nodeMetrics.size()) {
+        return _nodeMetrics[index].FirstToken;
+    }
     if (index < _nodeOrTokens.size()) {
         auto &n = _nodeOrTokens[index];
         if (n.Type == NodeOrTokenType::Node) {
@@ -314,6 +509,9 @@ std::size_t LuaSyntaxTree::GetFirstToken(std::size_t index) const {
 }
 
 std::size_t LuaSyntaxTree::GetLastToken(std::size_t index) const {
+    if (index < _nodeMetrics.size()) {
+        return _nodeMetrics[index].LastToken;
+    }
     if (index < _nodeOrTokens.size()) {
         auto &n = _nodeOrTokens[index];
         if (n.Type == NodeOrTokenType::Node) {
@@ -104,6 +104,13 @@ std::size_t LuaSource::GetOffset(std::size_t line, std::size_t character) const
     return lineStartOffset + offset;
 }
 
+std::size_t LuaSource::GetLineStartOffset(std::size_t line) const {
+    if (line >= _lineOffsetVec.size()) {
+        return _source.size();
+    }
+    return _lineOffsetVec[line];
+}
+
 std::size_t LuaSource::GetTotalLine() const {
     return _linenumber;
 }
@@ -0,0 +1,43 @@
+#include "Util/CommandLine.h"
+#include "Util/StringUtil.h"
+#include "Util/SymSpell/SymSpell.h"
+#include "Util/format.h"
+#include <iostream>
+
+// 把文本词典预先生成为 SymSpell 索引, 语言服务加载索引时不需要再生成删除串
+int main(int argc, char **argv) {
+    CommandLine cmd;
+    cmd.SetUsage(
+            "Usage:\n"
+            "SpellIndexBuilder build -i dictionary.txt -o dictionary.idx\n"
+            "SpellIndexBuilder build -i \"dictionary.txt;lua_dict.txt\" -o dictionary.idx\n");
+    cmd.AddTarget("build")
+            .Add<std::string>("input", "i", "Specify text dictionaries, separated by ';'\n"
+                                            "\t\teach line is a word, optionally followed by its frequency")
+            .Add<std::string>("output", "o", "Specify the index file");
+
+    if (!cmd.Parse(argc, argv) || !cmd.HasOption("input") || !cmd.HasOption("output")) {
+        cmd.PrintUsage();
+        return -1;
+    }
+
+    SymSpell symSpell(SymSpell::Strategy::LazyLoaded);
+    auto inputs = cmd.Get<std::string>("input");
+    for (auto input: string_util::Split(inputs, ";")) {
+        auto path = string_util::TrimSpace(input);
+        if (path.empty()) {
+            continue;
+        }
+        if (!symSpell.LoadWordDictionary(std::string(path))) {
+            std::cerr << util::format("Can not read dictionary {}", path) << std::endl;
+            return -1;
+        }
+    }
+
+    auto output = cmd.Get<std::string>("output");
+    if (!symSpell.SaveDictionary(output)) {
+        std::cerr << util::format("Can not write index {}", output) << std::endl;
+        return -1;
+    }
+    return 0;
+}
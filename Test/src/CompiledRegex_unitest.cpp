@@ -0,0 +1,89 @@
+#include "Util/CompiledRegex.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <regex>
+
+// 与 std::regex_match 的结果逐一比较, 包括捕获组
+static void ExpectSameAsStdRegex(const std::string &pattern, const std::vector<std::string> &texts) {
+    CompiledRegex compiled;
+    ASSERT_TRUE(compiled.Compile(pattern)) << pattern;
+    std::regex re(pattern, std::regex_constants::ECMAScript);
+    EXPECT_EQ(compiled.GetGroupCount(), re.mark_count()) << pattern;
+    for (auto &text: texts) {
+        std::smatch mc;
+        bool expected = std::regex_match(text, mc, re);
+        EXPECT_EQ(compiled.Match(text), expected) << pattern << " " << text;
+
+        std::vector<std::string_view> groups;
+        EXPECT_EQ(compiled.Match(text, groups), expected) << pattern << " " << text;
+        if (expected) {
+            ASSERT_EQ(groups.size(), mc.size());
+            for (std::size_t i = 0; i != mc.size(); i++) {
+                EXPECT_EQ(std::string(groups[i]), mc[i].str()) << pattern << " " << text << " group " << i;
+            }
+        }
+    }
+}
+
+TEST(CompiledRegex, matchLikeStdRegex) {
+    std::vector<std::string> texts = {
+            "", "a", "m_", "m_name", "m_camelCase", "m_snake_case", "M_Name", "uuu", "uu", "u",
+            "_private", "__index", "CONST_VALUE", "value1", "1value", "a.b", "ab", "abab", "aab",
+            "x_y_z", "get", "getName", "setName", "is_ok", "a-b", "a]b", "\t", "[a]"};
+    std::vector<std::string> patterns = {
+            "uuu*",
+            "m_(\\w+)",
+            "^m_(\\w+)$",
+            "(m|M)_(\\w*)",
+            "(?:get|set)([A-Z]\\w*)",
+            "_*[a-z][a-z0-9_]*",
+            "[A-Z][A-Z0-9]*(_[A-Z0-9]+)*",
+            "(a|ab)(c|bcd)?(d*)",
+            "(?:a*)*",
+            "(?:a*)+b?",
+            "(ab|a)(b*)",
+            "a{2}",
+            "a{1,}b?",
+            "(a|b){0,3}",
+            "[^_].*",
+            "\\d+|\\D+",
+            "[\\w.]+",
+            "a\\.b",
+            "[a\\-]+\\]?b",
+            "\\s",
+            "(x)?(y)?_?(z)?",
+            "a|",
+            "()",
+            "[]a",
+            "[^]+",
+            "\\[a\\]",
+    };
+    for (auto &pattern: patterns) {
+        ExpectSameAsStdRegex(pattern, texts);
+    }
+}
+
+TEST(CompiledRegex, randomTexts) {
+    std::mt19937 rng(7);
+    std::vector<std::string> texts;
+    const std::string alphabet = "abAB_1.";
+    for (int i = 0; i != 500; i++) {
+        std::string text;
+        auto len = rng() % 8;
+        for (std::size_t j = 0; j != len; j++) {
+            text.push_back(alphabet[rng() % alphabet.size()]);
+        }
+        texts.push_back(text);
+    }
+    for (std::string pattern: {"(a|ab|b)*(_\\w)?", "([aA]+)(b*)(\\d?)", "(?:a|b)+_?(1|\\.)*", "[a-b]{1,3}(B|_)*.?"}) {
+        ExpectSameAsStdRegex(pattern, texts);
+    }
+}
+
+TEST(CompiledRegex, unsupported) {
+    CompiledRegex compiled;
+    for (std::string pattern: {"(a)\\1", "a*?", "(?=a)a", "(?!a)b", "\\bword", "a**", "(a", "a)", "[a", "a{2,1}",
+                               "[[:alpha:]]", "\\x41", "a^b", "(a*)*", "(x?)+"}) {
+        EXPECT_FALSE(compiled.Compile(pattern)) << pattern;
+    }
+}
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+#include "TestHelper.h"
+#include "CodeFormatCore/Diagnostic/DiagnosticBuilder.h"
+
+static std::vector<LuaDiagnostic> CheckText(const std::string &text, LuaDiagnosticStyle &diagnosticStyle, bool *truncated = nullptr) {
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    DiagnosticBuilder d(TestHelper::DefaultStyle, diagnosticStyle);
+    d.CodeStyleCheck(t);
+    d.NameStyleCheck(t);
+    if (truncated) {
+        *truncated = d.IsTruncated();
+    }
+    return d.GetDiagnosticResults(t);
+}
+
+TEST(Diagnostic, limit) {
+    std::string text = "local   a =1\nlocal  b=2\nlocal c  =  3\nlocal camelCase = 1\n";
+    LuaDiagnosticStyle diagnosticStyle;
+    bool truncated = false;
+    auto all = CheckText(text, diagnosticStyle, &truncated);
+    EXPECT_FALSE(truncated);
+    EXPECT_GT(all.size(), 3);
+
+    diagnosticStyle.max_diagnostic_count = 3;
+    auto limited = CheckText(text, diagnosticStyle, &truncated);
+    EXPECT_TRUE(truncated);
+    ASSERT_EQ(limited.size(), 3);
+
+    diagnosticStyle.max_diagnostic_count = all.size();
+    CheckText(text, diagnosticStyle, &truncated);
+    EXPECT_FALSE(truncated);
+
+    diagnosticStyle.max_diagnostic_count = 0;
+    diagnosticStyle.max_diagnostic_count_per_type = 1;
+    auto perType = CheckText(text, diagnosticStyle, &truncated);
+    EXPECT_TRUE(truncated);
+    std::map<DiagnosticType, std::size_t> counts;
+    for (auto &d: perType) {
+        counts[d.Type]++;
+    }
+    for (auto &[type, count]: counts) {
+        EXPECT_EQ(count, 1);
+    }
+    EXPECT_EQ(counts[DiagnosticType::NameStyle], 1);
+}
+
+TEST(Diagnostic, replaceLimit) {
+    auto p = TestHelper::GetParser("local a = 1\n");
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    LuaDiagnosticStyle diagnosticStyle;
+    diagnosticStyle.max_diagnostic_count_per_type = 1;
+    DiagnosticBuilder d(TestHelper::DefaultStyle, diagnosticStyle);
+
+    d.PushDiagnostic(DiagnosticType::Space, 1, TextRange(0, 1), "space");
+    d.PushDiagnostic(DiagnosticType::Indent, 2, TextRange(2, 1), "indent");
+    EXPECT_FALSE(d.IsTruncated());
+    // 同类型的替换不受限制
+    d.PushDiagnostic(DiagnosticType::Indent, 2, TextRange(2, 1), "indent again");
+    EXPECT_FALSE(d.IsTruncated());
+
+    // Indent 已经达到上限, 替换被丢弃, 旧的 Space 也不再保留
+    d.PushDiagnostic(DiagnosticType::Indent, 1, TextRange(0, 1), "indent replace");
+    EXPECT_TRUE(d.IsTruncated());
+    EXPECT_TRUE(d.IsLimitExceeded(DiagnosticType::Indent));
+
+    // Space 的名额已经释放
+    d.PushDiagnostic(DiagnosticType::Space, 3, TextRange(4, 1), "space");
+    auto results = d.GetDiagnosticResults(t);
+    ASSERT_EQ(results.size(), 2);
+    std::map<DiagnosticType, std::size_t> counts;
+    for (auto &diagnostic: results) {
+        counts[diagnostic.Type]++;
+        EXPECT_NE(diagnostic.Message, "indent replace");
+    }
+    EXPECT_EQ(counts[DiagnosticType::Indent], 1);
+    EXPECT_EQ(counts[DiagnosticType::Space], 1);
+}
+
+TEST(Diagnostic, range) {
+    auto expectRange = [](const std::string &text, std::size_t startLine, std::size_t endLine) {
+        LuaDiagnosticStyle diagnosticStyle;
+        auto all = CheckText(text, diagnosticStyle);
+
+        auto p = TestHelper::GetParser(text);
+        LuaSyntaxTree t;
+        t.BuildTree(p);
+        DiagnosticBuilder d(TestHelper::DefaultStyle, diagnosticStyle);
+        d.SetDiagnosticRange(t, startLine, endLine);
+        d.CodeStyleCheck(t);
+        d.NameStyleCheck(t);
+        auto ranged = d.GetDiagnosticResults(t);
+
+        std::vector<LuaDiagnostic> expected;
+        for (auto &diagnostic: all) {
+            auto line = t.GetFile().GetLine(diagnostic.Range.StartOffset);
+            if (line >= startLine && line <= endLine) {
+                expected.push_back(diagnostic);
+            }
+        }
+        EXPECT_EQ(ranged.size(), expected.size());
+        for (std::size_t i = 0; i < expected.size() && i < ranged.size(); i++) {
+            EXPECT_EQ(ranged[i].Type, expected[i].Type);
+            EXPECT_EQ(ranged[i].Range.StartOffset, expected[i].Range.StartOffset);
+            EXPECT_EQ(ranged[i].Message, expected[i].Message);
+        }
+        return expected.size();
+    };
+
+    std::string text = "local   a =1\n"
+                       "function f(x)\n"
+                       "    if x then\n"
+                       "      local  camelCase= 1\n"
+                       "        return   x\n"
+                       "    end\n"
+                       "end\n"
+                       "local c  =  3\n";
+    EXPECT_GT(expectRange(text, 3, 4), 0);
+    expectRange(text, 0, 0);
+    expectRange(text, 7, 7);
+
+    // 范围之外的注释与相邻语句仍影响范围之内的结果
+    std::string outside = "local t = {\n"
+                          "    aa = 1,\n"
+                          "    b   = 2,\n"
+                          "}\n"
+                          "---@format disable\n"
+                          "local  x  =  1\n"
+                          "local  y  =  2\n";
+    expectRange(outside, 2, 2);
+    EXPECT_EQ(expectRange(outside, 6, 6), 0);
+}
+
+TEST(Diagnostic, spellCache) {
+    CodeSpellChecker spellChecker;
+    spellChecker.LoadDictionaryFromBuffer("hello\nworld\nprint\n");
+    LuaDiagnosticStyle diagnosticStyle;
+    diagnosticStyle.spell_check = true;
+
+    auto spellCheck = [&](const std::string &text) {
+        auto p = TestHelper::GetParser(text);
+        LuaSyntaxTree t;
+        t.BuildTree(p);
+        DiagnosticBuilder d(TestHelper::DefaultStyle, diagnosticStyle);
+        d.SpellCheck(t, spellChecker);
+        return d.GetDiagnosticResults(t).size();
+    };
+
+    std::string text = "local helloWorld = 1\nprint(helloWorld, 'helo world')\n";
+    EXPECT_EQ(spellCheck(text), 1);
+    auto first = spellChecker.GetCacheStatistics();
+    EXPECT_EQ(first.Hits, 3);
+    EXPECT_EQ(first.Misses, 4);
+
+    EXPECT_EQ(spellCheck(text), 1);
+    auto second = spellChecker.GetCacheStatistics();
+    EXPECT_EQ(second.Misses, first.Misses);
+    EXPECT_EQ(second.Hits, first.Hits + 7);
+    EXPECT_GT(second.HitRate(), 0.5);
+
+    auto suggests = spellChecker.GetSuggests("helo");
+    ASSERT_FALSE(suggests.empty());
+    EXPECT_EQ(suggests.front().Term, "hello");
+    EXPECT_EQ(spellChecker.GetSuggests("Helo").front().Term, "Hello");
+    EXPECT_EQ(spellChecker.GetCacheStatistics().Hits, second.Hits + 1);
+
+    // 自定义词典变化后旧结果失效
+    spellChecker.SetCustomDictionary({"helo"});
+    EXPECT_EQ(spellCheck(text), 0);
+
+    SpellResultCache cache(SpellResultCache::DefaultCapacity / 4096);
+    bool correct = false;
+    for (int i = 0; i != 1000; i++) {
+        cache.PutCorrect(std::to_string(i), 0, true);
+    }
+    EXPECT_LE(cache.GetStatistics().Size, 16);
+    EXPECT_TRUE(cache.FindCorrect("999", 0, correct));
+    EXPECT_FALSE(cache.FindCorrect("999", 1, correct));
+}
+
+TEST(Diagnostic, checkModes) {
+    CodeSpellChecker spellChecker;
+    spellChecker.LoadDictionaryFromBuffer("hello\nworld\nprint\nlocal\nfunction\n");
+
+    std::string text = R"(local   helloWorld =1
+---@format disable-next
+local  helo  =  'helo wrold'
+function f(wrold)
+    if wrold then
+      local  camelCase= "typpo"
+        return   wrold
+    end
+end
+---@format disable
+local  ignored =  "wrold"
+)";
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+
+    enum class Mode {
+        Sequential,
+        Fused,
+        Parallel
+    };
+    auto check = [&](LuaDiagnosticStyle &style, Mode mode, std::size_t startLine, std::size_t endLine) {
+        DiagnosticBuilder d(TestHelper::DefaultStyle, style);
+        if (endLine != 0) {
+            d.SetDiagnosticRange(t, startLine, endLine);
+        }
+        if (mode == Mode::Sequential) {
+            d.CodeStyleCheck(t);
+            d.SpellCheck(t, spellChecker);
+            d.NameStyleCheck(t);
+        } else {
+            d.SetParallelCheck(mode == Mode::Parallel);
+            d.Check(t, &spellChecker);
+        }
+        return std::make_pair(d.GetDiagnosticResults(t), d.IsTruncated());
+    };
+
+    auto expectSame = [&](LuaDiagnosticStyle &style, std::size_t startLine = 0, std::size_t endLine = 0) {
+        auto [expected, expectedTruncated] = check(style, Mode::Sequential, startLine, endLine);
+        for (auto mode: {Mode::Fused, Mode::Parallel}) {
+            auto [results, truncated] = check(style, mode, startLine, endLine);
+            EXPECT_EQ(truncated, expectedTruncated);
+            EXPECT_EQ(results.size(), expected.size());
+            for (std::size_t i = 0; i < expected.size() && i < results.size(); i++) {
+                EXPECT_EQ(results[i].Type, expected[i].Type);
+                EXPECT_EQ(results[i].Range.StartOffset, expected[i].Range.StartOffset);
+                EXPECT_EQ(results[i].Range.Length, expected[i].Range.Length);
+                EXPECT_EQ(results[i].Message, expected[i].Message);
+            }
+        }
+        return expected.size();
+    };
+
+    LuaDiagnosticStyle style;
+    auto all = expectSame(style);
+    EXPECT_GT(all, 5);
+    expectSame(style, 3, 5);
+    for (std::size_t limit = 1; limit <= all; limit++) {
+        style.max_diagnostic_count = limit;
+        expectSame(style);
+    }
+    style.max_diagnostic_count = 0;
+    style.max_diagnostic_count_per_type = 2;
+    expectSame(style);
+    style.max_diagnostic_count_per_type = 0;
+    style.code_style_check = false;
+    expectSame(style);
+    style.code_style_check = true;
+    style.spell_check = false;
+    expectSame(style);
+}
+
+TEST(Diagnostic, nameStyleScope) {
+    std::string text = R"(
+local localName = 1
+localName = 2
+function f(paramName)
+    paramName = 1
+    do
+        local innerName = 1
+        innerName = 2
+    end
+    innerName = 3
+end
+localName = 4
+)";
+    LuaDiagnosticStyle diagnosticStyle;
+    auto diagnostics = CheckText(text, diagnosticStyle);
+    std::map<std::string, std::size_t> globals;
+    for (auto &diagnostic: diagnostics) {
+        if (diagnostic.Message.find("GlobalVariableDefineName") != std::string::npos) {
+            globals[diagnostic.Message.substr(0, diagnostic.Message.find(" does"))]++;
+        }
+    }
+    ASSERT_EQ(globals.size(), 1);
+    EXPECT_EQ(globals.begin()->first, "Name 'innerName'");
+    EXPECT_EQ(globals.begin()->second, 1);
+}
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "TestHelper.h"
+#include "Util/FileFinder.h"
+#include "Util/IgnoreMatcher.h"
+#include <fstream>
+#include <stdexcept>
 
 TEST(FilePattern, simple) {
     EXPECT_TRUE(TestHelper::TestPattern("*", ".lua"));
@@ -38,6 +42,265 @@ TEST(FilePattern, simple) {
 
     EXPECT_TRUE(TestHelper::TestPattern("[abc]bc.lua", "abc.lua"));
     EXPECT_FALSE(TestHelper::TestPattern("[!a]bc.lua", "abc.lua"));
+
+    EXPECT_TRUE(TestHelper::TestPattern("test{1..3}.lua", "test2.lua"));
+    EXPECT_FALSE(TestHelper::TestPattern("test{1..3}.lua", "test4.lua"));
+    EXPECT_TRUE(TestHelper::TestPattern("test{-1..1}.lua", "test-1.lua"));
+}
+
+TEST(FilePattern, editorconfigSections) {
+    LuaEditorConfig editorConfig(
+            "[*.lua]\n"
+            "indent_size = 2\n"
+            "[Content/*.lua]\n"
+            "indent_size = 8\n"
+            "[{lib,core}.lua]\n"
+            "quote_style = single\n"
+            "[*.md]\n"
+            "indent_size = 3\n");
+    editorConfig.Parse();
+
+    auto &contentStyle = editorConfig.Generate("root/Content/1.lua");
+    EXPECT_EQ(contentStyle.indent_size, 8);
+    EXPECT_EQ(&editorConfig.Generate("root\\Content\\1.lua"), &contentStyle);
+    EXPECT_EQ(&editorConfig.Generate("root/Content/2.lua"), &contentStyle);
+
+    auto &style = editorConfig.Generate("root/1.lua");
+    EXPECT_EQ(style.indent_size, 2);
+    EXPECT_EQ(style.quote_style, QuoteStyle::None);
+
+    auto &libStyle = editorConfig.Generate("root/lib.lua");
+    EXPECT_EQ(libStyle.indent_size, 2);
+    EXPECT_EQ(libStyle.quote_style, QuoteStyle::Single);
+}
+
+TEST(FilePattern, automaton) {
+    struct Case {
+        std::string_view Pattern;
+        std::string_view Path;
+        bool Match;
+    };
+    std::vector<Case> cases = {
+            {"*", ".lua", true},
+            {"*.lua", "1/1.lua", true},
+            {"*.lua", "1\\1.lua", true},
+            {"**.lua", "1/1.lua", true},
+            {"Content/*.lua", "Content/1.lua", true},
+            {"Content/*.lua", "Content2/1.lua", false},
+            {"Content/*.lua", "Content/1/1.lua", false},
+            {"Content/*.lua", "1.lua", false},
+            {"Content/aaa*.lua", "Content/aaaAAAAAA.lua", true},
+            {"Content/aaa*.lua", "aaaAAAAAA.lua", false},
+            {"Content/**.lua", "Content/1/1.lua", true},
+            {"Content/**.lua", "Content2/1/1.lua", false},
+            {"?abc.lua", "abc.lua", false},
+            {"?abc.lua", "Dabc.lua", true},
+            {"[abc]bc.lua", "abc.lua", true},
+            {"[!a]bc.lua", "abc.lua", false},
+            {"{test,lib}.lua", "src/lib.lua", true},
+            {"test{1..3}.lua", "test4.lua", false},
+    };
+
+    std::vector<EditorconfigPattern> patterns(cases.size());
+    for (std::size_t i = 0; i != cases.size(); i++) {
+        patterns[i].Compile(cases[i].Pattern);
+        EXPECT_EQ(patterns[i].Match(cases[i].Path), cases[i].Match) << cases[i].Pattern << " " << cases[i].Path;
+        EXPECT_EQ(patterns[i].InterpretMatch(cases[i].Path), cases[i].Match) << cases[i].Pattern << " " << cases[i].Path;
+    }
+
+    // 合并后的自动机与逐个匹配的结果一致
+    GlobAutomaton sectionAutomaton;
+    for (std::size_t i = 0; i != patterns.size(); i++) {
+        patterns[i].AddTo(sectionAutomaton, i);
+    }
+    EXPECT_TRUE(sectionAutomaton.Build());
+    for (auto &c: cases) {
+        std::size_t count = 0;
+        for (auto &pattern: patterns) {
+            count += pattern.InterpretMatch(c.Path);
+        }
+        EXPECT_EQ(sectionAutomaton.Match(c.Path).size(), count) << c.Path;
+    }
+}
+
+TEST(FilePattern, editorconfigParse) {
+    LuaEditorConfig editorConfig(
+            "root = true\r\n"
+            "# comment\r\n"
+            "  ; comment\r\n"
+            "[*]\r\n"
+            "indent_style = space\r\n"
+            "[*.md]\r\n"
+            "indent_size = 3\r\n"
+            "[ [ab]c.lua ]\r\n"
+            "  quote_style=single  \r\n"
+            "max_line_length =\r\n"
+            "bad key = 1\r\n"
+            "[{a,b}.lua] x\n"
+            "indent_size = 4");
+    editorConfig.Parse();
+
+    auto &sections = editorConfig.GetSections();
+    ASSERT_EQ(sections.size(), 3);
+    EXPECT_EQ(sections[0].ConfigMap.at("indent_style"), "space");
+    EXPECT_TRUE(sections[1].ConfigMap.empty());
+    // "[{a,b}.lua] x" 不是 section, 之后的配置仍属于上一个 section
+    EXPECT_EQ(sections[2].ConfigMap.size(), 2);
+    EXPECT_EQ(sections[2].ConfigMap.at("quote_style"), "single");
+    EXPECT_EQ(sections[2].ConfigMap.at("indent_size"), "4");
+    EXPECT_EQ(editorConfig.Generate("ac.lua").quote_style, QuoteStyle::Single);
 }
 
+TEST(FilePattern, gitignore) {
+    EXPECT_TRUE(IgnoreMatcher::GlobMatch("*.lua", "a.lua"));
+    EXPECT_FALSE(IgnoreMatcher::GlobMatch("*.lua", "a/b.lua"));
+    EXPECT_TRUE(IgnoreMatcher::GlobMatch("**/b.lua", "b.lua"));
+    EXPECT_TRUE(IgnoreMatcher::GlobMatch("**/b.lua", "a/c/b.lua"));
+    EXPECT_TRUE(IgnoreMatcher::GlobMatch("a/**/b.lua", "a/b.lua"));
+    EXPECT_TRUE(IgnoreMatcher::GlobMatch("a/**/b.lua", "a/x/y/b.lua"));
+    EXPECT_FALSE(IgnoreMatcher::GlobMatch("a/**/b.lua", "xa/b.lua"));
+    EXPECT_TRUE(IgnoreMatcher::GlobMatch("a/**", "a/x/y"));
+    EXPECT_FALSE(IgnoreMatcher::GlobMatch("a**b", "a/b"));
+    EXPECT_TRUE(IgnoreMatcher::GlobMatch("[a-c]?.lua", "bx.lua"));
+    EXPECT_FALSE(IgnoreMatcher::GlobMatch("[!a-c]?.lua", "bx.lua"));
+    EXPECT_FALSE(IgnoreMatcher::GlobMatch("a?b", "a/b"));
+    EXPECT_TRUE(IgnoreMatcher::GlobMatch("\\*.lua", "*.lua"));
+    EXPECT_FALSE(IgnoreMatcher::GlobMatch("\\*.lua", "a.lua"));
+
+    IgnoreMatcher matcher;
+    matcher.AddPattern("# comment");
+    matcher.AddPattern("");
+    matcher.AddPattern("build/");
+    matcher.AddPattern("/third_party");
+    matcher.AddPattern("src/gen");
+    matcher.AddPattern("*.gen.lua");
+    matcher.AddPattern("!keep.gen.lua");
+    matcher.AddPattern("docs\\api");
 
+    EXPECT_TRUE(matcher.Match("build", true));
+    EXPECT_TRUE(matcher.Match("a/build", true));
+    // 只匹配目录
+    EXPECT_FALSE(matcher.Match("build", false));
+    // 锚定到根目录
+    EXPECT_TRUE(matcher.Match("third_party", true));
+    EXPECT_FALSE(matcher.Match("a/third_party", true));
+    EXPECT_TRUE(matcher.Match("src/gen", true));
+    EXPECT_FALSE(matcher.Match("a/src/gen", true));
+    EXPECT_TRUE(matcher.Match("a/b/x.gen.lua", false));
+    // 取反, 后面的规则优先
+    EXPECT_FALSE(matcher.Match("a/keep.gen.lua", false));
+    EXPECT_TRUE(matcher.Match("docs/api", true));
+    EXPECT_FALSE(matcher.Match("a/b/x.lua", false));
+
+    EXPECT_TRUE(matcher.IsIgnored("build/x.lua", false));
+    EXPECT_TRUE(matcher.IsIgnored("src/gen/a/keep.lua", false));
+    EXPECT_FALSE(matcher.IsIgnored("src/main.lua", false));
+}
+
+TEST(FilePattern, fileFinderPrune) {
+    auto root = std::filesystem::temp_directory_path() / "CodeFormatTest_fileFinderPrune";
+    std::filesystem::remove_all(root);
+    std::vector<std::string> files = {
+            "main.lua",
+            "a.txt",
+            "src/a.lua",
+            "src/gen/b.lua",
+            "src/x.gen.lua",
+            "src/keep.gen.lua",
+            "build/c.lua",
+            "lib/build/d.lua",
+            "third_party/e.lua",
+            "lib/third_party/f.lua",
+            "node_modules/m/g.lua",
+            ".git/h.lua",
+    };
+    for (auto &file: files) {
+        auto path = root / file;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path.string()) << "print(1)\n";
+    }
+
+    std::vector<std::string> expected = {
+            "lib/third_party/f.lua",
+            "main.lua",
+            "src/a.lua",
+            "src/keep.gen.lua",
+    };
+
+    for (std::size_t threadCount: {1, 4}) {
+        FileFinder finder(root);
+        finder.SetThreadCount(threadCount);
+        finder.AddFindExtension(".lua");
+        finder.AddIgnoreDirectory(".git");
+        for (auto pattern: {"build/", "/third_party", "src/gen/", "node_modules", "*.gen.lua", "!keep.gen.lua"}) {
+            finder.AddGitignorePatterns(pattern);
+        }
+
+        std::vector<std::string> result;
+        for (auto &path: finder.FindFiles()) {
+            auto relativePath = std::filesystem::path(path).lexically_relative(root).generic_string();
+            result.push_back(relativePath);
+        }
+        std::sort(result.begin(), result.end());
+        EXPECT_EQ(result, expected);
+        // root, src, lib, lib/third_party, 被忽略的目录不会进入
+        EXPECT_EQ(finder.GetVisitedDirectoryCount(), 4);
+    }
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(FilePattern, fileFinderWildcard) {
+    auto root = std::filesystem::temp_directory_path() / "CodeFormatTest_fileFinderWildcard";
+    std::filesystem::remove_all(root);
+    std::vector<std::string> files = {
+            "main.lua",
+            "Test/x.lua",
+            "Test/sub/x.lua",
+            "src/a.lua",
+            "src/a/b.lua",
+            "lib/c.lua",
+    };
+    for (auto &file: files) {
+        auto path = root / file;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path.string()) << "print(1)\n";
+    }
+
+    // --ignores 的通配符 '*' 可以跨越 '/'
+    FileFinder finder(root);
+    finder.AddFindExtension(".lua");
+    finder.AddignorePatterns("Test/*.lua");
+    finder.AddignorePatterns("/src/**.lua");
+
+    std::vector<std::string> result;
+    for (auto &path: finder.FindFiles()) {
+        result.push_back(std::filesystem::path(path).lexically_relative(root).generic_string());
+    }
+    std::sort(result.begin(), result.end());
+    std::vector<std::string> expected = {"lib/c.lua", "main.lua"};
+    EXPECT_EQ(result, expected);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(FilePattern, fileFinderException) {
+    auto root = std::filesystem::temp_directory_path() / "CodeFormatTest_fileFinderException";
+    std::filesystem::remove_all(root);
+    for (int i = 0; i != 16; i++) {
+        auto path = root / std::to_string(i) / "a.lua";
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path.string()) << "print(1)\n";
+    }
+
+    FileFinder finder(root);
+    finder.SetThreadCount(4);
+    finder.AddFindExtension(".lua");
+    auto onFile = [](std::string &&) {
+        throw std::runtime_error("stop");
+    };
+    // 抛出异常的线程退出后其他线程不能一直等待
+    EXPECT_THROW(finder.FindFiles(onFile), std::runtime_error);
+
+    std::filesystem::remove_all(root);
+}
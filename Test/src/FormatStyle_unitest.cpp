@@ -1310,6 +1310,22 @@ local t = {
 )",
             R"(
 local t = { aaaa, bbbbbbb, dddd = 123, hhihi = 123 }
+)",
+            style));
+    EXPECT_TRUE(TestHelper::TestFormatted(
+            R"(
+local t = {
+    aaaa,
+    bbbb = { -- note
+        1 },
+}
+)",
+            R"(
+local t = {
+    aaaa,
+    bbbb = { -- note
+        1 },
+}
 )",
             style));
 }
@@ -1835,6 +1851,42 @@ local d={
             style));
 }
 
+TEST(FormatByStyleOption, layout_line_break) {
+    LuaStyle style;
+    style.max_line_length = 50;
+
+    style.layout_line_break = false;
+    EXPECT_TRUE(TestHelper::TestFormatted(
+            R"(
+local x = outer_call(first_argument, inner(a1, a2, a3, a4))
+local t = { 111, 222, 333, 444, 555, 666, 777, 888, 999, 1000 }
+local y = { name = "value", list = { 1, 2, 3, 4, 5, 6 } }
+)",
+            R"(
+local x = outer_call(first_argument,
+    inner(a1, a2, a3, a4))
+local t = { 111, 222, 333, 444, 555, 666, 777, 888, 999, 1000 }
+local y = { name = "value", list = { 1, 2, 3, 4, 5, 6 } }
+)",
+            style));
+    style.layout_line_break = true;
+    EXPECT_TRUE(TestHelper::TestFormatted(
+            R"(
+local x = outer_call(first_argument, inner(a1, a2, a3, a4))
+local t = { 111, 222, 333, 444, 555, 666, 777, 888, 999, 1000 }
+local y = { name = "value", list = { 1, 2, 3, 4, 5, 6 } }
+)",
+            R"(
+local x = outer_call(first_argument,
+    inner(a1, a2, a3, a4))
+local t = { 111, 222, 333, 444, 555, 666, 777,
+    888, 999, 1000 }
+local y = { name = "value",
+    list = { 1, 2, 3, 4, 5, 6 } }
+)",
+            style));
+}
+
 TEST(FormatByStyleOption, space_around_logical_operator) {
     LuaStyle style;
 
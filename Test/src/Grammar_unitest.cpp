@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "TestHelper.h"
+#include "Util/Utf8.h"
+#include "LuaParser/Lexer/LuaTokenTypeDetail.h"
 
 std::string MakeErrors(LuaParser &p) {
     auto errors = p.GetErrors();
@@ -63,3 +65,78 @@ local t2 = ddd?:ffffff()
 local t3 = ddd?["hello"]
 )", true).HasError()) << "extend grammar nullable operator test fail";
 }
+
+TEST(LuaGrammar, position) {
+    std::vector<std::string> paths;
+    std::filesystem::path root(TestHelper::ScriptBase);
+    std::filesystem::path dir = root / "grammar";
+    TestHelper::CollectLuaFile(dir, paths, root);
+    paths.emplace_back("");
+    for (auto &filePath: paths) {
+        std::string text;
+        if (filePath.empty()) {
+            text = "local s = '中文";
+            text.push_back('\0');
+            text.append("x' -- 注释\r\nlocal t = [[\n多行\n]] x = 1");
+        } else {
+            text = TestHelper::ReadFile(filePath);
+        }
+        auto p = TestHelper::GetParser(text);
+        LuaSyntaxTree t;
+        t.BuildTree(p);
+        auto &file = t.GetFile();
+        for (auto &n: t.GetSyntaxNodes()) {
+            ASSERT_EQ(n.GetStartLine(t), file.GetLine(t.GetStartOffset(n.GetIndex()))) << filePath;
+            ASSERT_EQ(n.GetStartCol(t), file.GetColumn(t.GetStartOffset(n.GetIndex()))) << filePath;
+            ASSERT_EQ(n.GetEndLine(t), file.GetLine(t.GetEndOffset(n.GetIndex()))) << filePath;
+            ASSERT_EQ(n.GetEndCol(t), file.GetColumn(t.GetEndOffset(n.GetIndex()))) << filePath;
+        }
+    }
+}
+
+TEST(LuaGrammar, metrics) {
+    std::vector<std::string> paths;
+    std::filesystem::path root(TestHelper::ScriptBase);
+    TestHelper::CollectLuaFile(root / "grammar", paths, root);
+    paths.emplace_back("performance/1k_row_code.lua");
+    paths.emplace_back("");
+    for (auto &filePath: paths) {
+        std::string text;
+        if (filePath.empty()) {
+            text = "local s = '中文";
+            text.push_back('\0');
+            text.append("x' -- 注释\r\nlocal t = { [[\n多行\n]], -- c\n f() } return");
+        } else {
+            text = TestHelper::ReadFile(filePath);
+        }
+        auto p = TestHelper::GetParser(text);
+        LuaSyntaxTree t;
+        t.BuildTree(p);
+        for (auto &n: t.GetSyntaxNodes()) {
+            auto nodeText = n.GetText(t);
+            ASSERT_EQ(n.GetFirstLineWidth(t), utf8::Utf8nLenAtFirstLine(nodeText.data(), nodeText.size())) << filePath;
+
+            auto first = n.GetIndex();
+            while (t.IsNode(first)) {
+                first = t.GetFirstChild(first);
+            }
+            ASSERT_EQ(n.GetFirstToken(t).GetIndex(), first) << filePath;
+            auto last = n.GetIndex();
+            while (t.IsNode(last)) {
+                last = t.GetLastChild(last);
+            }
+            ASSERT_EQ(n.GetLastToken(t).GetIndex(), last) << filePath;
+
+            // 先序下标, 子树是连续的一段
+            auto subtreeEnd = n.GetIndex();
+            while (t.GetLastChild(subtreeEnd) != 0) {
+                subtreeEnd = t.GetLastChild(subtreeEnd);
+            }
+            bool comment = false;
+            for (auto i = n.GetIndex(); i <= subtreeEnd; i++) {
+                comment = comment || t.GetTokenKind(i) == TK_SHORT_COMMENT || t.GetTokenKind(i) == TK_LONG_COMMENT;
+            }
+            ASSERT_EQ(n.ContainsComment(t), comment) << filePath;
+        }
+    }
+}
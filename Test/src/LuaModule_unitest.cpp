@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include "LuaDocument.h"
+#include "lua.hpp"
+#include <string>
+
+extern "C" int luaopen_code_format(lua_State *L);
+
+namespace {
+// 运行脚本, 返回错误信息, 成功时为空
+std::string RunLua(const char *script) {
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    luaL_requiref(L, "code_format", luaopen_code_format, 0);
+    lua_pop(L, 1);
+
+    std::string err;
+    if (luaL_dostring(L, script) != LUA_OK) {
+        err = lua_tostring(L, -1);
+    }
+    lua_close(L);
+    return err;
+}
+}// namespace
+
+TEST(LuaModule, documentReuse) {
+    LuaDocument document("a.lua", "local  a=1\n");
+    auto tree = document.GetSyntaxTree(false);
+    ASSERT_NE(tree, nullptr);
+    EXPECT_EQ(document.GetSyntaxTree(false), tree);
+
+    // 文本未变化时保留语法树
+    document.Update("local  a=1\n");
+    EXPECT_EQ(document.GetSyntaxTree(false), tree);
+
+    document.Update("local  b=2\n");
+    tree = document.GetSyntaxTree(false);
+    ASSERT_NE(tree, nullptr);
+    EXPECT_EQ(tree->GetFile().GetSource(), "local  b=2\n");
+
+    document.Update("local t = {\n");
+    EXPECT_EQ(document.GetSyntaxTree(false), nullptr);
+    EXPECT_EQ(document.GetSyntaxTree(false), nullptr);
+}
+
+TEST(LuaModule, handle) {
+    EXPECT_EQ(RunLua(R"(
+local cf = require "code_format"
+local ok, doc = cf.open("a.lua", "local  a=1\n")
+assert(ok and doc)
+local ok1, text1 = cf.format(doc)
+local ok2, text2 = cf.format(doc)
+assert(ok1 and ok2, text1)
+assert(text1 == "local a = 1\n", text1)
+assert(text1 == text2)
+local ok3, diagnostics = cf.diagnose_file(doc)
+assert(ok3 and #diagnostics > 0)
+
+-- 文件名和文本的调用方式与句柄结果相同
+local ok4, text4 = cf.format("a.lua", "local  a=1\n")
+assert(ok4 and text4 == text1)
+)"), "");
+}
+
+TEST(LuaModule, update) {
+    EXPECT_EQ(RunLua(R"(
+local cf = require "code_format"
+local ok, doc = cf.open("a.lua", "local  a=1\n")
+assert(ok)
+assert(select(2, cf.format(doc)) == "local a = 1\n")
+
+assert(cf.update(doc, "local  b  =  2\n"))
+local ok1, text = cf.format(doc)
+assert(ok1 and text == "local b = 2\n", text)
+
+assert(cf.update(doc, "local t = {\n"))
+assert(cf.format(doc) == false)
+
+assert(cf.update(doc, "local  c=3\n"))
+assert(select(2, cf.format(doc)) == "local c = 3\n")
+)"), "");
+}
+
+TEST(LuaModule, close) {
+    EXPECT_EQ(RunLua(R"(
+local cf = require "code_format"
+local ok, doc = cf.open("a.lua", "local  a=1\n")
+assert(ok)
+assert(cf.close(doc))
+-- 重复关闭无害
+assert(cf.close(doc))
+
+local ok1, err = cf.format(doc)
+assert(ok1 == false and err == "document is closed", err)
+local ok2, err2 = cf.update(doc, "local b = 2\n")
+assert(ok2 == false and err2 == "document is closed", err2)
+local ok3, err3 = cf.diagnose_file(doc)
+assert(ok3 == false and err3 == "document is closed", err3)
+
+-- 元表被隐藏, 无法手动调用 __gc
+assert(getmetatable(doc) == "code_format.document")
+doc = nil
+collectgarbage()
+
+local closed
+do
+    local _, scoped <close> = cf.open("b.lua", "local  x=1\n")
+    assert(select(2, cf.format(scoped)) == "local x = 1\n")
+    closed = scoped
+end
+assert(select(2, cf.format(closed)) == "document is closed")
+closed = nil
+collectgarbage()
+)"), "");
+}
+
+TEST(LuaModule, formatBatch) {
+    EXPECT_EQ(RunLua(R"(
+local cf = require "code_format"
+local files = {
+    { "a.lua", "local  a=1\n" },
+    { uri = "b.lua", text = "local t = {\n" },
+    { "c.lua", "local function f(a,b)\nreturn a+b\nend\n" },
+}
+local order = {}
+local ok, results = cf.format_batch(files, { insertSpaces = true, tabSize = 2 }, function(index, result)
+    order[#order + 1] = index
+    assert(result.uri == (files[index][1] or files[index].uri))
+end)
+assert(ok, results)
+assert(#results == 3)
+assert(table.concat(order, ",") == "1,2,3", table.concat(order, ","))
+
+for i, file in ipairs(files) do
+    local uri = file[1] or file.uri
+    local text = file[2] or file.text
+    local fileOk, expected = cf.format(uri, text, { insertSpaces = true, tabSize = 2 })
+    assert(results[i].uri == uri)
+    assert(results[i].ok == fileOk, uri)
+    if fileOk then
+        assert(results[i].text == expected, results[i].text)
+    end
+end
+-- 语法错误的文件不影响其他文件
+assert(results[2].ok == false and results[2].text == nil)
+assert(results[3].text == "local function f(a, b)\n  return a + b\nend\n", results[3].text)
+)"), "");
+}
+
+TEST(LuaModule, checkBatch) {
+    EXPECT_EQ(RunLua(R"(
+local cf = require "code_format"
+local files = {
+    { "a.lua", "local  a=1\n" },
+    { "b.lua", "local t = {\n" },
+    { "c.lua", "local b = 2\n" },
+}
+local order = {}
+local ok, results = cf.check_batch(files, function(index, result)
+    order[#order + 1] = index
+    assert(result.uri == files[index][1])
+end)
+assert(ok, results)
+assert(table.concat(order, ",") == "1,2,3", table.concat(order, ","))
+
+for i, file in ipairs(files) do
+    local fileOk, expected = cf.diagnose_file(file[1], file[2])
+    assert(results[i].ok == fileOk, file[1])
+    if fileOk then
+        local diagnostics = results[i].diagnostics
+        assert(#diagnostics == #expected, file[1])
+        for j, diagnostic in ipairs(diagnostics) do
+            assert(diagnostic.message == expected[j].message)
+            assert(diagnostic.range.start.line == expected[j].range.start.line)
+            assert(diagnostic.range.start.character == expected[j].range.start.character)
+        end
+    end
+end
+assert(#results[1].diagnostics > 0)
+assert(results[2].ok == false)
+assert(#results[3].diagnostics == 0)
+)"), "");
+}
+
+TEST(LuaModule, batchError) {
+    EXPECT_EQ(RunLua(R"(
+local cf = require "code_format"
+-- 格式错误的条目整体拒绝
+local ok, err = cf.format_batch({ { "a.lua", "local a = 1\n" }, 42 })
+assert(ok == false and err == "files[2] is not a table", err)
+ok, err = cf.check_batch({ { "a.lua" } })
+assert(ok == false and err == "files[1] needs uri and text", err)
+ok, err = cf.format_batch({ { uri = "a.lua", text = {} } })
+assert(ok == false and err == "files[1] needs uri and text", err)
+
+-- 回调出错时返回 false 和错误信息, 之后的回调不再调用
+local calls = 0
+ok, err = cf.format_batch({ { "a.lua", "local  a=1\n" }, { "b.lua", "local  b=2\n" } }, {}, function(index)
+    calls = calls + 1
+    error("callback failed")
+end)
+assert(ok == false and err:find("callback failed", 1, true), err)
+assert(calls == 1)
+ok, err = cf.check_batch({ { "a.lua", "local  a=1\n" } }, function()
+    error({})
+end)
+assert(ok == false and type(err) == "string", err)
+
+-- 空列表返回空结果
+local results
+ok, results = cf.format_batch({})
+assert(ok and #results == 0)
+)"), "");
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "TestHelper.h"
+#include "CodeFormatCore/Format/ParallelFormatBuilder.h"
+
+static std::string SerialFormat(LuaSyntaxTree &t, LuaStyle &style) {
+    FormatBuilder f(style);
+    return f.GetFormatResult(t);
+}
+
+static std::size_t ParallelChunkCount(const std::string &text, LuaStyle &style = TestHelper::DefaultStyle) {
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    ParallelFormatBuilder f(style, 4, 1);
+    EXPECT_EQ(f.GetFormatResult(t), SerialFormat(t, style));
+    return f.GetChunkCount();
+}
+
+TEST(ParallelFormat, safeBoundary) {
+    EXPECT_EQ(ParallelChunkCount("print(1)\nprint(2)\n\nprint(3)\n"), 3);
+    // 连续赋值对齐
+    EXPECT_EQ(ParallelChunkCount("local a = 1\nlocal bbb = 2\n\nlocal cc = 3\n"), 1);
+    EXPECT_EQ(ParallelChunkCount("local a = 1\nlocal bbb = 2\n\n\n\nlocal cc = 3\n"), 2);
+    // 同一行
+    EXPECT_EQ(ParallelChunkCount("local a = 1 local b = 2\n"), 1);
+    // 行尾注释对齐
+    EXPECT_EQ(ParallelChunkCount("print(1) -- one\nprint(123) -- two\n"), 1);
+    // format disable 到语句块结束
+    EXPECT_EQ(ParallelChunkCount("print(1)\n\n---@format disable\nprint( 2 )\n\nprint( 3 )\n"), 2);
+    EXPECT_EQ(ParallelChunkCount("---@format disable-next\nlocal t  =  1\n\nprint( 3 )\n"), 2);
+    EXPECT_EQ(ParallelChunkCount("local t = 1"), 1);
+    EXPECT_EQ(ParallelChunkCount(""), 1);
+}
+
+TEST(ParallelFormat, sameAsSerial) {
+    std::vector<std::string> paths;
+    std::filesystem::path root(TestHelper::ScriptBase);
+    TestHelper::CollectLuaFile(root / "grammar", paths, root);
+    paths.emplace_back("performance/10k_row_code.lua");
+
+    std::vector<LuaStyle> styles(3, TestHelper::DefaultStyle);
+    styles[1].align_continuous_assign_statement = ContinuousAlign::Always;
+    styles[1].insert_final_newline = false;
+    styles[1].end_of_line = EndOfLine::CRLF;
+    styles[1].detect_end_of_line = false;
+    styles[2].indent_style = IndentStyle::Tab;
+    styles[2].max_line_length = 60;
+    styles[2].layout_line_break = true;
+
+    for (auto &filePath: paths) {
+        auto p = TestHelper::GetParser(TestHelper::ReadFile(filePath));
+        LuaSyntaxTree t;
+        t.BuildTree(p);
+        for (auto &style: styles) {
+            ParallelFormatBuilder f(style, 4, 1);
+            EXPECT_EQ(f.GetFormatResult(t), SerialFormat(t, style)) << filePath;
+        }
+    }
+}
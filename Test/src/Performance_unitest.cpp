@@ -1,5 +1,18 @@
 #include <gtest/gtest.h>
 #include "TestHelper.h"
+#include "CodeFormatCore/Config/EditorconfigPattern.h"
+#include "CodeFormatCore/Config/GlobAutomaton.h"
+#include "CodeFormatCore/Diagnostic/DiagnosticBuilder.h"
+#include "CodeFormatCore/Format/ParallelFormatBuilder.h"
+#include "LuaParser/Lexer/LuaTokenTypeDetail.h"
+#include "Util/CompiledRegex.h"
+#include "Util/SymSpell/EditDistance.h"
+#include "Util/Utf8.h"
+#include <chrono>
+#include <map>
+#include <random>
+#include <regex>
+#include <set>
 
 TEST(FormatPerformance, 1k_row) {
     auto text = TestHelper::ReadFile("performance/1k_row_code.lua");
@@ -56,3 +69,424 @@ TEST(FormatPerformance, 100k_row) {
     auto formatted = b.GetFormatResult(t);
     EXPECT_TRUE(formatted.size() > 0);
 }
+
+TEST(FormatPerformance, 100k_row_position) {
+    auto text = TestHelper::ReadFile("performance/100k_row_code.lua");
+    EXPECT_TRUE(text.size() != 0);
+    auto p = TestHelper::GetParser(text);
+
+    EXPECT_FALSE(p.HasError());
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+
+    auto &file = t.GetFile();
+    std::size_t tableSum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto &n: t.GetSyntaxNodes()) {
+        tableSum += n.GetStartLine(t) + n.GetStartCol(t) + n.GetEndLine(t) + n.GetEndCol(t);
+    }
+    auto tableTime = std::chrono::steady_clock::now() - start;
+
+    std::size_t sourceSum = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto &n: t.GetSyntaxNodes()) {
+        auto startOffset = t.GetStartOffset(n.GetIndex());
+        auto endOffset = t.GetEndOffset(n.GetIndex());
+        sourceSum += file.GetLine(startOffset) + file.GetColumn(startOffset) + file.GetLine(endOffset) + file.GetColumn(endOffset);
+    }
+    auto sourceTime = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(tableSum, sourceSum);
+    std::cout << util::format("position of {} nodes: table {}ms, source {}ms",
+                              t.GetSyntaxNodes().size(),
+                              std::chrono::duration_cast<std::chrono::milliseconds>(tableTime).count(),
+                              std::chrono::duration_cast<std::chrono::milliseconds>(sourceTime).count())
+              << std::endl;
+}
+
+TEST(FormatPerformance, 100k_row_first_line_width) {
+    auto text = TestHelper::ReadFile("performance/100k_row_code.lua");
+    EXPECT_TRUE(text.size() != 0);
+    auto p = TestHelper::GetParser(text);
+
+    EXPECT_FALSE(p.HasError());
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+
+    std::size_t metricsSum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto &n: t.GetSyntaxNodes()) {
+        metricsSum += n.GetFirstLineWidth(t);
+    }
+    auto metricsTime = std::chrono::steady_clock::now() - start;
+
+    std::size_t textSum = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto &n: t.GetSyntaxNodes()) {
+        auto nodeText = n.GetText(t);
+        textSum += utf8::Utf8nLenAtFirstLine(nodeText.data(), nodeText.size());
+    }
+    auto textTime = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(metricsSum, textSum);
+    std::cout << util::format("first line width of {} nodes: metrics {}ms, text {}ms",
+                              t.GetSyntaxNodes().size(),
+                              std::chrono::duration_cast<std::chrono::milliseconds>(metricsTime).count(),
+                              std::chrono::duration_cast<std::chrono::milliseconds>(textTime).count())
+              << std::endl;
+}
+
+TEST(FormatPerformance, 10k_element_table_layout) {
+    // 单行的大表, 每个字段又是一个小表
+    auto makeTable = [](std::size_t count) {
+        std::string text = "local t = {";
+        for (std::size_t i = 0; i != count; i++) {
+            text.append(util::format("{{{}, \"a{}\", x.y{}}}, ", i, i, i));
+        }
+        text.append("}\n");
+        return text;
+    };
+
+    for (std::size_t count: {2500, 5000, 10000}) {
+        auto text = makeTable(count);
+        auto p = TestHelper::GetParser(text);
+        EXPECT_FALSE(p.HasError());
+        LuaSyntaxTree t;
+        t.BuildTree(p);
+
+        LuaStyle style;
+        auto start = std::chrono::steady_clock::now();
+        FormatBuilder greedy(style);
+        auto greedyResult = greedy.GetFormatResult(t);
+        auto greedyTime = std::chrono::steady_clock::now() - start;
+
+        style.layout_line_break = true;
+        start = std::chrono::steady_clock::now();
+        FormatBuilder layout(style);
+        auto layoutResult = layout.GetFormatResult(t);
+        auto layoutTime = std::chrono::steady_clock::now() - start;
+
+        for (auto line: string_util::Split(layoutResult, "\n")) {
+            EXPECT_LE(line.size(), style.max_line_length);
+        }
+        std::cout << util::format("table of {} elements: greedy {}ms, layout {}ms",
+                                  count,
+                                  std::chrono::duration_cast<std::chrono::milliseconds>(greedyTime).count(),
+                                  std::chrono::duration_cast<std::chrono::milliseconds>(layoutTime).count())
+                  << std::endl;
+    }
+}
+
+TEST(FormatPerformance, 100k_row_parallel) {
+    auto text = TestHelper::ReadFile("performance/100k_row_code.lua");
+    EXPECT_TRUE(text.size() != 0);
+    auto p = TestHelper::GetParser(text);
+
+    EXPECT_FALSE(p.HasError());
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+
+    auto start = std::chrono::steady_clock::now();
+    FormatBuilder serial(TestHelper::DefaultStyle);
+    auto serialResult = serial.GetFormatResult(t);
+    auto serialTime = std::chrono::steady_clock::now() - start;
+
+    for (std::size_t threadCount: {2, 4, 8}) {
+        start = std::chrono::steady_clock::now();
+        ParallelFormatBuilder parallel(TestHelper::DefaultStyle, threadCount);
+        auto parallelResult = parallel.GetFormatResult(t);
+        auto parallelTime = std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(parallelResult, serialResult);
+        std::cout << util::format("100k row: serial {}ms, {} threads {} chunks {}ms",
+                                  std::chrono::duration_cast<std::chrono::milliseconds>(serialTime).count(),
+                                  threadCount,
+                                  parallel.GetChunkCount(),
+                                  std::chrono::duration_cast<std::chrono::milliseconds>(parallelTime).count())
+                  << std::endl;
+    }
+}
+
+TEST(SpellPerformance, editDistance) {
+    auto text = TestHelper::ReadFile("performance/10k_row_code.lua");
+    ASSERT_TRUE(text.size() != 0);
+
+    std::set<std::string> identifierSet;
+    for (std::size_t i = 0; i < text.size();) {
+        if (std::isalpha(static_cast<unsigned char>(text[i])) || text[i] == '_') {
+            auto start = i;
+            while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) {
+                i++;
+            }
+            identifierSet.insert(text.substr(start, i - start));
+        } else {
+            i++;
+        }
+    }
+    std::vector<std::string> identifiers(identifierSet.begin(), identifierSet.end());
+    identifiers.emplace_back(80, 'a');
+    identifiers.emplace_back(std::string(40, 'a') + std::string(40, 'b'));
+    ASSERT_GT(identifiers.size(), 100);
+
+    // 每个标识符与随机拼写错误后的自身, 以及另一个随机标识符组成一对
+    std::mt19937 rng(42);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (auto &identifier: identifiers) {
+        auto typo = identifier;
+        auto edits = rng() % 4;
+        for (std::size_t k = 0; k != edits && !typo.empty(); k++) {
+            auto pos = rng() % typo.size();
+            switch (rng() % 4) {
+                case 0: typo.erase(pos, 1); break;
+                case 1: typo[pos] = static_cast<char>('a' + rng() % 26); break;
+                case 2: typo.insert(pos, 1, static_cast<char>('a' + rng() % 26)); break;
+                default: {
+                    if (pos + 1 < typo.size()) {
+                        std::swap(typo[pos], typo[pos + 1]);
+                    }
+                    break;
+                }
+            }
+        }
+        pairs.emplace_back(identifier, typo);
+        pairs.emplace_back(identifier, identifiers[rng() % identifiers.size()]);
+    }
+
+    EditDistance damerau(EditDistance::Algorithm::DamerauOSA);
+    EditDistance bitParallel(EditDistance::Algorithm::BitParallelOSA);
+    for (std::size_t maxEditDistance = 1; maxEditDistance <= 3; maxEditDistance++) {
+        for (auto &[lhs, rhs]: pairs) {
+            ASSERT_EQ(bitParallel.Compare(lhs, rhs, maxEditDistance), damerau.Compare(lhs, rhs, maxEditDistance))
+                    << lhs << " " << rhs << " " << maxEditDistance;
+        }
+    }
+
+    auto bench = [&](EditDistance &distance) {
+        long long sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round != 20; round++) {
+            for (auto &[lhs, rhs]: pairs) {
+                sum += distance.Compare(lhs, rhs, 2);
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_NE(sum, 0);
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    };
+    auto damerauTime = bench(damerau);
+    auto bitParallelTime = bench(bitParallel);
+    std::cout << pairs.size() * 20 << " comparisons, DamerauOSA: " << damerauTime << "us, BitParallelOSA: "
+              << bitParallelTime << "us" << std::endl;
+}
+
+TEST(DiagnosticPerformance, nameStyle_100k_row) {
+    auto text = TestHelper::ReadFile("performance/100k_row_code.lua");
+    EXPECT_TRUE(text.size() != 0);
+    auto p = TestHelper::GetParser(text);
+
+    EXPECT_FALSE(p.HasError());
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+
+    LuaDiagnosticStyle diagnosticStyle;
+    diagnosticStyle.name_style_check = true;
+    auto start = std::chrono::steady_clock::now();
+    DiagnosticBuilder d(TestHelper::DefaultStyle, diagnosticStyle);
+    d.NameStyleCheck(t);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto diagnostics = d.GetDiagnosticResults(t);
+    std::cout << "name style check: " << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+              << "ms, " << diagnostics.size() << " diagnostics" << std::endl;
+}
+
+TEST(DiagnosticPerformance, check_100k_row) {
+    auto text = TestHelper::ReadFile("performance/100k_row_code.lua");
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+
+    CodeSpellChecker spellChecker;
+    spellChecker.LoadDictionary(
+            (std::filesystem::path(TestHelper::ScriptBase) / ".." / ".." / "resources" / "dictionary.txt").string());
+    LuaDiagnosticStyle diagnosticStyle;
+
+    enum class Mode {
+        Sequential,
+        Fused,
+        Parallel
+    };
+    auto bench = [&](Mode mode) {
+        auto start = std::chrono::steady_clock::now();
+        DiagnosticBuilder d(TestHelper::DefaultStyle, diagnosticStyle);
+        if (mode != Mode::Sequential) {
+            d.SetParallelCheck(mode == Mode::Parallel);
+            d.Check(t, &spellChecker);
+        } else {
+            d.CodeStyleCheck(t);
+            d.SpellCheck(t, spellChecker);
+            d.NameStyleCheck(t);
+        }
+        auto size = d.GetDiagnosticResults(t).size();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::make_pair(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), size);
+    };
+
+    // 第一次运行预热拼写缓存
+    bench(Mode::Sequential);
+    auto [sequentialTime, sequentialCount] = bench(Mode::Sequential);
+    auto [fusedTime, fusedCount] = bench(Mode::Fused);
+    auto [parallelTime, parallelCount] = bench(Mode::Parallel);
+    EXPECT_EQ(sequentialCount, fusedCount);
+    EXPECT_EQ(sequentialCount, parallelCount);
+    std::cout << "diagnostic per file, sequential: " << sequentialTime << "ms, fused: " << fusedTime
+              << "ms, parallel: " << parallelTime << "ms, " << fusedCount << " diagnostics" << std::endl;
+}
+
+TEST(DiagnosticPerformance, namePattern_100k_row) {
+    auto text = TestHelper::ReadFile("performance/100k_row_code.lua");
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    std::vector<std::string_view> names;
+    for (auto &token: t.GetTokens()) {
+        if (token.GetTokenKind(t) == TK_NAME) {
+            names.push_back(token.GetText(t));
+        }
+    }
+    ASSERT_FALSE(names.empty());
+
+    for (std::string pattern: {"[a-z_][a-z0-9_]*", "(?:m_|_)?(\\w+)", "([A-Z]\\w*)(_[A-Z0-9]+)*|(\\w+)"}) {
+        std::regex re(pattern, std::regex_constants::ECMAScript);
+        CompiledRegex compiled;
+        ASSERT_TRUE(compiled.Compile(pattern));
+
+        std::size_t stdCount = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto name: names) {
+            std::match_results<std::string_view::const_iterator> mc;
+            if (std::regex_match(name.begin(), name.end(), mc, re)) {
+                stdCount += mc.size();
+            }
+        }
+        auto stdTime = std::chrono::steady_clock::now() - start;
+
+        std::size_t compiledCount = 0;
+        std::vector<std::string_view> groups;
+        start = std::chrono::steady_clock::now();
+        for (auto name: names) {
+            if (compiled.Match(name) && compiled.Match(name, groups)) {
+                compiledCount += groups.size();
+            }
+        }
+        auto compiledTime = std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(stdCount, compiledCount);
+        std::cout << "'" << pattern << "' on " << names.size() << " names, std::regex: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(stdTime).count() << "ms, CompiledRegex: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(compiledTime).count() << "ms" << std::endl;
+    }
+}
+
+TEST(FilePatternPerformance, editorconfigMatch) {
+    std::vector<std::string_view> patternTexts = {
+            "*", "*.lua", "**.lua", "Content/*.lua", "Content/aaa*.lua", "Content/**.lua",
+            "?abc.lua", "[abc]bc.lua", "[!a]bc.lua", "{test,lib}.lua", "test{1..3}.lua",
+    };
+    std::vector<EditorconfigPattern> patterns(patternTexts.size());
+    for (std::size_t i = 0; i != patternTexts.size(); i++) {
+        patterns[i].Compile(patternTexts[i]);
+    }
+
+    // 每个路径与所有模式匹配, 模拟大量文件对应几十个 section
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i != 2000; i++) {
+        paths.push_back(util::format("workspace/Content/module{}/sub/file{}.lua", i % 37, i));
+    }
+    GlobAutomaton sectionAutomaton;
+    for (std::size_t i = 0; i != patterns.size(); i++) {
+        patterns[i].AddTo(sectionAutomaton, i);
+    }
+    EXPECT_TRUE(sectionAutomaton.Build());
+
+    std::size_t interpretCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto &path: paths) {
+        for (auto &pattern: patterns) {
+            interpretCount += pattern.InterpretMatch(path);
+        }
+    }
+    auto interpretTime = std::chrono::steady_clock::now() - start;
+
+    std::size_t automatonCount = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto &path: paths) {
+        for (auto &pattern: patterns) {
+            automatonCount += pattern.Match(path);
+        }
+    }
+    auto automatonTime = std::chrono::steady_clock::now() - start;
+
+    std::size_t sectionCount = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto &path: paths) {
+        sectionCount += sectionAutomaton.Match(path).size();
+    }
+    auto sectionTime = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(automatonCount, interpretCount);
+    EXPECT_EQ(sectionCount, interpretCount);
+    std::cout << util::format("{} paths x {} patterns: interpret {}us, automaton {}us, merged automaton ({} states) {}us",
+                              paths.size(), patterns.size(),
+                              std::chrono::duration_cast<std::chrono::microseconds>(interpretTime).count(),
+                              std::chrono::duration_cast<std::chrono::microseconds>(automatonTime).count(),
+                              sectionAutomaton.GetStateCount(),
+                              std::chrono::duration_cast<std::chrono::microseconds>(sectionTime).count())
+              << std::endl;
+}
+
+TEST(FilePatternPerformance, editorconfigParse) {
+    std::string source = "root = true\n\n";
+    for (std::size_t i = 0; i != 2000; i++) {
+        source.append(util::format("# section {}\n[{{module{},lib{}}}/**.lua]\n", i, i, i));
+        source.append("indent_style = space\nindent_size = 4\nquote_style = single\nmax_line_length = 120\n");
+        source.append("continuation_indent = 4\nalign_call_args = true\nspace_around_table_field_list = true\n\n");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    LuaEditorConfig editorConfig{std::string(source)};
+    editorConfig.Parse();
+    auto scanTime = std::chrono::steady_clock::now() - start;
+
+    // 原先基于 std::regex 的实现
+    start = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::string, std::map<std::string, std::string>>> regexSections;
+    std::regex comment = std::regex(R"(^\s*(;|#))");
+    std::regex luaSection = std::regex(R"(^\s*\[\s*([^\]]+)\s*\]\s*$)");
+    std::regex valueRegex = std::regex(R"(^\s*([\w\d_]+)\s*=\s*(.+)$)");
+    for (auto &lineView: string_util::Split(source, "\n")) {
+        std::string line(lineView);
+        std::smatch m;
+        if (std::regex_search(line, comment)) {
+            continue;
+        }
+        if (std::regex_search(line, m, luaSection)) {
+            regexSections.emplace_back(m.str(1), std::map<std::string, std::string>());
+            continue;
+        }
+        if (!regexSections.empty() && std::regex_search(line, m, valueRegex)) {
+            regexSections.back().second.insert({m.str(1), std::string(string_util::TrimSpace(m.str(2)))});
+        }
+    }
+    auto regexTime = std::chrono::steady_clock::now() - start;
+
+    auto &sections = editorConfig.GetSections();
+    ASSERT_EQ(sections.size(), regexSections.size());
+    for (std::size_t i = 0; i != sections.size(); i++) {
+        EXPECT_EQ(std::string(sections[i].Pattern.GetPattern()), regexSections[i].first);
+        EXPECT_EQ(sections[i].ConfigMap.size(), regexSections[i].second.size());
+    }
+    std::cout << util::format("parse {} sections: scanner {}us, regex {}us", sections.size(),
+                              std::chrono::duration_cast<std::chrono::microseconds>(scanTime).count(),
+                              std::chrono::duration_cast<std::chrono::microseconds>(regexTime).count())
+              << std::endl;
+}
@@ -1,5 +1,20 @@
 #include <gtest/gtest.h>
 #include "TestHelper.h"
+#include "CodeFormatCore/RangeFormat/RangeFormatBuilder.h"
+
+static std::string RangeFormatText(const std::string &text, std::size_t startLine, std::size_t endLine, FormatRange *replaceRange = nullptr) {
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    FormatRange range(startLine, endLine);
+    range.StartCol = 0;
+    RangeFormatBuilder f(TestHelper::DefaultStyle, range);
+    auto result = f.GetFormatResult(t);
+    if (replaceRange) {
+        *replaceRange = f.GetReplaceRange();
+    }
+    return result;
+}
 
 TEST(RangeFormat, all_range) {
     EXPECT_TRUE(TestHelper::TestRangeFormatted(0, 100, R"(
@@ -57,4 +72,101 @@ local t = {
 )",R"(
     a = 123
 )"));
-}
\ No newline at end of file
+}
+
+TEST(RangeFormat, source_indent) {
+    std::string text = "local function f()\n"
+                       "  if a then\n"
+                       "        local t  =  123\n"
+                       "  end\n"
+                       "end\n";
+    EXPECT_EQ(RangeFormatText(text, 2, 2), "        local t = 123\n");
+    EXPECT_EQ(RangeFormatText(text, 1, 3), "  if a then\n      local t = 123\n  end\n");
+}
+
+TEST(RangeFormat, unformatted_source_indent) {
+    // 缩进从原文推导, 未格式化的代码中范围格式化的结果与全文格式化不同
+    std::string text = "local function f()\n"
+                       "  if a then\n"
+                       "  b()\n"
+                       "  end\n"
+                       "end\n";
+    EXPECT_EQ(RangeFormatText(text, 1, 3), "  if a then\n      b()\n  end\n");
+    EXPECT_EQ(RangeFormatText(text, 2, 2), "  b()\n");
+
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    FormatBuilder f(TestHelper::DefaultStyle);
+    EXPECT_EQ(f.GetFormatResult(t), "local function f()\n"
+                                    "    if a then\n"
+                                    "        b()\n"
+                                    "    end\n"
+                                    "end\n");
+}
+
+TEST(RangeFormat, multiline_token_start) {
+    // 范围从行首的长字符串中间开始时, 替换范围从行首开始, 避免重复缩进
+    std::string text = "local t = {\n"
+                       "    [[\n"
+                       "  a\n"
+                       "]],\n"
+                       "}\n";
+    FormatRange replaceRange;
+    EXPECT_EQ(RangeFormatText(text, 2, 3, &replaceRange), "    [[\n  a\n]],\n");
+    EXPECT_EQ(replaceRange.StartLine, 1);
+    EXPECT_EQ(replaceRange.StartCol, 0);
+}
+
+TEST(RangeFormat, same_as_format) {
+    std::vector<std::string> paths;
+    std::filesystem::path root(TestHelper::ScriptBase);
+    std::filesystem::path dir = root / "grammar";
+    TestHelper::CollectLuaFile(dir, paths, root);
+    // 范围两端的空行不会输出
+    auto trimLines = [](std::string_view text) {
+        auto start = text.find_first_not_of("\r\n");
+        auto end = text.find_last_not_of("\r\n");
+        return start == std::string_view::npos ? std::string_view() : text.substr(start, end - start + 1);
+    };
+    std::size_t comparedCount = 0;
+    std::size_t skippedFileCount = 0;
+    for (auto &filePath: paths) {
+        // 尾随注释的对齐在一次格式化后可能还会变化, 反复格式化直到结果稳定作为比较基准
+        auto text = TestHelper::ReadFile(filePath);
+        bool stable = false;
+        for (int i = 0; i != 4 && !stable; i++) {
+            auto p = TestHelper::GetParser(text);
+            LuaSyntaxTree t;
+            t.BuildTree(p);
+            FormatBuilder f(TestHelper::DefaultStyle);
+            auto formattedText = f.GetFormatResult(t);
+            stable = formattedText == text;
+            text = std::move(formattedText);
+        }
+        if (!stable) {
+            skippedFileCount++;
+            continue;
+        }
+
+        auto formatted = TestHelper::GetParser(text);
+        LuaSyntaxTree formattedTree;
+        formattedTree.BuildTree(formatted);
+        auto &file = formattedTree.GetFile();
+        // 相邻的三行范围首尾相接, 覆盖文件的每一行
+        for (std::size_t line = 0; line < file.GetTotalLine(); line += 3) {
+            FormatRange range(line, line + 2);
+            range.StartCol = 0;
+            RangeFormatBuilder rangeBuilder(TestHelper::DefaultStyle, range);
+            auto result = rangeBuilder.GetFormatResult(formattedTree);
+            auto replaceRange = rangeBuilder.GetReplaceRange();
+            auto startOffset = file.GetOffset(replaceRange.StartLine, replaceRange.StartCol);
+            auto endOffset = std::min(file.GetOffset(replaceRange.EndLine + 1, 0), text.size());
+            auto expected = trimLines(std::string_view(text).substr(startOffset, endOffset - startOffset));
+            EXPECT_EQ(trimLines(result), expected) << filePath << ":" << line;
+            comparedCount++;
+        }
+    }
+    EXPECT_LE(skippedFileCount, paths.size() / 4);
+    EXPECT_GE(comparedCount, 5000);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "ResultCache.h"
+#include "CodeFormatCore/Config/LuaEditorConfig.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+std::string CachePath(std::string_view name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::string ReadBinary(const std::string &path) {
+    std::ifstream fin(path, std::ios::binary);
+    std::stringstream s;
+    s << fin.rdbuf();
+    return s.str();
+}
+
+void WriteBinary(const std::string &path, std::string_view content) {
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    fout.write(content.data(), content.size());
+}
+
+std::uint64_t OptionHash(std::string_view editorconfig, std::string_view path) {
+    LuaEditorConfig config{std::string(editorconfig)};
+    config.Parse();
+    auto hash = ResultCache::Hash("LuaStyle");
+    for (auto configMap: config.GetConfigMaps(path)) {
+        hash = ResultCache::ConfigHash(*configMap, hash);
+    }
+    return hash;
+}
+
+CacheEntry MakeEntry() {
+    CacheEntry entry;
+    entry.Ok = false;
+    entry.Truncated = true;
+    auto &d = entry.Diagnostics.emplace_back();
+    d.StartLine = 1;
+    d.StartChar = 2;
+    d.EndLine = 3;
+    d.EndChar = 4;
+    d.Type = DiagnosticType::Indent;
+    d.Message = "expected 4 whitespace indent";
+    return entry;
+}
+}// namespace
+
+TEST(ResultCache, hit) {
+    auto path = CachePath("CodeFormatTest-hit.cache");
+    std::string text = "local a = 1\n";
+    auto option = OptionHash("[*.lua]\nindent_size = 4\n", "a.lua");
+    {
+        ResultCache cache(path);
+        auto key = cache.MakeKey(CacheKind::Check, text, option);
+        EXPECT_EQ(cache.Find(key), nullptr);
+        cache.Put(key, MakeEntry());
+        ASSERT_TRUE(cache.Save(false));
+    }
+
+    ResultCache cache(path);
+    ASSERT_TRUE(cache.Load());
+    auto entry = cache.Find(cache.MakeKey(CacheKind::Check, text, option));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_FALSE(entry->Ok);
+    EXPECT_TRUE(entry->Truncated);
+    ASSERT_EQ(entry->Diagnostics.size(), 1);
+    auto &d = entry->Diagnostics.front();
+    EXPECT_EQ(d.StartLine, 1);
+    EXPECT_EQ(d.StartChar, 2);
+    EXPECT_EQ(d.EndLine, 3);
+    EXPECT_EQ(d.EndChar, 4);
+    EXPECT_EQ(d.Type, DiagnosticType::Indent);
+    EXPECT_EQ(d.Message, "expected 4 whitespace indent");
+    EXPECT_EQ(cache.GetHitCount(), 1);
+
+    // 同样的内容和选项, 不同种类的结果互不影响
+    EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, text, option)), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(ResultCache, miss) {
+    auto path = CachePath("CodeFormatTest-miss.cache");
+    std::string editorconfig = "[*.lua]\nindent_size = 4\n[*.md]\nindent_size = 2\n";
+    auto option = OptionHash(editorconfig, "a.lua");
+    ResultCache cache(path);
+    cache.Put(cache.MakeKey(CacheKind::Format, "local a = 1\n", option), MakeEntry());
+
+    EXPECT_NE(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", option)), nullptr);
+    EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 2\n", option)), nullptr);
+    EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n\n", option)), nullptr);
+
+    // 不匹配该文件的 section 不影响结果
+    EXPECT_EQ(OptionHash("[*.lua]\nindent_size = 4\n[*.md]\nindent_size = 8\n", "a.lua"), option);
+    auto styleChanged = OptionHash("[*.lua]\nindent_size = 2\n[*.md]\nindent_size = 2\n", "a.lua");
+    EXPECT_NE(styleChanged, option);
+    EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", styleChanged)), nullptr);
+    auto optionAdded = OptionHash("[*.lua]\nindent_size = 4\nquote_style = single\n", "a.lua");
+    EXPECT_NE(optionAdded, option);
+    EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", optionAdded)), nullptr);
+    EXPECT_EQ(cache.GetHitCount(), 1);
+    EXPECT_EQ(cache.GetMissCount(), 4);
+}
+
+TEST(ResultCache, version) {
+    auto path = CachePath("CodeFormatTest-version.cache");
+    {
+        ResultCache cache(path);
+        cache.Put(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0), MakeEntry());
+        ASSERT_TRUE(cache.Save(false));
+    }
+
+    auto content = ReadBinary(path);
+    auto pos = content.find(CodeFormatVersion);
+    ASSERT_NE(pos, std::string::npos);
+    auto last = pos + CodeFormatVersion.size() - 1;
+    content[last] = content[last] == 'x' ? 'y' : 'x';
+    WriteBinary(path, content);
+
+    ResultCache cache(path);
+    EXPECT_FALSE(cache.Load());
+    EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0)), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(ResultCache, corrupt) {
+    auto path = CachePath("CodeFormatTest-corrupt.cache");
+    {
+        ResultCache cache(path);
+        cache.Put(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0), MakeEntry());
+        cache.Put(cache.MakeKey(CacheKind::Format, "local b = 2\n", 0), MakeEntry());
+        ASSERT_TRUE(cache.Save(false));
+    }
+    auto content = ReadBinary(path);
+
+    // 截断在最后一条记录中间, 已读出的记录也不采用
+    WriteBinary(path, content.substr(0, content.size() - 3));
+    {
+        ResultCache cache(path);
+        EXPECT_FALSE(cache.Load());
+        EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0)), nullptr);
+        EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local b = 2\n", 0)), nullptr);
+    }
+
+    // 诊断类型超出范围
+    auto typeChanged = content;
+    auto messagePos = typeChanged.find("expected 4 whitespace indent");
+    ASSERT_NE(messagePos, std::string::npos);
+    typeChanged[messagePos - sizeof(std::uint32_t) - 1] = static_cast<char>(0xff);
+    WriteBinary(path, typeChanged);
+    {
+        ResultCache cache(path);
+        EXPECT_FALSE(cache.Load());
+        EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0)), nullptr);
+    }
+
+    WriteBinary(path, "not a cache file");
+    {
+        ResultCache cache(path);
+        EXPECT_FALSE(cache.Load());
+        // 损坏的文件会被覆盖
+        cache.Put(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0), MakeEntry());
+        ASSERT_TRUE(cache.Save(false));
+    }
+
+    ResultCache cache(path);
+    EXPECT_TRUE(cache.Load());
+    EXPECT_NE(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0)), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(ResultCache, prune) {
+    auto path = CachePath("CodeFormatTest-prune.cache");
+    {
+        ResultCache cache(path);
+        cache.Put(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0), MakeEntry());
+        cache.Put(cache.MakeKey(CacheKind::Format, "local b = 2\n", 0), MakeEntry());
+        cache.Put(cache.MakeKey(CacheKind::Check, "local a = 1\n", 0), MakeEntry());
+        ASSERT_TRUE(cache.Save(false));
+    }
+    {
+        // 只做了格式化, 检查结果保持不变
+        ResultCache cache(path);
+        ASSERT_TRUE(cache.Load());
+        EXPECT_NE(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0)), nullptr);
+        ASSERT_TRUE(cache.Save(true));
+    }
+
+    ResultCache cache(path);
+    ASSERT_TRUE(cache.Load());
+    EXPECT_NE(cache.Find(cache.MakeKey(CacheKind::Format, "local a = 1\n", 0)), nullptr);
+    EXPECT_EQ(cache.Find(cache.MakeKey(CacheKind::Format, "local b = 2\n", 0)), nullptr);
+    EXPECT_NE(cache.Find(cache.MakeKey(CacheKind::Check, "local a = 1\n", 0)), nullptr);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,69 @@
+#include "TestHelper.h"
+#include "Util/SymSpell/SymSpell.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <gtest/gtest.h>
+
+static std::string DictionaryPath() {
+    return (std::filesystem::path(TestHelper::ScriptBase) / ".." / ".." / "resources" / "dictionary.txt").string();
+}
+
+static std::vector<std::pair<std::string, int>> SortedSuggests(std::vector<SuggestItem> &&items) {
+    std::vector<std::pair<std::string, int>> result;
+    for (auto &item: items) {
+        result.emplace_back(item.Term, item.Distance);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(SymSpell, precompiledIndex) {
+    auto indexPath = (std::filesystem::temp_directory_path() / "CodeFormatTest_dictionary.idx").string();
+
+    auto start = std::chrono::steady_clock::now();
+    SymSpell text(SymSpell::Strategy::LazyLoaded);
+    ASSERT_TRUE(text.LoadWordDictionary(DictionaryPath()));
+    text.LookUp("helo");
+    auto textTime = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(text.SaveDictionary(indexPath));
+
+    start = std::chrono::steady_clock::now();
+    SymSpell index(SymSpell::Strategy::LazyLoaded);
+    ASSERT_TRUE(index.LoadDictionary(indexPath));
+    index.LookUp("helo");
+    auto indexTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "text dictionary first lookup: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(textTime).count() << "ms, "
+              << "precompiled index first lookup: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(indexTime).count() << "ms" << std::endl;
+
+    for (std::string word: {"the", "function", "table", "local", "hello", "a", "zz"}) {
+        EXPECT_EQ(index.IsCorrectWord(word), text.IsCorrectWord(word)) << word;
+    }
+
+    for (std::string word: {"helo", "fucntion", "tabel", "locl", "recieve", "adress", "paramter", "xyzzyq", "ab",
+                            "thier", "stirng", "numbr", "retrun", "initalize", "configration"}) {
+        EXPECT_EQ(SortedSuggests(index.LookUp(word)), SortedSuggests(text.LookUp(word))) << word;
+    }
+
+    // 不是索引文件或文件不完整
+    SymSpell invalid(SymSpell::Strategy::LazyLoaded);
+    EXPECT_FALSE(invalid.LoadDictionary(DictionaryPath()));
+    {
+        std::ifstream fin(indexPath, std::ios::binary);
+        std::string head(200, '\0');
+        fin.read(head.data(), static_cast<std::streamsize>(head.size()));
+        std::ofstream fout(indexPath, std::ios::binary | std::ios::trunc);
+        fout.write(head.data(), static_cast<std::streamsize>(head.size()));
+    }
+    EXPECT_FALSE(invalid.LoadDictionary(indexPath));
+    // 参数不一致
+    SymSpell other(SymSpell::Strategy::LazyLoaded, 1);
+    ASSERT_TRUE(text.SaveDictionary(indexPath));
+    EXPECT_FALSE(other.LoadDictionary(indexPath));
+
+    std::filesystem::remove(indexPath);
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "TestHelper.h"
+#include "CodeFormatCore/Format/VerifyFormatBuilder.h"
+
+static std::string FormatText(const std::string &text, LuaStyle &style) {
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    FormatBuilder f(style);
+    return f.GetFormatResult(t);
+}
+
+static bool VerifyText(const std::string &text, LuaStyle &style) {
+    auto p = TestHelper::GetParser(text);
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    VerifyFormatBuilder f(style);
+    return f.IsFormatted(t);
+}
+
+TEST(VerifyFormat, basic) {
+    EXPECT_TRUE(VerifyText("local t = 123\n", TestHelper::DefaultStyle));
+    EXPECT_FALSE(VerifyText("local t = 123", TestHelper::DefaultStyle));
+    EXPECT_FALSE(VerifyText("local t = 123\n\n", TestHelper::DefaultStyle));
+    EXPECT_FALSE(VerifyText("local t = 123 \n", TestHelper::DefaultStyle));
+    EXPECT_FALSE(VerifyText("local t =  123\n", TestHelper::DefaultStyle));
+    EXPECT_TRUE(VerifyText("local t = 123\n\nlocal c = 456\n", TestHelper::DefaultStyle));
+
+    auto p = TestHelper::GetParser("local t = 1\nlocal c  = 2\n");
+    LuaSyntaxTree t;
+    t.BuildTree(p);
+    VerifyFormatBuilder f(TestHelper::DefaultStyle);
+    EXPECT_FALSE(f.IsFormatted(t));
+    EXPECT_EQ(f.GetDiffOffset(), 20);
+}
+
+TEST(VerifyFormat, sameAsFormat) {
+    std::vector<std::string> paths;
+    std::filesystem::path root(TestHelper::ScriptBase);
+    std::filesystem::path dir = root / "grammar";
+    TestHelper::CollectLuaFile(dir, paths, root);
+    for (auto &filePath: paths) {
+        auto text = TestHelper::ReadFile(filePath);
+        auto formatted = FormatText(text, TestHelper::DefaultStyle);
+        EXPECT_EQ(VerifyText(text, TestHelper::DefaultStyle), formatted == text) << filePath;
+        EXPECT_EQ(VerifyText(formatted, TestHelper::DefaultStyle), FormatText(formatted, TestHelper::DefaultStyle) == formatted) << filePath;
+    }
+}
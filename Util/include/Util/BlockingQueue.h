@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/*
+ * 多生产者多消费者队列
+ * capacity 不为 0 时队列满则 Push 阻塞, 用于限制流水线中积压的数据量
+ * 生产者全部结束后调用 Close, 消费者取完剩余元素后 Pop 返回 false
+ */
+template<class T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(std::size_t capacity = 0) : _capacity(capacity), _closed(false) {}
+
+    void Push(T &&value) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_capacity != 0) {
+                _notFull.wait(lock, [this] { return _queue.size() < _capacity; });
+            }
+            _queue.push_back(std::move(value));
+        }
+        _notEmpty.notify_one();
+    }
+
+    bool Pop(T &value) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _notEmpty.wait(lock, [this] { return !_queue.empty() || _closed; });
+            if (_queue.empty()) {
+                return false;
+            }
+            value = std::move(_queue.front());
+            _queue.pop_front();
+        }
+        if (_capacity != 0) {
+            _notFull.notify_one();
+        }
+        return true;
+    }
+
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _notEmpty.notify_all();
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _notEmpty;
+    std::condition_variable _notFull;
+    std::deque<T> _queue;
+    std::size_t _capacity;
+    bool _closed;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * 线性时间的正则匹配, 用于命名规范的 pattern 规则
+ * 正则先编译成 Thompson NFA, 整体是否匹配用按需构造的 DFA 判断, 需要捕获组时再用带记忆的回溯计算
+ * 只支持 ECMAScript 语法的一个子集:
+ *   字符, '.', 转义 \w \W \d \D \s \S \t \n \r \f \v 和转义的标点, [...] 和 [^...] 字符类
+ *   (...) 捕获组, (?:...), '|', 贪婪量词 * + ? {n} {n,} {n,m}, 开头的 '^' 和结尾的 '$'
+ * 其它语法 (反向引用, 断言, 非贪婪量词等) 编译失败, 调用方应退回 std::regex
+ * 匹配总是要求整个字符串匹配, 与 std::regex_match 相同
+ */
+class CompiledRegex {
+public:
+    CompiledRegex();
+
+    CompiledRegex(const CompiledRegex &) = delete;
+
+    CompiledRegex &operator=(const CompiledRegex &) = delete;
+
+    // 语法不在支持范围内时返回 false
+    bool Compile(std::string_view pattern);
+
+    // 捕获组数量, 不含整体匹配
+    std::size_t GetGroupCount() const;
+
+    bool Match(std::string_view text);
+
+    // groups[0] 是整体匹配, groups[i] 是第 i 个捕获组, 没有参与匹配的组为空
+    bool Match(std::string_view text, std::vector<std::string_view> &groups);
+
+private:
+    using ByteSet = std::bitset<256>;
+
+    enum class OpCode {
+        Byte,
+        Split,
+        Jump,
+        Save,
+        Match
+    };
+
+    // Split 优先走 X, 其次走 Y
+    struct Inst {
+        OpCode Op = OpCode::Match;
+        std::uint32_t X = 0;
+        std::uint32_t Y = 0;
+        std::uint32_t SetIndex = 0;
+    };
+
+    struct Node;
+
+    class Parser;
+
+    void Emit(const Node &node);
+
+    std::uint32_t Append(Inst inst);
+
+    void Closure(std::uint32_t pc, std::vector<std::uint32_t> &states, std::vector<bool> &visited) const;
+
+    int AddDfaState(std::vector<std::uint32_t> &&states);
+
+    int Step(int dfaState, unsigned char c);
+
+    std::vector<Inst> _program;
+    std::vector<ByteSet> _sets;
+    std::size_t _groupCount;
+
+    // 按需构造的 DFA, 每个状态是排好序的 NFA 指令集合
+    static constexpr int DfaUnknown = -2;
+    static constexpr int DfaDead = -1;
+    static constexpr std::size_t MaxDfaStates = 256;
+
+    struct DfaState {
+        std::vector<std::uint32_t> NfaStates;
+        bool Accept = false;
+        std::array<int, 256> Next;
+    };
+
+    std::vector<DfaState> _dfaStates;
+
+    struct BacktrackJob {
+        std::uint32_t Pc;
+        // 恢复捕获时 Pos 是旧值
+        std::size_t Pos;
+        bool Restore;
+    };
+
+    // 回溯时复用的缓冲区
+    std::vector<std::uint64_t> _visited;
+    std::vector<std::size_t> _caps;
+    std::vector<BacktrackJob> _stack;
+
+    // 同一个规则可能被多个线程共享, DFA 缓存和回溯缓冲区都要加锁
+    std::mutex _mutex;
+};
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "Util/IgnoreMatcher.h"
 #include <filesystem>
+#include <functional>
 #include <set>
 #include <string>
 #include <string_view>
@@ -16,16 +18,43 @@ public:
 
     void AddFindFile(const std::string &fileName);
 
+    // 通配符匹配相对路径, '*' 可以跨越 '/'
     void AddignorePatterns(const std::string &pattern);
 
+    // gitignore 语法, 被忽略的目录不会进入遍历
+    void AddGitignorePatterns(const std::string &line);
+
+    // threadCount 为 0 时使用硬件线程数
+    void SetThreadCount(std::size_t threadCount);
+
+    // 结果按路径排序
     std::vector<std::string> FindFiles();
 
+    // 多个线程并发遍历目录, 每找到一个文件就回调一次, onFile 可能在多个线程中同时被调用
+    // 遍历或回调抛出的异常会在所有线程结束后重新抛出
+    void FindFiles(const std::function<void(std::string &&)> &onFile);
+
+    // 最近一次遍历实际进入的目录数
+    std::size_t GetVisitedDirectoryCount() const;
+
 private:
-    void CollectFile(std::filesystem::path directoryPath, std::vector<std::string> &paths);
+    struct DirectoryTask {
+        std::filesystem::path Path;
+        // 相对于根目录, 以 '/' 分隔
+        std::string RelativePath;
+    };
+
+    void CollectFile(const DirectoryTask &task, std::vector<DirectoryTask> &subDirectories,
+                     const std::function<void(std::string &&)> &onFile);
+
+    bool MatchIgnorePatterns(std::string_view relativePath) const;
 
     std::filesystem::path _root;
     std::set<std::string> _ignoreDirectory;
     std::set<std::string> _findExtension;
     std::set<std::string> _findFile;
     std::vector<std::string> _ignorePatterns;
+    IgnoreMatcher _ignoreMatcher;
+    std::size_t _threadCount;
+    std::size_t _visitedDirectoryCount;
 };
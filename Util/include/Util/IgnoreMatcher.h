@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * 按 gitignore 语义匹配相对路径
+ * 支持注释, '!' 取反, 以 '/' 结尾只匹配目录, 含 '/' 的模式锚定到根目录, 否则匹配任意深度的文件名
+ * 通配符 '*' '?' '[...]' 不跨越 '/', '**' 作为完整的路径片段时匹配零个或多个目录
+ * 多条规则同时匹配时以最后一条为准
+ */
+class IgnoreMatcher {
+public:
+    IgnoreMatcher();
+
+    void AddPattern(std::string_view line);
+
+    bool Empty() const;
+
+    // 只判断路径本身, 调用方需保证祖先目录没有被忽略, 用于遍历时的剪枝
+    bool Match(std::string_view relativePath, bool isDirectory) const;
+
+    // 祖先目录被忽略时路径同样被忽略
+    bool IsIgnored(std::string_view relativePath, bool isDirectory) const;
+
+    static bool GlobMatch(std::string_view pattern, std::string_view path);
+
+private:
+    struct Rule {
+        std::string Pattern;
+        bool Negate = false;
+        bool DirectoryOnly = false;
+        bool Anchored = false;
+    };
+
+    std::vector<Rule> _rules;
+};
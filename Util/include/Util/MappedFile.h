@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/*
+ * 只读映射整个文件, 数据在对象析构前有效
+ */
+class MappedFile {
+public:
+    MappedFile();
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool Open(const std::string &path);
+
+    void Close();
+
+    std::string_view GetData() const;
+
+private:
+    const char *_data;
+    std::size_t _size;
+#ifdef _WIN32
+    void *_file;
+    void *_mapping;
+#endif
+};
@@ -6,7 +6,13 @@
 
 class EditDistance {
 public:
-    explicit EditDistance();
+    enum class Algorithm {
+        DamerauOSA,
+        // 较短的词不超过 64 字节时使用位并行算法, 否则退回 DamerauOSA
+        BitParallelOSA
+    };
+
+    explicit EditDistance(Algorithm algorithm = Algorithm::BitParallelOSA);
 
     int Compare(std::string_view lhs, std::string_view rhs, std::size_t maxEditDistance);
 
@@ -23,11 +23,12 @@
 
 #include "EditDistance.h"
 #include "SuggestItem.h"
-#include <map>
+#include "SymSpellIndex.h"
+#include "Util/MappedFile.h"
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 class SymSpell {
@@ -48,41 +49,88 @@ public:
 
     bool CreateDictionaryEntry(const std::string &key, int count);
 
-    bool IsCorrectWord(const std::string& word) const;
+    // 加载 SaveDictionary 生成的索引文件, 文件被映射到内存, 不需要再生成删除串
+    // 索引的最大编辑距离与前缀长度必须与当前对象一致
+    bool LoadDictionary(const std::string &path);
 
-    std::vector<SuggestItem> LookUp(const std::string &input);
+    // 把通过文本加载的词生成为索引文件
+    bool SaveDictionary(const std::string &path);
 
-    std::vector<SuggestItem> LookUp(const std::string &input, int maxEditDistance);
+    bool IsCorrectWord(std::string_view word) const;
+
+    // 除了返回的建议之外, 查询过程不分配堆内存
+    std::vector<SuggestItem> LookUp(std::string_view input);
+
+    std::vector<SuggestItem> LookUp(std::string_view input, int maxEditDistance);
 
 private:
-    bool BuildDeletesWords(const std::string &key);
+    // 词存放在连续的字符串池中, 用 32 位 id 引用
+    struct WordEntry {
+        std::uint32_t Offset;
+        std::uint32_t Length;
+        int Count;
+    };
 
-    bool BuildAllDeletesWords();
+    // 同一删除串 hash 下的词 id 以链表串起, Head 和 Next 都是节点下标 + 1, 0 表示空
+    struct DeleteBucket {
+        std::uint32_t Hash;
+        std::uint32_t Head;
+        std::uint32_t Tail;
+    };
+
+    struct DeleteNode {
+        std::uint32_t WordId;
+        std::uint32_t Next;
+    };
+
+    static constexpr std::uint32_t NotFound = 0xffffffff;
+
+    std::uint32_t FindWord(std::string_view word) const;
 
-    std::unordered_set<std::string> EditsPrefix(std::string_view key);
+    std::string_view GetWord(std::uint32_t id) const;
 
-    void Edits(std::string_view word, int editDistance, std::unordered_set<std::string> &deleteWord);
+    std::uint32_t AddWord(std::string_view word, int count);
 
-    int GetStringHash(std::string_view source);
+    void AddDelete(std::uint32_t deleteHash, std::uint32_t wordId);
+
+    const DeleteBucket *FindDeleteBucket(std::uint32_t deleteHash) const;
+
+    bool BuildDeletesWords(std::uint32_t wordId);
+
+    bool BuildAllDeletesWords();
+
+    // 生成前缀的所有删除串, 输出去重后的 hash
+    void EditsPrefix(std::string_view key, std::vector<std::uint32_t> &deleteHashes);
 
     bool DeleteInSuggestionPrefix(std::string_view deleteSuggest, std::size_t deleteLen, std::string_view suggestion,
                                   std::size_t suggestionLen);
 
     std::size_t _prefixLength;//prefix length  5..7
-    uint32_t _compactMask;
     // DistanceAlgorithm distanceAlgorithm = DistanceAlgorithm::DamerauOSADistance;
     std::size_t _maxDictionaryWordLength;//maximum dictionary term length
 
     int _maxDictionaryEditDistance;
+
+    struct MappedIndex {
+        std::unique_ptr<MappedFile> File;
+        SymSpellIndex Index;
+    };
+    std::vector<MappedIndex> _indexes;
+    // Dictionary of unique correct spelling words, and the frequency count for each word.
+    // 词表是线性探测的开放寻址哈希表, 槽位存放 id + 1
+    std::string _wordPool;
+    std::vector<WordEntry> _words;
+    std::vector<std::uint32_t> _wordSlots;
     // Dictionary that contains a mapping of lists of suggested correction words to the hashCodes
     // of the original words and the deletes derived from them. Collisions of hashCodes is tolerated,
     // because suggestions are ultimately verified via an edit distance function.
-    // A list of suggestions might have a single suggestion, or multiple suggestions.
-    std::map<int, std::vector<std::string>> _deletes;
-    // Dictionary of unique correct spelling words, and the frequency count for each word.
-    std::unordered_map<std::string, int> _words;
+    std::vector<DeleteBucket> _deleteBuckets;
+    std::size_t _deleteBucketUsed;
+    std::vector<DeleteNode> _deleteNodes;
+    // 已经生成过删除串的词数, 词 id 连续递增
+    std::size_t _builtWordCount;
 
     EditDistance _editDistance;
 
     Strategy _strategy;
-};
+};
\ No newline at end of file
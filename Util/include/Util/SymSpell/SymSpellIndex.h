@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+ * 预先生成的 SymSpell 删除索引, 可以直接 mmap 后使用, 加载时只检查文件头
+ * 文件布局: Header | Word[WordCount] | uint32 词表槽位 | DeleteBucket[] | uint32 候选词 id | 字符串池
+ * 词按字典序排列, id 即排序后的下标, 词表和删除表都是线性探测的开放寻址哈希表
+ * 所有数字都是本机字节序的 32 位整数, ByteOrder 不一致时拒绝加载
+ */
+class SymSpellIndex {
+public:
+    static constexpr std::uint32_t Version = 1;
+
+    struct Header {
+        char Magic[8];
+        std::uint32_t ByteOrder;
+        std::uint32_t Version;
+        std::uint32_t MaxEditDistance;
+        std::uint32_t PrefixLength;
+        std::uint32_t MaxWordLength;
+        std::uint32_t WordCount;
+        std::uint32_t WordSlotCount;
+        std::uint32_t DeleteBucketCount;
+        std::uint32_t DeleteEntryCount;
+        std::uint32_t StringPoolSize;
+        std::uint32_t WordsOffset;
+        std::uint32_t WordSlotsOffset;
+        std::uint32_t DeleteBucketsOffset;
+        std::uint32_t DeleteEntriesOffset;
+        std::uint32_t StringPoolOffset;
+        std::uint32_t Reserved;
+    };
+
+    struct Word {
+        std::uint32_t Offset;
+        std::uint32_t Length;
+        std::uint32_t Count;
+    };
+
+    // Count 为 0 表示空槽位
+    struct DeleteBucket {
+        std::uint32_t Hash;
+        std::uint32_t First;
+        std::uint32_t Count;
+    };
+
+    struct IdRange {
+        const std::uint32_t *Begin = nullptr;
+        const std::uint32_t *End = nullptr;
+
+        const std::uint32_t *begin() const { return Begin; }
+
+        const std::uint32_t *end() const { return End; }
+    };
+
+    static constexpr std::uint32_t NotFound = 0xffffffff;
+
+    static std::uint32_t WordHash(std::string_view word);
+
+    // 与 SymSpell 的删除串 hash 相同, 低 2 位是长度, 冲突由编辑距离校验过滤
+    static std::uint32_t DeleteHash(std::string_view deleteWord);
+
+    static bool IsIndexData(std::string_view data);
+
+    // words 必须已按字典序排列且不重复, deletes 的值是 words 中的下标
+    static std::string Serialize(const std::vector<std::pair<std::string, int>> &words,
+                                 const std::map<std::uint32_t, std::vector<std::uint32_t>> &deletes,
+                                 int maxEditDistance, int prefixLength, std::size_t maxWordLength);
+
+    SymSpellIndex();
+
+    // 不复制数据, data 在使用期间必须保持有效
+    bool Attach(std::string_view data);
+
+    bool IsAttached() const;
+
+    std::uint32_t FindWord(std::string_view word) const;
+
+    std::string_view GetWord(std::uint32_t id) const;
+
+    int GetCount(std::uint32_t id) const;
+
+    IdRange FindDeletes(std::uint32_t deleteHash) const;
+
+    int GetMaxEditDistance() const;
+
+    std::size_t GetPrefixLength() const;
+
+    std::size_t GetMaxWordLength() const;
+
+    std::size_t GetWordCount() const;
+
+private:
+    const Header *_header;
+    const Word *_words;
+    const std::uint32_t *_wordSlots;
+    const DeleteBucket *_deleteBuckets;
+    const std::uint32_t *_deleteEntries;
+    const char *_stringPool;
+};
@@ -88,6 +88,13 @@ bool CommandLine::Parse(int argc, char **argv) {
 
             auto eqPos = option.find_first_of('=');
             if (eqPos != std::string_view::npos) {
+                // --option=value
+                auto it = _options->_args.find(option.substr(0, eqPos));
+                if (it != _options->_args.end()) {
+                    it->second.Value = std::string(option.substr(eqPos + 1));
+                    it->second.HasOption = true;
+                    continue;
+                }
                 if (!_options->_enableRestArgs) {
                     _errors.emplace_back(util::format("Unknown option {} ,please enable key=value options", current));
                     return false;
@@ -158,14 +165,23 @@ void CommandLine::PrintUsage() {
     for (auto &target: _targets) {
         std::cerr << util::format("{}:", target.first) << std::endl;
         auto &options = target.second;
+        // 没有短名称的选项同样需要输出
+        std::map<std::string_view, std::string_view> shortNames;
         for (auto &it: options._shortMap) {
-            auto &shortName = it.first;
-            auto &name = it.second;
-            auto &option = options._args[name];
-
-            std::cerr << util::format("\t-{} --{}\n\t\t{}",
-                                      shortName, name, option.Description)
-                      << std::endl;
+            shortNames.insert({it.second, it.first});
+        }
+        for (auto &it: options._args) {
+            auto &name = it.first;
+            auto &option = it.second;
+            auto shortIt = shortNames.find(name);
+            if (shortIt != shortNames.end()) {
+                std::cerr << util::format("\t-{} --{}\n\t\t{}",
+                                          shortIt->second, name, option.Description)
+                          << std::endl;
+            } else {
+                std::cerr << util::format("\t--{}\n\t\t{}", name, option.Description)
+                          << std::endl;
+            }
             std::cerr << std::endl;
         }
     }
@@ -0,0 +1,752 @@
+#include "Util/CompiledRegex.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr std::size_t MaxProgramSize = 10000;
+constexpr int Unbounded = -1;
+constexpr int MaxRepeat = 1000;
+}// namespace
+
+struct CompiledRegex::Node {
+    enum class Kind {
+        Empty,
+        Set,
+        Concat,
+        Alternate,
+        Repeat,
+        Group
+    } NodeKind = Kind::Empty;
+
+    ByteSet Set;
+    std::vector<Node> Children;
+    int Min = 0;
+    int Max = 0;
+    // 捕获组编号, 0 表示不捕获
+    std::size_t GroupIndex = 0;
+};
+
+class CompiledRegex::Parser {
+public:
+    explicit Parser(std::string_view pattern)
+        : _pattern(pattern),
+          _pos(0),
+          _groupCount(0),
+          _error(false) {
+    }
+
+    bool Parse(Node &root) {
+        // 整体匹配时开头的 ^ 和结尾的 $ 没有作用
+        if (!_pattern.empty() && _pattern.front() == '^') {
+            _pattern.remove_prefix(1);
+        }
+        if (!_pattern.empty() && _pattern.back() == '$' && !IsEscaped(_pattern.size() - 1)) {
+            _pattern.remove_suffix(1);
+        }
+        root = ParseAlternate();
+        return !_error && _pos == _pattern.size();
+    }
+
+    std::size_t GetGroupCount() const {
+        return _groupCount;
+    }
+
+private:
+    bool IsEscaped(std::size_t index) const {
+        std::size_t count = 0;
+        while (index > count && _pattern[index - count - 1] == '\\') {
+            count++;
+        }
+        return count % 2 == 1;
+    }
+
+    bool AtEnd() const {
+        return _pos >= _pattern.size();
+    }
+
+    char Peek() const {
+        return AtEnd() ? '\0' : _pattern[_pos];
+    }
+
+    Node Fail() {
+        _error = true;
+        return Node();
+    }
+
+    Node ParseAlternate() {
+        Node first = ParseConcat();
+        if (Peek() != '|') {
+            return first;
+        }
+        Node alternate;
+        alternate.NodeKind = Node::Kind::Alternate;
+        alternate.Children.push_back(std::move(first));
+        while (!_error && Peek() == '|') {
+            _pos++;
+            alternate.Children.push_back(ParseConcat());
+        }
+        return alternate;
+    }
+
+    Node ParseConcat() {
+        Node concat;
+        concat.NodeKind = Node::Kind::Concat;
+        while (!_error && !AtEnd() && Peek() != '|' && Peek() != ')') {
+            concat.Children.push_back(ParseRepeat());
+        }
+        return concat;
+    }
+
+    Node ParseRepeat() {
+        Node atom = ParseAtom();
+        if (_error || AtEnd()) {
+            return atom;
+        }
+
+        int min = 0;
+        int max = 0;
+        switch (Peek()) {
+            case '*': {
+                min = 0;
+                max = Unbounded;
+                _pos++;
+                break;
+            }
+            case '+': {
+                min = 1;
+                max = Unbounded;
+                _pos++;
+                break;
+            }
+            case '?': {
+                min = 0;
+                max = 1;
+                _pos++;
+                break;
+            }
+            case '{': {
+                if (!ParseBraces(min, max)) {
+                    return Fail();
+                }
+                break;
+            }
+            default: {
+                return atom;
+            }
+        }
+
+        // 非贪婪量词和连续的量词不支持
+        if (Peek() == '?' || Peek() == '*' || Peek() == '+' || Peek() == '{') {
+            return Fail();
+        }
+
+        // 可以匹配空串的重复体中有捕获组时, 各实现的捕获结果并不一致, 交给 std::regex 保持原有行为
+        if (max != min && IsNullable(atom) && HasCapture(atom)) {
+            return Fail();
+        }
+
+        Node repeat;
+        repeat.NodeKind = Node::Kind::Repeat;
+        repeat.Min = min;
+        repeat.Max = max;
+        repeat.Children.push_back(std::move(atom));
+        return repeat;
+    }
+
+    static bool IsNullable(const Node &node) {
+        switch (node.NodeKind) {
+            case Node::Kind::Empty: {
+                return true;
+            }
+            case Node::Kind::Set: {
+                return false;
+            }
+            case Node::Kind::Concat: {
+                return std::all_of(node.Children.begin(), node.Children.end(), IsNullable);
+            }
+            case Node::Kind::Alternate: {
+                return std::any_of(node.Children.begin(), node.Children.end(), IsNullable);
+            }
+            case Node::Kind::Repeat: {
+                return node.Min == 0 || IsNullable(node.Children.front());
+            }
+            case Node::Kind::Group: {
+                return IsNullable(node.Children.front());
+            }
+        }
+        return false;
+    }
+
+    static bool HasCapture(const Node &node) {
+        if (node.NodeKind == Node::Kind::Group && node.GroupIndex != 0) {
+            return true;
+        }
+        return std::any_of(node.Children.begin(), node.Children.end(), HasCapture);
+    }
+
+    bool ParseNumber(int &value) {
+        auto start = _pos;
+        value = 0;
+        while (!AtEnd() && Peek() >= '0' && Peek() <= '9') {
+            value = value * 10 + (Peek() - '0');
+            if (value > MaxRepeat) {
+                return false;
+            }
+            _pos++;
+        }
+        return _pos != start;
+    }
+
+    bool ParseBraces(int &min, int &max) {
+        _pos++;
+        if (!ParseNumber(min)) {
+            return false;
+        }
+        if (Peek() == '}') {
+            _pos++;
+            max = min;
+            return true;
+        }
+        if (Peek() != ',') {
+            return false;
+        }
+        _pos++;
+        if (Peek() == '}') {
+            _pos++;
+            max = Unbounded;
+            return true;
+        }
+        if (!ParseNumber(max) || Peek() != '}' || max < min) {
+            return false;
+        }
+        _pos++;
+        return true;
+    }
+
+    Node ParseAtom() {
+        Node node;
+        node.NodeKind = Node::Kind::Set;
+        char c = Peek();
+        switch (c) {
+            case '(': {
+                _pos++;
+                Node group;
+                group.NodeKind = Node::Kind::Group;
+                if (Peek() == '?') {
+                    if (_pos + 1 < _pattern.size() && _pattern[_pos + 1] == ':') {
+                        _pos += 2;
+                    } else {
+                        return Fail();
+                    }
+                } else {
+                    group.GroupIndex = ++_groupCount;
+                }
+                group.Children.push_back(ParseAlternate());
+                if (Peek() != ')') {
+                    return Fail();
+                }
+                _pos++;
+                return group;
+            }
+            case '[': {
+                _pos++;
+                if (!ParseClass(node.Set)) {
+                    return Fail();
+                }
+                return node;
+            }
+            case '.': {
+                _pos++;
+                node.Set.set();
+                node.Set.reset('\n');
+                node.Set.reset('\r');
+                return node;
+            }
+            case '\\': {
+                _pos++;
+                if (!ParseEscape(node.Set)) {
+                    return Fail();
+                }
+                return node;
+            }
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+            case '}':
+            case ']':
+            case ')':
+            case '^':
+            case '$': {
+                return Fail();
+            }
+            default: {
+                _pos++;
+                node.Set.set(static_cast<unsigned char>(c));
+                return node;
+            }
+        }
+    }
+
+    static void AddRange(ByteSet &set, unsigned char first, unsigned char last) {
+        for (unsigned c = first; c <= last; c++) {
+            set.set(c);
+        }
+    }
+
+    static bool IsWordChar(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    // 解析 '\' 之后的转义, 结果放入 set, 返回 false 表示不支持
+    bool ParseEscape(ByteSet &set) {
+        if (AtEnd()) {
+            return false;
+        }
+        char c = _pattern[_pos++];
+        switch (c) {
+            case 'w':
+            case 'W': {
+                ByteSet word;
+                for (unsigned i = 0; i != 256; i++) {
+                    if (IsWordChar(static_cast<unsigned char>(i))) {
+                        word.set(i);
+                    }
+                }
+                set |= (c == 'w') ? word : ~word;
+                return true;
+            }
+            case 'd':
+            case 'D': {
+                ByteSet digit;
+                AddRange(digit, '0', '9');
+                set |= (c == 'd') ? digit : ~digit;
+                return true;
+            }
+            case 's':
+            case 'S': {
+                ByteSet space;
+                for (auto ch: {' ', '\t', '\n', '\r', '\f', '\v'}) {
+                    space.set(static_cast<unsigned char>(ch));
+                }
+                set |= (c == 's') ? space : ~space;
+                return true;
+            }
+            case 't': {
+                set.set('\t');
+                return true;
+            }
+            case 'n': {
+                set.set('\n');
+                return true;
+            }
+            case 'r': {
+                set.set('\r');
+                return true;
+            }
+            case 'f': {
+                set.set('\f');
+                return true;
+            }
+            case 'v': {
+                set.set('\v');
+                return true;
+            }
+            default: {
+                // 只接受转义的标点, 其它 (\b \1 \x \u 等) 交给 std::regex
+                auto uc = static_cast<unsigned char>(c);
+                if (uc < 0x80 && !IsWordChar(uc) && uc > ' ') {
+                    set.set(uc);
+                    return true;
+                }
+                return false;
+            }
+        }
+    }
+
+    // 解析 '[' 之后的字符类
+    bool ParseClass(ByteSet &set) {
+        bool negate = false;
+        if (Peek() == '^') {
+            negate = true;
+            _pos++;
+        }
+
+        // ECMAScript 中 [] 不匹配任何字符, [^] 匹配任意字符
+        ByteSet result;
+        while (!AtEnd() && Peek() != ']') {
+            ByteSet single;
+            int low = -1;
+            if (!ParseClassAtom(single, low)) {
+                return false;
+            }
+            // 范围 a-z, 两端都必须是单个字符
+            if (Peek() == '-' && _pos + 1 < _pattern.size() && _pattern[_pos + 1] != ']') {
+                _pos++;
+                ByteSet upperSet;
+                int high = -1;
+                if (!ParseClassAtom(upperSet, high) || low < 0 || high < 0 || high < low) {
+                    return false;
+                }
+                AddRange(result, static_cast<unsigned char>(low), static_cast<unsigned char>(high));
+            } else {
+                result |= single;
+            }
+        }
+        if (Peek() != ']') {
+            return false;
+        }
+        _pos++;
+        set = negate ? ~result : result;
+        return true;
+    }
+
+    // 字符类中的单个成员, 是单个字符时 ch 为字符值, 否则为 -1
+    bool ParseClassAtom(ByteSet &set, int &ch) {
+        char c = Peek();
+        _pos++;
+        if (c == '\\') {
+            if (AtEnd()) {
+                return false;
+            }
+            char next = Peek();
+            if (next == 'b') {
+                // 字符类中的 \b 是退格
+                _pos++;
+                set.set('\b');
+                ch = '\b';
+                return true;
+            }
+            if (!ParseEscape(set)) {
+                return false;
+            }
+            ch = set.count() == 1 ? static_cast<int>(FindFirst(set)) : -1;
+            return true;
+        }
+        if (c == '[') {
+            // [[:alpha:]] 之类的写法不支持
+            if (Peek() == ':' || Peek() == '=' || Peek() == '.') {
+                return false;
+            }
+        }
+        set.set(static_cast<unsigned char>(c));
+        ch = static_cast<unsigned char>(c);
+        return true;
+    }
+
+    static std::size_t FindFirst(const ByteSet &set) {
+        for (std::size_t i = 0; i != set.size(); i++) {
+            if (set.test(i)) {
+                return i;
+            }
+        }
+        return 0;
+    }
+
+    std::string_view _pattern;
+    std::size_t _pos;
+    std::size_t _groupCount;
+    bool _error;
+};
+
+CompiledRegex::CompiledRegex()
+    : _groupCount(0) {
+}
+
+bool CompiledRegex::Compile(std::string_view pattern) {
+    _program.clear();
+    _sets.clear();
+    _dfaStates.clear();
+    _groupCount = 0;
+
+    Node root;
+    Parser parser(pattern);
+    if (!parser.Parse(root)) {
+        return false;
+    }
+    _groupCount = parser.GetGroupCount();
+
+    Inst save;
+    save.Op = OpCode::Save;
+    save.X = 0;
+    Append(save);
+    Emit(root);
+    save.X = 1;
+    Append(save);
+    Append(Inst{});
+    if (_program.size() > MaxProgramSize) {
+        _program.clear();
+        _sets.clear();
+        return false;
+    }
+    return true;
+}
+
+std::size_t CompiledRegex::GetGroupCount() const {
+    return _groupCount;
+}
+
+std::uint32_t CompiledRegex::Append(Inst inst) {
+    _program.push_back(inst);
+    return static_cast<std::uint32_t>(_program.size() - 1);
+}
+
+void CompiledRegex::Emit(const Node &node) {
+    // 展开后过大的程序直接放弃, 由 Compile 统一判断
+    if (_program.size() > MaxProgramSize) {
+        return;
+    }
+    switch (node.NodeKind) {
+        case Node::Kind::Empty: {
+            break;
+        }
+        case Node::Kind::Set: {
+            Inst inst;
+            inst.Op = OpCode::Byte;
+            inst.SetIndex = static_cast<std::uint32_t>(_sets.size());
+            _sets.push_back(node.Set);
+            Append(inst);
+            break;
+        }
+        case Node::Kind::Concat: {
+            for (auto &child: node.Children) {
+                Emit(child);
+            }
+            break;
+        }
+        case Node::Kind::Alternate: {
+            // split L1, next; L1: a; jump end; next: split L2, ...
+            std::vector<std::uint32_t> jumps;
+            for (std::size_t i = 0; i != node.Children.size(); i++) {
+                if (i + 1 == node.Children.size()) {
+                    Emit(node.Children[i]);
+                    break;
+                }
+                Inst split;
+                split.Op = OpCode::Split;
+                auto splitPc = Append(split);
+                _program[splitPc].X = splitPc + 1;
+                Emit(node.Children[i]);
+                Inst jump;
+                jump.Op = OpCode::Jump;
+                jumps.push_back(Append(jump));
+                _program[splitPc].Y = static_cast<std::uint32_t>(_program.size());
+            }
+            for (auto jump: jumps) {
+                _program[jump].X = static_cast<std::uint32_t>(_program.size());
+            }
+            break;
+        }
+        case Node::Kind::Group: {
+            if (node.GroupIndex != 0) {
+                Inst save;
+                save.Op = OpCode::Save;
+                save.X = static_cast<std::uint32_t>(node.GroupIndex * 2);
+                Append(save);
+                Emit(node.Children.front());
+                save.X++;
+                Append(save);
+            } else {
+                Emit(node.Children.front());
+            }
+            break;
+        }
+        case Node::Kind::Repeat: {
+            auto &body = node.Children.front();
+            for (int i = 0; i < node.Min; i++) {
+                Emit(body);
+            }
+            if (node.Max == Unbounded) {
+                // L: split body, end; body; jump L
+                Inst split;
+                split.Op = OpCode::Split;
+                auto splitPc = Append(split);
+                _program[splitPc].X = splitPc + 1;
+                Emit(body);
+                Inst jump;
+                jump.Op = OpCode::Jump;
+                jump.X = splitPc;
+                Append(jump);
+                _program[splitPc].Y = static_cast<std::uint32_t>(_program.size());
+            } else {
+                std::vector<std::uint32_t> splits;
+                for (int i = node.Min; i < node.Max; i++) {
+                    Inst split;
+                    split.Op = OpCode::Split;
+                    auto splitPc = Append(split);
+                    _program[splitPc].X = splitPc + 1;
+                    splits.push_back(splitPc);
+                    Emit(body);
+                }
+                for (auto splitPc: splits) {
+                    _program[splitPc].Y = static_cast<std::uint32_t>(_program.size());
+                }
+            }
+            break;
+        }
+    }
+}
+
+void CompiledRegex::Closure(std::uint32_t pc, std::vector<std::uint32_t> &states, std::vector<bool> &visited) const {
+    if (visited[pc]) {
+        return;
+    }
+    visited[pc] = true;
+    auto &inst = _program[pc];
+    switch (inst.Op) {
+        case OpCode::Byte:
+        case OpCode::Match: {
+            states.push_back(pc);
+            break;
+        }
+        case OpCode::Split: {
+            Closure(inst.X, states, visited);
+            Closure(inst.Y, states, visited);
+            break;
+        }
+        case OpCode::Jump: {
+            Closure(inst.X, states, visited);
+            break;
+        }
+        case OpCode::Save: {
+            Closure(pc + 1, states, visited);
+            break;
+        }
+    }
+}
+
+int CompiledRegex::AddDfaState(std::vector<std::uint32_t> &&states) {
+    std::sort(states.begin(), states.end());
+    for (std::size_t i = 0; i != _dfaStates.size(); i++) {
+        if (_dfaStates[i].NfaStates == states) {
+            return static_cast<int>(i);
+        }
+    }
+
+    DfaState state;
+    state.Accept = std::any_of(states.begin(), states.end(), [this](std::uint32_t pc) {
+        return _program[pc].Op == OpCode::Match;
+    });
+    state.NfaStates = std::move(states);
+    state.Next.fill(DfaUnknown);
+    _dfaStates.push_back(std::move(state));
+    return static_cast<int>(_dfaStates.size() - 1);
+}
+
+int CompiledRegex::Step(int dfaState, unsigned char c) {
+    auto next = _dfaStates[dfaState].Next[c];
+    if (next != DfaUnknown) {
+        return next;
+    }
+
+    std::vector<std::uint32_t> states;
+    std::vector<bool> visited(_program.size(), false);
+    for (auto pc: _dfaStates[dfaState].NfaStates) {
+        auto &inst = _program[pc];
+        if (inst.Op == OpCode::Byte && _sets[inst.SetIndex].test(c)) {
+            Closure(pc + 1, states, visited);
+        }
+    }
+
+    if (states.empty()) {
+        next = DfaDead;
+    } else {
+        next = AddDfaState(std::move(states));
+    }
+    _dfaStates[dfaState].Next[c] = next;
+    return next;
+}
+
+bool CompiledRegex::Match(std::string_view text) {
+    if (_program.empty()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    // 状态过多时丢弃缓存重新构造, 最坏情况也是线性的
+    if (_dfaStates.empty() || _dfaStates.size() > MaxDfaStates) {
+        _dfaStates.clear();
+        std::vector<std::uint32_t> states;
+        std::vector<bool> visited(_program.size(), false);
+        Closure(0, states, visited);
+        AddDfaState(std::move(states));
+    }
+
+    int state = 0;
+    for (auto c: text) {
+        state = Step(state, static_cast<unsigned char>(c));
+        if (state == DfaDead) {
+            return false;
+        }
+    }
+    return _dfaStates[state].Accept;
+}
+
+bool CompiledRegex::Match(std::string_view text, std::vector<std::string_view> &groups) {
+    groups.clear();
+    if (_program.empty()) {
+        return false;
+    }
+
+    // 带记忆的回溯: 按优先级深度优先搜索, 每个 (指令, 位置) 最多访问一次, 所以仍是线性的
+    // 第一个走到 Match 且位于文本末尾的路径就是回溯实现会选中的路径, 捕获结果一致
+    std::lock_guard<std::mutex> lock(_mutex);
+    constexpr auto None = std::numeric_limits<std::size_t>::max();
+    auto width = text.size() + 1;
+    _visited.assign((_program.size() * width + 63) / 64, 0);
+    _caps.assign((_groupCount + 1) * 2, None);
+    _stack.clear();
+    _stack.push_back(BacktrackJob{0, 0, false});
+    while (!_stack.empty()) {
+        auto job = _stack.back();
+        _stack.pop_back();
+        if (job.Restore) {
+            _caps[job.Pc] = job.Pos;
+            continue;
+        }
+
+        auto pc = job.Pc;
+        auto pos = job.Pos;
+        while (true) {
+            auto visitIndex = pc * width + pos;
+            auto bit = std::uint64_t(1) << (visitIndex % 64);
+            if (_visited[visitIndex / 64] & bit) {
+                break;
+            }
+            _visited[visitIndex / 64] |= bit;
+
+            auto &inst = _program[pc];
+            if (inst.Op == OpCode::Byte) {
+                if (pos < text.size() && _sets[inst.SetIndex].test(static_cast<unsigned char>(text[pos]))) {
+                    pc++;
+                    pos++;
+                    continue;
+                }
+                break;
+            } else if (inst.Op == OpCode::Split) {
+                _stack.push_back(BacktrackJob{inst.Y, pos, false});
+                pc = inst.X;
+            } else if (inst.Op == OpCode::Jump) {
+                pc = inst.X;
+            } else if (inst.Op == OpCode::Save) {
+                _stack.push_back(BacktrackJob{inst.X, _caps[inst.X], true});
+                _caps[inst.X] = pos;
+                pc++;
+            } else {
+                if (pos != text.size()) {
+                    break;
+                }
+                groups.resize(_groupCount + 1);
+                for (std::size_t i = 0; i <= _groupCount; i++) {
+                    auto start = _caps[i * 2];
+                    auto end = _caps[i * 2 + 1];
+                    if (start != None && end != None && start <= end) {
+                        groups[i] = text.substr(start, end - start);
+                    }
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -1,8 +1,15 @@
 #include "Util/FileFinder.h"
 #include "Util/StringUtil.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 FileFinder::FileFinder(std::filesystem::path root)
-	: _root(root)
+	: _root(root),
+	  _threadCount(0),
+	  _visitedDirectoryCount(0)
 {
 }
 
@@ -23,13 +30,13 @@ void FileFinder::AddFindFile(const std::string& fileName)
 
 void FileFinder::AddignorePatterns(const std::string& pattern)
 {
-	if(pattern.empty())
+	if (pattern.empty())
 	{
 		return;
 	}
 
 	auto firstChar = pattern.front();
-	if(firstChar == '\\' || firstChar == '/')
+	if (firstChar == '\\' || firstChar == '/')
 	{
 		_ignorePatterns.push_back(pattern.substr(1));
 	}
@@ -37,73 +44,175 @@ void FileFinder::AddignorePatterns(const std::string& pattern)
 	_ignorePatterns.push_back(pattern);
 }
 
+void FileFinder::AddGitignorePatterns(const std::string& line)
+{
+	_ignoreMatcher.AddPattern(line);
+}
+
+void FileFinder::SetThreadCount(std::size_t threadCount)
+{
+	_threadCount = threadCount;
+}
+
 std::vector<std::string> FileFinder::FindFiles()
 {
+	std::mutex mutex;
 	std::vector<std::string> files;
+	FindFiles([&](std::string&& path)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		files.push_back(std::move(path));
+	});
 
-	CollectFile(_root, files);
+	std::sort(files.begin(), files.end());
+	return files;
+}
 
-	if (_ignorePatterns.empty())
+void FileFinder::FindFiles(const std::function<void(std::string&&)>& onFile)
+{
+	_visitedDirectoryCount = 0;
+	std::error_code ec;
+	if (!std::filesystem::is_directory(_root, ec))
 	{
-		return files;
+		return;
 	}
 
-	std::vector<std::string> resultFiles;
-	auto rootPath = _root.string();
-	for (auto& originFile : files)
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<DirectoryTask> tasks = {DirectoryTask{_root, ""}};
+	// 正在遍历的目录数, 为 0 且任务为空时遍历结束
+	std::size_t busy = 0;
+
+	// 任一线程抛出异常后不再分发任务, 所有线程退出后在调用线程重新抛出
+	std::exception_ptr exception;
+
+	auto worker = [&]()
 	{
-		auto matchFilePath = string_util::GetFileRelativePath(rootPath, originFile);
-		if (!matchFilePath.empty())
+		std::vector<DirectoryTask> subDirectories;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
 		{
-			for (auto& pattern : _ignorePatterns)
+			cv.wait(lock, [&] { return !tasks.empty() || busy == 0; });
+			if (tasks.empty())
+			{
+				return;
+			}
+
+			auto task = std::move(tasks.back());
+			tasks.pop_back();
+			busy++;
+			_visitedDirectoryCount++;
+			lock.unlock();
+
+			subDirectories.clear();
+			std::exception_ptr taskException;
+			try
+			{
+				CollectFile(task, subDirectories, onFile);
+			}
+			catch (...)
+			{
+				taskException = std::current_exception();
+			}
+
+			lock.lock();
+			busy--;
+			if (taskException)
 			{
-				if (string_util::FileWildcardMatch(matchFilePath, pattern))
+				if (!exception)
 				{
-					goto nextFile;
+					exception = taskException;
 				}
+				tasks.clear();
+			}
+			else if (!exception)
+			{
+				for (auto& directory : subDirectories)
+				{
+					tasks.push_back(std::move(directory));
+				}
+			}
+			if (!tasks.empty() || busy == 0)
+			{
+				cv.notify_all();
 			}
 		}
-		resultFiles.push_back(originFile);
-	nextFile:; //ignore
+	};
+
+	auto threadCount = _threadCount;
+	if (threadCount == 0)
+	{
+		threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
 	}
-	return resultFiles;
-}
 
-void FileFinder::CollectFile(std::filesystem::path directoryPath, std::vector<std::string>& paths)
-{
-	if (!std::filesystem::exists(directoryPath))
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < threadCount; i++)
 	{
-		return;
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : threads)
+	{
+		thread.join();
 	}
 
-	for (auto& it : std::filesystem::directory_iterator(directoryPath))
+	if (exception)
 	{
-		if (std::filesystem::is_directory(it.status()))
+		std::rethrow_exception(exception);
+	}
+}
+
+std::size_t FileFinder::GetVisitedDirectoryCount() const
+{
+	return _visitedDirectoryCount;
+}
+
+void FileFinder::CollectFile(const DirectoryTask& task, std::vector<DirectoryTask>& subDirectories,
+                             const std::function<void(std::string&&)>& onFile)
+{
+	std::error_code ec;
+	std::filesystem::directory_iterator it(task.Path, ec);
+	for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+	{
+		auto& entry = *it;
+		auto filename = entry.path().filename().string();
+		std::string relativePath = task.RelativePath.empty() ? filename : task.RelativePath + "/" + filename;
+
+		std::error_code statusEc;
+		auto status = entry.status(statusEc);
+		if (statusEc)
 		{
-			auto filename = it.path().filename().string();
-			if (_ignoreDirectory.count(filename) == 0)
-			{
-				CollectFile(it.path(), paths);
-			}
+			continue;
 		}
-		else if (std::filesystem::is_regular_file(it.status()))
+
+		if (std::filesystem::is_directory(status))
 		{
-			if (!_findFile.empty())
+			// 在进入目录之前剪枝
+			if (_ignoreDirectory.count(filename) == 0 && !_ignoreMatcher.Match(relativePath, true))
 			{
-				auto filename = it.path().filename().string();
-				if (_findFile.count(filename) == 1)
-				{
-					paths.push_back(it.path().string());
-				}
+				subDirectories.push_back(DirectoryTask{entry.path(), std::move(relativePath)});
 			}
-			if (!_findExtension.empty())
+		}
+		else if (std::filesystem::is_regular_file(status))
+		{
+			bool found = _findFile.count(filename) == 1
+			             || _findExtension.count(entry.path().extension().string()) == 1;
+			if (found && !_ignoreMatcher.Match(relativePath, false) && !MatchIgnorePatterns(relativePath))
 			{
-				std::string extension = it.path().extension().string();
-				if (_findExtension.count(extension) == 1)
-				{
-					paths.push_back(it.path().string());
-				}
+				onFile(entry.path().string());
 			}
 		}
 	}
 }
+
+bool FileFinder::MatchIgnorePatterns(std::string_view relativePath) const
+{
+	for (auto& pattern : _ignorePatterns)
+	{
+		if (string_util::FileWildcardMatch(relativePath, pattern))
+		{
+			return true;
+		}
+	}
+	return false;
+}
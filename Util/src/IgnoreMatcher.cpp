@@ -0,0 +1,239 @@
+#include "Util/IgnoreMatcher.h"
+
+static bool IsEscapable(char ch) {
+    switch (ch) {
+        case '*':
+        case '?':
+        case '[':
+        case ']':
+        case '\\':
+        case '!':
+        case '#':
+        case ' ': {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+// 匹配 [...], 返回字符类的长度, 0 表示没有闭合的 ']' 应当按普通字符处理
+static std::size_t MatchCharClass(std::string_view pattern, char ch, bool &matched) {
+    std::size_t i = 1;
+    bool negate = false;
+    if (i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^')) {
+        negate = true;
+        i++;
+    }
+
+    bool first = true;
+    matched = false;
+    while (i < pattern.size() && (first || pattern[i] != ']')) {
+        first = false;
+        char lo = pattern[i];
+        if (lo == '\\' && i + 1 < pattern.size()) {
+            lo = pattern[++i];
+        }
+        i++;
+        if (i + 1 < pattern.size() && pattern[i] == '-' && pattern[i + 1] != ']') {
+            std::size_t j = i + 1;
+            char hi = pattern[j];
+            if (hi == '\\' && j + 1 < pattern.size()) {
+                hi = pattern[++j];
+            }
+            i = j + 1;
+            if (lo <= ch && ch <= hi) {
+                matched = true;
+            }
+        } else if (lo == ch) {
+            matched = true;
+        }
+    }
+
+    if (i >= pattern.size()) {
+        return 0;
+    }
+    matched = matched != negate;
+    return i + 1;
+}
+
+static bool GlobMatchImpl(std::string_view pattern, std::string_view path, bool segmentStart) {
+    while (!pattern.empty()) {
+        auto ch = pattern.front();
+        if (ch == '*') {
+            if (segmentStart && pattern.size() >= 2 && pattern[1] == '*' && (pattern.size() == 2 || pattern[2] == '/')) {
+                // 'a/**' 匹配 a 之下的所有内容
+                if (pattern.size() == 2) {
+                    return true;
+                }
+                // '**/' 匹配零个或多个目录
+                auto rest = pattern.substr(3);
+                while (true) {
+                    if (GlobMatchImpl(rest, path, true)) {
+                        return true;
+                    }
+                    auto sep = path.find('/');
+                    if (sep == std::string_view::npos) {
+                        return false;
+                    }
+                    path.remove_prefix(sep + 1);
+                }
+            }
+
+            while (!pattern.empty() && pattern.front() == '*') {
+                pattern.remove_prefix(1);
+            }
+            if (pattern.empty()) {
+                return path.find('/') == std::string_view::npos;
+            }
+            for (std::size_t i = 0;; i++) {
+                if (GlobMatchImpl(pattern, path.substr(i), false)) {
+                    return true;
+                }
+                if (i == path.size() || path[i] == '/') {
+                    return false;
+                }
+            }
+        }
+
+        if (path.empty()) {
+            return false;
+        }
+
+        std::size_t consume = 1;
+        if (ch == '?') {
+            if (path.front() == '/') {
+                return false;
+            }
+        } else if (ch == '[') {
+            bool matched = false;
+            auto length = MatchCharClass(pattern, path.front(), matched);
+            if (length == 0) {
+                if (path.front() != '[') {
+                    return false;
+                }
+            } else if (!matched || path.front() == '/') {
+                return false;
+            } else {
+                consume = length;
+            }
+        } else {
+            if (ch == '\\' && pattern.size() > 1) {
+                ch = pattern[1];
+                consume = 2;
+            }
+            if (ch != path.front()) {
+                return false;
+            }
+        }
+
+        segmentStart = path.front() == '/';
+        pattern.remove_prefix(consume);
+        path.remove_prefix(1);
+    }
+    return path.empty();
+}
+
+IgnoreMatcher::IgnoreMatcher() {
+}
+
+void IgnoreMatcher::AddPattern(std::string_view line) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n' || line.back() == ' ' || line.back() == '\t')) {
+        if (line.back() == ' ' && line.size() > 1 && line[line.size() - 2] == '\\') {
+            break;
+        }
+        line.remove_suffix(1);
+    }
+    while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) {
+        line.remove_prefix(1);
+    }
+    if (line.empty() || line.front() == '#') {
+        return;
+    }
+
+    Rule rule;
+    if (line.front() == '!') {
+        rule.Negate = true;
+        line.remove_prefix(1);
+    }
+
+    // '\\' 后跟通配符时为转义, 否则视为 windows 风格的路径分隔符
+    std::string &pattern = rule.Pattern;
+    pattern.reserve(line.size());
+    for (std::size_t i = 0; i < line.size(); i++) {
+        auto ch = line[i];
+        if (ch == '\\') {
+            if (i + 1 < line.size() && IsEscapable(line[i + 1])) {
+                pattern.push_back(ch);
+                pattern.push_back(line[++i]);
+            } else {
+                pattern.push_back('/');
+            }
+        } else {
+            pattern.push_back(ch);
+        }
+    }
+
+    if (!pattern.empty() && pattern.back() == '/') {
+        rule.DirectoryOnly = true;
+        while (!pattern.empty() && pattern.back() == '/') {
+            pattern.pop_back();
+        }
+    }
+    if (!pattern.empty() && pattern.front() == '/') {
+        rule.Anchored = true;
+        pattern.erase(0, pattern.find_first_not_of('/'));
+    } else if (pattern.find('/') != std::string::npos) {
+        rule.Anchored = true;
+    }
+
+    if (pattern.empty()) {
+        return;
+    }
+    _rules.push_back(std::move(rule));
+}
+
+bool IgnoreMatcher::Empty() const {
+    return _rules.empty();
+}
+
+bool IgnoreMatcher::Match(std::string_view relativePath, bool isDirectory) const {
+    if (_rules.empty()) {
+        return false;
+    }
+
+    auto basename = relativePath;
+    auto sep = relativePath.rfind('/');
+    if (sep != std::string_view::npos) {
+        basename = relativePath.substr(sep + 1);
+    }
+
+    for (auto it = _rules.rbegin(); it != _rules.rend(); ++it) {
+        auto &rule = *it;
+        if (rule.DirectoryOnly && !isDirectory) {
+            continue;
+        }
+        if (GlobMatch(rule.Pattern, rule.Anchored ? relativePath : basename)) {
+            return !rule.Negate;
+        }
+    }
+    return false;
+}
+
+bool IgnoreMatcher::IsIgnored(std::string_view relativePath, bool isDirectory) const {
+    if (_rules.empty()) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i != relativePath.size(); i++) {
+        if (relativePath[i] == '/' && Match(relativePath.substr(0, i), true)) {
+            return true;
+        }
+    }
+    return Match(relativePath, isDirectory);
+}
+
+bool IgnoreMatcher::GlobMatch(std::string_view pattern, std::string_view path) {
+    return GlobMatchImpl(pattern, path, true);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "DamerauOSADistance.hpp"
+#include "Util/SymSpell/IDistance.h"
+#include <array>
+#include <cstdint>
+
+/*
+ * Hyyrö 的位并行 OSA (Damerau 受限编辑距离) 算法
+ * 较短的串作为模式串, 每个字符在模式串中出现的位置压成一个 64 位掩码, 逐列用位运算推进 DP
+ * 模式串超过 64 字节时退回 DamerauOSA
+ * 参见 Heikki Hyyrö, A Bit-Vector Algorithm for Computing Levenshtein and Damerau Edit Distances, 2003
+ */
+class BitParallelOSA : public IDistance {
+public:
+    static constexpr std::size_t MaxPatternLength = 64;
+
+    BitParallelOSA() : _peq{} {}
+
+    int Distance(std::string_view string1, std::string_view string2) override {
+        if (string1.size() > string2.size()) {
+            std::swap(string1, string2);
+        }
+        if (string1.size() > MaxPatternLength) {
+            return _fallback.Distance(string1, string2);
+        }
+        return Compute(string1, string2, string2.size());
+    }
+
+    int Distance(std::string_view string1, std::string_view string2, std::size_t maxEditDistance) override {
+        if (string1.size() > string2.size()) {
+            std::swap(string1, string2);
+        }
+        if (string2.size() - string1.size() > maxEditDistance) {
+            return -1;
+        }
+        if (string1.size() > MaxPatternLength) {
+            return _fallback.Distance(string1, string2, maxEditDistance);
+        }
+        return Compute(string1, string2, maxEditDistance);
+    }
+
+private:
+    // pattern 不超过 64 字节, 距离超过 maxEditDistance 时返回 -1
+    int Compute(std::string_view pattern, std::string_view text, std::size_t maxEditDistance) {
+        auto m = pattern.size();
+        auto n = text.size();
+        if (m == 0) {
+            return n <= maxEditDistance ? static_cast<int>(n) : -1;
+        }
+
+        for (std::size_t i = 0; i != m; i++) {
+            _peq[static_cast<unsigned char>(pattern[i])] |= std::uint64_t(1) << i;
+        }
+
+        std::uint64_t vp = ~std::uint64_t(0);
+        std::uint64_t vn = 0;
+        std::uint64_t d0 = 0;
+        std::uint64_t pmPrev = 0;
+        std::uint64_t last = std::uint64_t(1) << (m - 1);
+        auto score = static_cast<std::ptrdiff_t>(m);
+        auto maxDistance = static_cast<std::ptrdiff_t>(maxEditDistance);
+        for (std::size_t j = 0; j != n; j++) {
+            auto pm = _peq[static_cast<unsigned char>(text[j])];
+            // 相邻字符交换: 上一列可以匹配前一个位置, 且本列匹配当前位置
+            auto tr = (((~d0) & pm) << 1) & pmPrev;
+            d0 = (((pm & vp) + vp) ^ vp) | pm | vn | tr;
+            auto hp = vn | ~(d0 | vp);
+            auto hn = d0 & vp;
+            if (hp & last) {
+                score++;
+            } else if (hn & last) {
+                score--;
+            }
+            auto x = (hp << 1) | 1;
+            vn = x & d0;
+            vp = (hn << 1) | ~(x | d0);
+            pmPrev = pm;
+            // 剩余每一列最多让距离减 1
+            if (score - static_cast<std::ptrdiff_t>(n - j - 1) > maxDistance) {
+                score = maxDistance + 1;
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i != m; i++) {
+            _peq[static_cast<unsigned char>(pattern[i])] = 0;
+        }
+        return score <= maxDistance ? static_cast<int>(score) : -1;
+    }
+
+    std::array<std::uint64_t, 256> _peq;
+    DamerauOSA _fallback;
+};
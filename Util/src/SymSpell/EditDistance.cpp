@@ -1,8 +1,18 @@
 #include "Util/SymSpell/EditDistance.h"
+#include "BitParallelOSADistance.hpp"
 #include "DamerauOSADistance.hpp"
 
-EditDistance::EditDistance()
-    : _distanceAlgorithm(std::make_shared<DamerauOSA>()) {
+EditDistance::EditDistance(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::DamerauOSA: {
+            _distanceAlgorithm = std::make_shared<DamerauOSA>();
+            break;
+        }
+        case Algorithm::BitParallelOSA: {
+            _distanceAlgorithm = std::make_shared<BitParallelOSA>();
+            break;
+        }
+    }
 }
 
 int EditDistance::Compare(std::string_view lhs, std::string_view rhs, std::size_t maxEditDistance) {
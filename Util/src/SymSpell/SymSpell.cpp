@@ -1,20 +1,189 @@
 #include "Util/SymSpell/SymSpell.h"
 #include "Util/StringUtil.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <sstream>
 
+namespace {
+// 容量固定的暂存区, 超出内联容量后才使用堆内存
+template<class T, std::size_t N>
+class ScratchVector {
+public:
+    std::size_t size() const {
+        return _size;
+    }
+
+    T *data() {
+        return _size <= N ? _inline.data() : _heap.data();
+    }
+
+    const T *data() const {
+        return _size <= N ? _inline.data() : _heap.data();
+    }
+
+    T &operator[](std::size_t i) {
+        return data()[i];
+    }
+
+    const T &operator[](std::size_t i) const {
+        return data()[i];
+    }
+
+    // 扩展 n 个元素并返回新区域的首地址, 之前取得的指针可能失效
+    T *Grow(std::size_t n) {
+        auto oldSize = _size;
+        if (oldSize + n > N) {
+            if (oldSize <= N) {
+                _heap.assign(_inline.begin(), _inline.begin() + oldSize);
+            }
+            _heap.resize(oldSize + n);
+        }
+        _size += n;
+        return data() + oldSize;
+    }
+
+    void push_back(const T &value) {
+        *Grow(1) = value;
+    }
+
+private:
+    std::array<T, N> _inline{};
+    std::vector<T> _heap;
+    std::size_t _size = 0;
+};
+
+// 删除串候选集合, 字符连续存放, 候选数量很少所以用线性查找去重
+class DeleteCandidates {
+public:
+    std::size_t Size() const {
+        return _spans.size();
+    }
+
+    std::string_view Get(std::size_t i) const {
+        auto &span = _spans[i];
+        return std::string_view(_chars.data() + span.Offset, span.Length);
+    }
+
+    int GetDistance(std::size_t i) const {
+        return _spans[i].Distance;
+    }
+
+    bool Add(std::string_view word, int distance) {
+        if (Contains(word)) {
+            return false;
+        }
+        auto offset = _chars.size();
+        auto dest = _chars.Grow(word.size());
+        std::copy(word.begin(), word.end(), dest);
+        _spans.push_back(Span{static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(word.size()), distance});
+        return true;
+    }
+
+    // 添加第 i 个候选删除 pos 位置字符后的结果
+    bool AddDelete(std::size_t i, std::size_t pos) {
+        auto source = _spans[i];
+        auto word = Get(i);
+        auto newLen = word.size() - 1;
+        for (std::size_t j = 0; j != _spans.size(); j++) {
+            auto other = Get(j);
+            if (other.size() == newLen
+                && other.substr(0, pos) == word.substr(0, pos)
+                && other.substr(pos) == word.substr(pos + 1)) {
+                return false;
+            }
+        }
+        auto offset = _chars.size();
+        _chars.Grow(newLen);
+        // Grow 之后重新取地址
+        auto chars = _chars.data();
+        std::copy(chars + source.Offset, chars + source.Offset + pos, chars + offset);
+        std::copy(chars + source.Offset + pos + 1, chars + source.Offset + source.Length, chars + offset + pos);
+        _spans.push_back(Span{static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(newLen), source.Distance + 1});
+        return true;
+    }
+
+private:
+    struct Span {
+        std::uint32_t Offset;
+        std::uint32_t Length;
+        int Distance;
+    };
+
+    bool Contains(std::string_view word) const {
+        for (std::size_t j = 0; j != _spans.size(); j++) {
+            if (Get(j) == word) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ScratchVector<char, 256> _chars;
+    ScratchVector<Span, 64> _spans;
+};
+
+// 已经校验过的建议词, key 为 (来源 + 1) << 32 | 词 id, 0 表示空槽位
+class SuggestionSet {
+public:
+    SuggestionSet() {
+        _slots.Grow(InitialSlots);
+    }
+
+    bool Insert(std::uint64_t key) {
+        if ((_count + 1) * 2 > _slots.size()) {
+            Rehash();
+        }
+        auto mask = _slots.size() - 1;
+        auto slot = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 40) & mask;
+        while (_slots[slot] != 0) {
+            if (_slots[slot] == key) {
+                return false;
+            }
+            slot = (slot + 1) & mask;
+        }
+        _slots[slot] = key;
+        _count++;
+        return true;
+    }
+
+private:
+    void Rehash() {
+        std::vector<std::uint64_t> old(_slots.data(), _slots.data() + _slots.size());
+        _slots.Grow(_slots.size());
+        std::fill(_slots.data(), _slots.data() + _slots.size(), 0);
+        _count = 0;
+        for (auto key: old) {
+            if (key != 0) {
+                Insert(key);
+            }
+        }
+    }
+
+    static constexpr std::size_t InitialSlots = 128;
+
+    ScratchVector<std::uint64_t, InitialSlots> _slots;
+    std::size_t _count = 0;
+};
+
+// 删除串 hash 的低位是长度, 打散后再取槽位
+std::size_t DeleteSlot(std::uint32_t hash, std::size_t mask) {
+    return (hash * 2654435761u >> 7) & mask;
+}
+}// namespace
+
 SymSpell::SymSpell(Strategy strategy,
                    int maxDictionaryEditDistance,
                    int prefixLength)
     : _prefixLength(prefixLength),
-      _compactMask((std::numeric_limits<uint32_t>::max() >> 8) << 2),
       _maxDictionaryWordLength(0),
       _maxDictionaryEditDistance(maxDictionaryEditDistance),
-      _words(),
+      _deleteBucketUsed(0),
+      _builtWordCount(0),
       _strategy(strategy) {
 }
 
@@ -61,34 +230,89 @@ bool SymSpell::CreateDictionaryEntry(const std::string &key, int count) {
         return false;
     }
 
-    auto wordsFounded = _words.find(key);
-    if (wordsFounded != _words.end()) {
-        int countPrevious = wordsFounded->second;
+    auto id = FindWord(key);
+    if (id != NotFound) {
+        int countPrevious = _words[id].Count;
         count = (std::numeric_limits<int>::max() - countPrevious > count)
                         ? (countPrevious + count)
                         : std::numeric_limits<int>::max();
-        wordsFounded->second = count;
+        _words[id].Count = count;
         return false;
-    } else {
-        _words.insert({key, count});
     }
+    id = AddWord(key, count);
 
     if (_strategy == Strategy::LazyLoaded) {
         return true;
     }
 
-    return BuildDeletesWords(key);
+    return BuildDeletesWords(id);
 }
 
-bool SymSpell::IsCorrectWord(const std::string& word) const {
-    return (word.size() <= static_cast<std::size_t>(_maxDictionaryEditDistance)) || (_words.count(word) == 1);
+bool SymSpell::LoadDictionary(const std::string &path) {
+    auto file = std::make_unique<MappedFile>();
+    if (!file->Open(path)) {
+        return false;
+    }
+
+    SymSpellIndex index;
+    if (!index.Attach(file->GetData())
+        || index.GetMaxEditDistance() != _maxDictionaryEditDistance
+        || index.GetPrefixLength() != _prefixLength) {
+        return false;
+    }
+
+    _maxDictionaryWordLength = std::max(_maxDictionaryWordLength, index.GetMaxWordLength());
+    _indexes.push_back(MappedIndex{std::move(file), index});
+    return true;
 }
 
-std::vector<SuggestItem> SymSpell::LookUp(const std::string &input) {
+bool SymSpell::SaveDictionary(const std::string &path) {
+    std::vector<std::pair<std::string, int>> words;
+    words.reserve(_words.size());
+    for (std::uint32_t id = 0; id != _words.size(); id++) {
+        words.emplace_back(std::string(GetWord(id)), _words[id].Count);
+    }
+    std::sort(words.begin(), words.end());
+
+    std::size_t maxWordLength = 0;
+    std::map<std::uint32_t, std::vector<std::uint32_t>> deletes;
+    std::vector<std::uint32_t> deleteHashes;
+    for (std::uint32_t id = 0; id != words.size(); id++) {
+        auto &word = words[id].first;
+        maxWordLength = std::max(maxWordLength, word.size());
+        EditsPrefix(word, deleteHashes);
+        for (auto deleteHash: deleteHashes) {
+            deletes[deleteHash].push_back(id);
+        }
+    }
+
+    auto data = SymSpellIndex::Serialize(words, deletes, _maxDictionaryEditDistance,
+                                         static_cast<int>(_prefixLength), maxWordLength);
+    std::fstream fout(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fout.is_open()) {
+        return false;
+    }
+    fout.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(fout);
+}
+
+bool SymSpell::IsCorrectWord(std::string_view word) const {
+    if ((word.size() <= static_cast<std::size_t>(_maxDictionaryEditDistance)) || (FindWord(word) != NotFound)) {
+        return true;
+    }
+    for (auto &mapped: _indexes) {
+        if (mapped.Index.FindWord(word) != SymSpellIndex::NotFound) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<SuggestItem> SymSpell::LookUp(std::string_view input) {
     return LookUp(input, _maxDictionaryEditDistance);
 }
 
-std::vector<SuggestItem> SymSpell::LookUp(const std::string &input, int maxEditDistance) {
+std::vector<SuggestItem> SymSpell::LookUp(std::string_view input, int maxEditDistance) {
     if (_strategy == Strategy::LazyLoaded) {
         BuildAllDeletesWords();
         _strategy = Strategy::Normal;
@@ -105,134 +329,143 @@ std::vector<SuggestItem> SymSpell::LookUp(const std::string &input, int maxEditD
         return suggestions;
     }
 
-    int suggestionCount = 0;
-    auto founded = _words.find(input);
-
-    if (founded != _words.end()) {
-        // suggestionCount = founded->second;
-        // suggestions.emplace_back(std::string(input), 0, suggestionCount);
+    if (FindWord(input) != NotFound) {
         return suggestions;
     }
+    for (auto &mapped: _indexes) {
+        if (mapped.Index.FindWord(input) != SymSpellIndex::NotFound) {
+            return suggestions;
+        }
+    }
 
     // deletes we've considered already
-    std::unordered_set<std::string> hashset1;
+    DeleteCandidates candidates;
     // suggestions we've considered already
-    std::unordered_set<std::string> hashset2;
-
-    hashset2.insert(std::string(input));
+    SuggestionSet hashset2;
 
     int maxEditDistance2 = maxEditDistance;
 
-    std::vector<std::string> candidates;
-
     auto inputPrefixLen = input.size();
     auto inputLen = inputPrefixLen;
     if (inputPrefixLen > _prefixLength) {
         inputPrefixLen = _prefixLength;
-        candidates.emplace_back(input.substr(0, inputPrefixLen));
-    } else {
-        candidates.emplace_back(input);
     }
-
-    std::size_t candidateIndex = 0;
-    while (candidateIndex < candidates.size()) {
-        // do not &
-        auto candidate = candidates[candidateIndex++];
-        auto candidateLen = candidate.size();
-        int lengthDiff = static_cast<int>(inputPrefixLen - candidateLen);
-        if (lengthDiff > maxEditDistance2) {
-            break;
+    candidates.Add(input.substr(0, inputPrefixLen), 0);
+
+    std::string_view candidate;
+    std::size_t candidateLen = 0;
+    // 校验一个候选词, 候选词可能来自文本词典或映射的索引, source 区分来源
+    auto checkSuggestion = [&](std::uint32_t source, std::uint32_t id, std::string_view suggestion, int suggestionCount) {
+        auto suggestionLen = suggestion.size();
+        if (suggestion == input) {
+            return;
         }
 
-        auto it = _deletes.find(GetStringHash(candidate));
-        if (it != _deletes.end()) {
-            auto &dictSuggestions = it->second;
-            for (auto &suggestion: dictSuggestions) {
-                auto suggestionLen = suggestion.size();
-                if (suggestion == input) {
-                    continue;
-                }
+        if ((::abs(static_cast<int>(suggestionLen - input.size())) > maxEditDistance2)
+            // input and sugg lengths diff > allowed/current best distance
+            || (suggestionLen < candidateLen)
+            // sugg must be for a different delete string, in same bin only because of hash collision
+            || (suggestionLen == candidateLen && suggestion != candidate))
+        // if sugg len = delete len, then it either equals delete or is in same bin only because of hash collision
+        {
+            return;
+        }
 
-                if ((::abs(static_cast<int>(suggestionLen - input.size())) > maxEditDistance2)
-                    // input and sugg lengths diff > allowed/current best distance
-                    || (suggestionLen < candidateLen)
-                    // sugg must be for a different delete string, in same bin only because of hash collision
-                    || (suggestionLen == candidateLen && suggestion != candidate))
-                // if sugg len = delete len, then it either equals delete or is in same bin only because of hash collision
-                {
-                    continue;
+        auto suggestPrefixLen = std::min(suggestionLen, _prefixLength);
+        if ((suggestPrefixLen > inputPrefixLen) && (static_cast<int>(suggestPrefixLen - candidateLen) > maxEditDistance2)) {
+            return;
+        }
+        auto key = (static_cast<std::uint64_t>(source) + 1) << 32 | id;
+        //True Damerau-Levenshtein Edit Distance: adjust distance, if both distances>0
+        //We allow simultaneous edits (deletes) of maxEditDistance on on both the dictionary and the input term.
+        //For replaces and adjacent transposes the resulting edit distance stays <= maxEditDistance.
+        //For inserts and deletes the resulting edit distance might exceed maxEditDistance.
+        //To prevent suggestions of a higher edit distance, we need to calculate the resulting edit distance, if there are simultaneous edits on both sides.
+        //Example: (bank==bnak and bank==bink, but bank!=kanb and bank!=xban and bank!=baxn for maxEditDistance=1)
+        //Two deletes on each side of a pair makes them all equal, but the first two pairs have edit distance=1, the others edit distance=2.
+        int distance = 0;
+        int minLen = 0;
+        if (candidateLen == 0) {
+            //suggestions which have no common chars with input (inputLen<=maxEditDistance && suggestionLen<=maxEditDistance)
+            distance = static_cast<int>(std::max(inputLen, suggestionLen));
+            if (distance > maxEditDistance2 || !hashset2.Insert(key)) {
+                return;
+            }
+        } else if (suggestionLen == 1) {
+            // not entirely sure what happens here yet
+            if (input.find(suggestion[0]) == std::string_view::npos) {
+                distance = static_cast<int>(inputLen);
+            } else {
+                distance = static_cast<int>(inputLen) - 1;
+            }
+            if (distance > maxEditDistance2 || !hashset2.Insert(key)) {
+                return;
+            }
+        } else {
+            // number of edits in prefix == maxediddistance  AND no identic suffix
+            // then editdistance>maxEditDistance and no need for Levenshtein calculation
+            if (_prefixLength - 1 == candidateLen) {
+                minLen = static_cast<int>(std::min(inputLen, suggestionLen) - _prefixLength);
+                if (minLen > 1 && input.substr(inputLen + 1 - minLen) != suggestion.substr(
+                                                                                 suggestionLen + 1 - minLen)) {
+                    return;
                 }
 
-                auto suggestPrefixLen = std::min(suggestionLen, _prefixLength);
-                if ((suggestPrefixLen > inputPrefixLen) && (static_cast<int>(suggestPrefixLen - candidateLen) > maxEditDistance2)) {
-                    continue;
-                }
-                //True Damerau-Levenshtein Edit Distance: adjust distance, if both distances>0
-                //We allow simultaneous edits (deletes) of maxEditDistance on on both the dictionary and the input term.
-                //For replaces and adjacent transposes the resulting edit distance stays <= maxEditDistance.
-                //For inserts and deletes the resulting edit distance might exceed maxEditDistance.
-                //To prevent suggestions of a higher edit distance, we need to calculate the resulting edit distance, if there are simultaneous edits on both sides.
-                //Example: (bank==bnak and bank==bink, but bank!=kanb and bank!=xban and bank!=baxn for maxEditDistance=1)
-                //Two deletes on each side of a pair makes them all equal, but the first two pairs have edit distance=1, the others edit distance=2.
-                int distance = 0;
-                int minLen = 0;
-                if (candidateLen == 0) {
-                    //suggestions which have no common chars with input (inputLen<=maxEditDistance && suggestionLen<=maxEditDistance)
-                    distance = static_cast<int>(std::max(inputLen, suggestionLen));
-                    auto flag = hashset2.insert(suggestion);
-                    if (distance > maxEditDistance2 || !flag.second) {
-                        continue;
-                    }
-                } else if (suggestionLen == 1) {
-                    // not entirely sure what happens here yet
-                    if (input.find(suggestion[0]) == std::string_view::npos) {
-                        distance = static_cast<int>(inputLen);
-                    } else {
-                        distance = static_cast<int>(inputLen) - 1;
-                    }
-                    auto flag = hashset2.insert(suggestion);
-                    if (distance > maxEditDistance2 || !flag.second) {
-                        continue;
-                    }
-                } else {
-                    // number of edits in prefix == maxediddistance  AND no identic suffix
-                    // then editdistance>maxEditDistance and no need for Levenshtein calculation
-                    if (_prefixLength - 1 == candidateLen) {
-                        minLen = static_cast<int>(std::min(inputLen, suggestionLen) - _prefixLength);
-                        if (minLen > 1 && input.substr(inputLen + 1 - minLen) != suggestion.substr(
-                                                                                         suggestionLen + 1 - minLen)) {
-                            continue;
-                        }
-
-                        if (minLen > 0 && (input[inputLen - minLen] != suggestion[suggestionLen - minLen]) && ((input[inputLen - minLen - 1] != suggestion[suggestionLen - minLen]) || (input[inputLen - minLen] != suggestion[suggestionLen - minLen - 1]))) {
-                            continue;
-                        }
-                    }
-
-                    // DeleteInSuggestionPrefix is somewhat expensive, and only pays off when verbosity is Top or Closest.
-                    if ((!DeleteInSuggestionPrefix(candidate, candidateLen, suggestion, suggestionLen)) || !hashset2.insert(suggestion).second) {
-                        continue;
-                    }
-                    distance = _editDistance.Compare(input, suggestion, maxEditDistance2);
-                    if (distance < 0) {
-                        continue;
-                    }
+                if (minLen > 0 && (input[inputLen - minLen] != suggestion[suggestionLen - minLen]) && ((input[inputLen - minLen - 1] != suggestion[suggestionLen - minLen]) || (input[inputLen - minLen] != suggestion[suggestionLen - minLen - 1]))) {
+                    return;
                 }
+            }
 
-                //save some time
-                //do not process higher distances than those already found, if verbosity<All (note: maxEditDistance2 will always equal maxEditDistance when Verbosity.All)
-                if (distance <= maxEditDistance2) {
-                    suggestionCount = _words[suggestion];
-                    SuggestItem si(suggestion, distance, suggestionCount);
+            // DeleteInSuggestionPrefix is somewhat expensive, and only pays off when verbosity is Top or Closest.
+            if ((!DeleteInSuggestionPrefix(candidate, candidateLen, suggestion, suggestionLen)) || !hashset2.Insert(key)) {
+                return;
+            }
+            distance = _editDistance.Compare(input, suggestion, maxEditDistance2);
+            if (distance < 0) {
+                return;
+            }
+        }
 
-                    if (!suggestions.empty() && distance < maxEditDistance2) {
-                        suggestions.clear();
-                    }
+        //save some time
+        //do not process higher distances than those already found, if verbosity<All (note: maxEditDistance2 will always equal maxEditDistance when Verbosity.All)
+        if (distance <= maxEditDistance2) {
+            if (!suggestions.empty() && distance < maxEditDistance2) {
+                suggestions.clear();
+            }
 
-                    maxEditDistance2 = distance;
-                    suggestions.push_back(si);
+            maxEditDistance2 = distance;
+            // 同一个词可能同时出现在文本词典和多个索引中
+            for (auto &item: suggestions) {
+                if (item.Term == suggestion) {
+                    return;
                 }
             }
+            suggestions.emplace_back(std::string(suggestion), distance, suggestionCount);
+        }
+    };
+
+    std::size_t candidateIndex = 0;
+    while (candidateIndex < candidates.Size()) {
+        auto currentIndex = candidateIndex++;
+        candidate = candidates.Get(currentIndex);
+        candidateLen = candidate.size();
+        int lengthDiff = static_cast<int>(inputPrefixLen - candidateLen);
+        if (lengthDiff > maxEditDistance2) {
+            break;
+        }
+
+        auto deleteHash = SymSpellIndex::DeleteHash(candidate);
+        if (auto bucket = FindDeleteBucket(deleteHash); bucket) {
+            for (auto node = bucket->Head; node != 0; node = _deleteNodes[node - 1].Next) {
+                auto id = _deleteNodes[node - 1].WordId;
+                checkSuggestion(0, id, GetWord(id), _words[id].Count);
+            }
+        }
+        for (std::uint32_t i = 0; i != _indexes.size(); i++) {
+            auto &index = _indexes[i].Index;
+            for (auto id: index.FindDeletes(deleteHash)) {
+                checkSuggestion(i + 1, id, index.GetWord(id), index.GetCount(id));
+            }
         }
 
         //add edits
@@ -245,12 +478,7 @@ std::vector<SuggestItem> SymSpell::LookUp(const std::string &input, int maxEditD
                 continue;
             }
             for (std::size_t i = 0; i < candidateLen; i++) {
-                std::string temp(candidate);
-                std::string del = temp.erase(i, 1);
-
-                if (hashset1.insert(del).second) {
-                    candidates.push_back(del);
-                }
+                candidates.AddDelete(currentIndex, i);
             }
         }
     }
@@ -260,82 +488,159 @@ std::vector<SuggestItem> SymSpell::LookUp(const std::string &input, int maxEditD
     return suggestions;
 }
 
-bool SymSpell::BuildDeletesWords(const std::string &key) {
+std::uint32_t SymSpell::FindWord(std::string_view word) const {
+    if (_wordSlots.empty()) {
+        return NotFound;
+    }
+    auto mask = _wordSlots.size() - 1;
+    auto slot = SymSpellIndex::WordHash(word) & mask;
+    while (_wordSlots[slot] != 0) {
+        auto id = _wordSlots[slot] - 1;
+        if (GetWord(id) == word) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NotFound;
+}
+
+std::string_view SymSpell::GetWord(std::uint32_t id) const {
+    auto &entry = _words[id];
+    return std::string_view(_wordPool.data() + entry.Offset, entry.Length);
+}
+
+std::uint32_t SymSpell::AddWord(std::string_view word, int count) {
+    auto id = static_cast<std::uint32_t>(_words.size());
+    _words.push_back(WordEntry{static_cast<std::uint32_t>(_wordPool.size()), static_cast<std::uint32_t>(word.size()), count});
+    _wordPool.append(word);
+
+    // 装载因子不超过 0.5
+    if (_words.size() * 2 > _wordSlots.size()) {
+        _wordSlots.assign(std::max<std::size_t>(_wordSlots.size() * 2, 1024), 0);
+        auto mask = _wordSlots.size() - 1;
+        for (std::uint32_t i = 0; i != _words.size(); i++) {
+            auto slot = SymSpellIndex::WordHash(GetWord(i)) & mask;
+            while (_wordSlots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            _wordSlots[slot] = i + 1;
+        }
+    } else {
+        auto mask = _wordSlots.size() - 1;
+        auto slot = SymSpellIndex::WordHash(word) & mask;
+        while (_wordSlots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        _wordSlots[slot] = id + 1;
+    }
+    return id;
+}
+
+const SymSpell::DeleteBucket *SymSpell::FindDeleteBucket(std::uint32_t deleteHash) const {
+    if (_deleteBuckets.empty()) {
+        return nullptr;
+    }
+    auto mask = _deleteBuckets.size() - 1;
+    auto slot = DeleteSlot(deleteHash, mask);
+    while (_deleteBuckets[slot].Head != 0) {
+        if (_deleteBuckets[slot].Hash == deleteHash) {
+            return &_deleteBuckets[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
+
+void SymSpell::AddDelete(std::uint32_t deleteHash, std::uint32_t wordId) {
+    if ((_deleteBucketUsed + 1) * 2 > _deleteBuckets.size()) {
+        std::vector<DeleteBucket> old;
+        old.swap(_deleteBuckets);
+        _deleteBuckets.assign(std::max<std::size_t>(old.size() * 2, 1024), DeleteBucket{0, 0, 0});
+        auto mask = _deleteBuckets.size() - 1;
+        for (auto &bucket: old) {
+            if (bucket.Head != 0) {
+                auto slot = DeleteSlot(bucket.Hash, mask);
+                while (_deleteBuckets[slot].Head != 0) {
+                    slot = (slot + 1) & mask;
+                }
+                _deleteBuckets[slot] = bucket;
+            }
+        }
+    }
+
+    _deleteNodes.push_back(DeleteNode{wordId, 0});
+    auto node = static_cast<std::uint32_t>(_deleteNodes.size());
+    auto mask = _deleteBuckets.size() - 1;
+    auto slot = DeleteSlot(deleteHash, mask);
+    while (_deleteBuckets[slot].Head != 0) {
+        auto &bucket = _deleteBuckets[slot];
+        if (bucket.Hash == deleteHash) {
+            _deleteNodes[bucket.Tail - 1].Next = node;
+            bucket.Tail = node;
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    _deleteBuckets[slot] = DeleteBucket{deleteHash, node, node};
+    _deleteBucketUsed++;
+}
+
+bool SymSpell::BuildDeletesWords(std::uint32_t wordId) {
     //edits/suggestions are created only once, no matter how often word occurs
     //edits/suggestions are created only as soon as the word occurs in the corpus,
     //even if the same term existed before in the dictionary as an edit from another word
+    auto key = GetWord(wordId);
     if (key.size() > _maxDictionaryWordLength) {
         _maxDictionaryWordLength = key.size();
     }
     //create deletes
-    auto edits = EditsPrefix(key);
-    for (auto it = edits.begin(); it != edits.end(); ++it) {
-        int deleteHash = GetStringHash(*it);
-        auto deletesFounded = _deletes.find(deleteHash);
-        if (deletesFounded != _deletes.end()) {
-            auto &suggestions = deletesFounded->second;
-            suggestions.emplace_back(key);
-        } else {
-            std::vector<std::string> suggestions = {key};
-
-            _deletes.insert({deleteHash, suggestions});
-        }
+    std::vector<std::uint32_t> deleteHashes;
+    EditsPrefix(key, deleteHashes);
+    for (auto deleteHash: deleteHashes) {
+        AddDelete(deleteHash, wordId);
     }
+    _builtWordCount = std::max<std::size_t>(_builtWordCount, wordId + 1);
     return true;
 }
 
 bool SymSpell::BuildAllDeletesWords() {
-    bool ret = true;
-    for (auto &pair: _words) {
-        ret &= BuildDeletesWords(pair.first);
+    std::vector<std::uint32_t> deleteHashes;
+    for (auto id = static_cast<std::uint32_t>(_builtWordCount); id < _words.size(); id++) {
+        auto key = GetWord(id);
+        if (key.size() > _maxDictionaryWordLength) {
+            _maxDictionaryWordLength = key.size();
+        }
+        EditsPrefix(key, deleteHashes);
+        for (auto deleteHash: deleteHashes) {
+            AddDelete(deleteHash, id);
+        }
     }
-    return ret;
+    _builtWordCount = _words.size();
+    return true;
 }
 
-std::unordered_set<std::string> SymSpell::EditsPrefix(std::string_view key) {
-    std::unordered_set<std::string> hashSet;
+void SymSpell::EditsPrefix(std::string_view key, std::vector<std::uint32_t> &deleteHashes) {
+    DeleteCandidates candidates;
     if (key.size() <= static_cast<std::size_t>(_maxDictionaryEditDistance)) {
-        hashSet.insert("");
+        candidates.Add("", 0);
     }
     if (key.size() > _prefixLength) {
         key = key.substr(0, _prefixLength);
     }
-    hashSet.insert(std::string(key));
-    Edits(key, 0, hashSet);
-
-    return hashSet;
-}
-
-void SymSpell::Edits(std::string_view word, int editDistance, std::unordered_set<std::string> &deleteWord) {
-    editDistance++;
-    if (word.size() > 1) {
-        for (std::size_t i = 0; i < word.size(); i++) {
-            std::string tmp(word);
-            auto del = tmp.erase(i, 1);
-            if (deleteWord.insert(del).second) {
-                if (editDistance < _maxDictionaryEditDistance) {
-                    Edits(del, editDistance, deleteWord);
-                }
+    candidates.Add(key, 0);
+    for (std::size_t i = 0; i < candidates.Size(); i++) {
+        auto word = candidates.Get(i);
+        if (word.size() > 1 && candidates.GetDistance(i) < _maxDictionaryEditDistance) {
+            for (std::size_t pos = 0; pos < word.size(); pos++) {
+                candidates.AddDelete(i, pos);
             }
         }
     }
-}
 
-int SymSpell::GetStringHash(std::string_view source) {
-    uint32_t lenMask = static_cast<uint32_t>(source.size());
-    if (lenMask > 3) {
-        lenMask = 3;
+    deleteHashes.clear();
+    for (std::size_t i = 0; i < candidates.Size(); i++) {
+        deleteHashes.push_back(SymSpellIndex::DeleteHash(candidates.Get(i)));
     }
-    uint32_t hash = 2166136261;
-    for (auto c: source) {
-        //unchecked, its fine even if it can be overflowed
-        hash ^= c;
-        hash *= 16777619;
-    }
-
-    hash &= _compactMask;
-    hash |= lenMask;
-    return static_cast<int>(hash);
 }
 
 bool SymSpell::DeleteInSuggestionPrefix(std::string_view deleteSuggest, std::size_t deleteLen,
@@ -0,0 +1,253 @@
+#include "Util/SymSpell/SymSpellIndex.h"
+#include <cstring>
+
+constexpr char IndexMagic[8] = {'S', 'Y', 'M', 'S', 'P', 'E', 'L', 'L'};
+constexpr std::uint32_t IndexByteOrder = 0x01020304;
+constexpr std::uint32_t CompactMask = (0xffffffffu >> 8) << 2;
+
+// 槽位数为 2 的幂, 装载因子不超过 0.5
+static std::uint32_t SlotCount(std::size_t count) {
+    std::uint32_t slots = 1;
+    while (slots < count * 2) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+// 删除串 hash 的低位是长度, 打散后再取槽位
+static std::uint32_t DeleteSlot(std::uint32_t hash, std::uint32_t mask) {
+    return (hash * 2654435761u >> 7) & mask;
+}
+
+template<class T>
+static void AppendValues(std::string &out, const std::vector<T> &values) {
+    out.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+std::uint32_t SymSpellIndex::WordHash(std::string_view word) {
+    std::uint32_t hash = 2166136261u;
+    for (auto c: word) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+std::uint32_t SymSpellIndex::DeleteHash(std::string_view deleteWord) {
+    auto lenMask = static_cast<std::uint32_t>(deleteWord.size());
+    if (lenMask > 3) {
+        lenMask = 3;
+    }
+    std::uint32_t hash = 2166136261u;
+    for (auto c: deleteWord) {
+        //unchecked, its fine even if it can be overflowed
+        hash ^= c;
+        hash *= 16777619u;
+    }
+
+    hash &= CompactMask;
+    hash |= lenMask;
+    return hash;
+}
+
+bool SymSpellIndex::IsIndexData(std::string_view data) {
+    return data.size() >= sizeof(IndexMagic) && std::memcmp(data.data(), IndexMagic, sizeof(IndexMagic)) == 0;
+}
+
+std::string SymSpellIndex::Serialize(const std::vector<std::pair<std::string, int>> &words,
+                                     const std::map<std::uint32_t, std::vector<std::uint32_t>> &deletes,
+                                     int maxEditDistance, int prefixLength, std::size_t maxWordLength) {
+    Header header{};
+    std::memcpy(header.Magic, IndexMagic, sizeof(IndexMagic));
+    header.ByteOrder = IndexByteOrder;
+    header.Version = Version;
+    header.MaxEditDistance = static_cast<std::uint32_t>(maxEditDistance);
+    header.PrefixLength = static_cast<std::uint32_t>(prefixLength);
+    header.MaxWordLength = static_cast<std::uint32_t>(maxWordLength);
+    header.WordCount = static_cast<std::uint32_t>(words.size());
+
+    std::string stringPool;
+    std::vector<Word> wordEntries;
+    wordEntries.reserve(words.size());
+    for (auto &[word, count]: words) {
+        wordEntries.push_back(Word{static_cast<std::uint32_t>(stringPool.size()),
+                                   static_cast<std::uint32_t>(word.size()),
+                                   static_cast<std::uint32_t>(count)});
+        stringPool.append(word);
+    }
+
+    std::vector<std::uint32_t> wordSlots(SlotCount(words.size()), 0);
+    auto wordMask = static_cast<std::uint32_t>(wordSlots.size() - 1);
+    for (std::uint32_t id = 0; id != words.size(); id++) {
+        auto slot = WordHash(words[id].first) & wordMask;
+        while (wordSlots[slot] != 0) {
+            slot = (slot + 1) & wordMask;
+        }
+        wordSlots[slot] = id + 1;
+    }
+
+    std::vector<DeleteBucket> buckets(SlotCount(deletes.size()), DeleteBucket{0, 0, 0});
+    std::vector<std::uint32_t> entries;
+    auto deleteMask = static_cast<std::uint32_t>(buckets.size() - 1);
+    for (auto &[hash, ids]: deletes) {
+        auto slot = DeleteSlot(hash, deleteMask);
+        while (buckets[slot].Count != 0) {
+            slot = (slot + 1) & deleteMask;
+        }
+        buckets[slot] = DeleteBucket{hash, static_cast<std::uint32_t>(entries.size()), static_cast<std::uint32_t>(ids.size())};
+        entries.insert(entries.end(), ids.begin(), ids.end());
+    }
+
+    header.WordSlotCount = static_cast<std::uint32_t>(wordSlots.size());
+    header.DeleteBucketCount = static_cast<std::uint32_t>(buckets.size());
+    header.DeleteEntryCount = static_cast<std::uint32_t>(entries.size());
+    header.StringPoolSize = static_cast<std::uint32_t>(stringPool.size());
+    header.WordsOffset = sizeof(Header);
+    header.WordSlotsOffset = header.WordsOffset + static_cast<std::uint32_t>(wordEntries.size() * sizeof(Word));
+    header.DeleteBucketsOffset = header.WordSlotsOffset + static_cast<std::uint32_t>(wordSlots.size() * sizeof(std::uint32_t));
+    header.DeleteEntriesOffset = header.DeleteBucketsOffset + static_cast<std::uint32_t>(buckets.size() * sizeof(DeleteBucket));
+    header.StringPoolOffset = header.DeleteEntriesOffset + static_cast<std::uint32_t>(entries.size() * sizeof(std::uint32_t));
+
+    std::string data;
+    data.reserve(header.StringPoolOffset + stringPool.size());
+    data.append(reinterpret_cast<const char *>(&header), sizeof(Header));
+    AppendValues(data, wordEntries);
+    AppendValues(data, wordSlots);
+    AppendValues(data, buckets);
+    AppendValues(data, entries);
+    data.append(stringPool);
+    return data;
+}
+
+SymSpellIndex::SymSpellIndex()
+    : _header(nullptr),
+      _words(nullptr),
+      _wordSlots(nullptr),
+      _deleteBuckets(nullptr),
+      _deleteEntries(nullptr),
+      _stringPool(nullptr) {
+}
+
+bool SymSpellIndex::Attach(std::string_view data) {
+    _header = nullptr;
+    if (data.size() < sizeof(Header) || !IsIndexData(data)
+        || reinterpret_cast<std::uintptr_t>(data.data()) % alignof(Header) != 0) {
+        return false;
+    }
+
+    auto header = reinterpret_cast<const Header *>(data.data());
+    if (header->ByteOrder != IndexByteOrder || header->Version != Version) {
+        return false;
+    }
+
+    // 槽位数必须是 2 的幂, 各段必须首尾相接且不越界
+    auto isPowerOfTwo = [](std::uint32_t n) { return n != 0 && (n & (n - 1)) == 0; };
+    if (!isPowerOfTwo(header->WordSlotCount) || !isPowerOfTwo(header->DeleteBucketCount)) {
+        return false;
+    }
+    std::uint64_t offset = sizeof(Header);
+    auto checkSection = [&](std::uint32_t sectionOffset, std::uint64_t size) {
+        if (sectionOffset != offset) {
+            return false;
+        }
+        offset += size;
+        return offset <= data.size();
+    };
+    if (!checkSection(header->WordsOffset, std::uint64_t(header->WordCount) * sizeof(Word))
+        || !checkSection(header->WordSlotsOffset, std::uint64_t(header->WordSlotCount) * sizeof(std::uint32_t))
+        || !checkSection(header->DeleteBucketsOffset, std::uint64_t(header->DeleteBucketCount) * sizeof(DeleteBucket))
+        || !checkSection(header->DeleteEntriesOffset, std::uint64_t(header->DeleteEntryCount) * sizeof(std::uint32_t))
+        || !checkSection(header->StringPoolOffset, header->StringPoolSize)) {
+        return false;
+    }
+
+    _header = header;
+    _words = reinterpret_cast<const Word *>(data.data() + header->WordsOffset);
+    _wordSlots = reinterpret_cast<const std::uint32_t *>(data.data() + header->WordSlotsOffset);
+    _deleteBuckets = reinterpret_cast<const DeleteBucket *>(data.data() + header->DeleteBucketsOffset);
+    _deleteEntries = reinterpret_cast<const std::uint32_t *>(data.data() + header->DeleteEntriesOffset);
+    _stringPool = data.data() + header->StringPoolOffset;
+    return true;
+}
+
+bool SymSpellIndex::IsAttached() const {
+    return _header != nullptr;
+}
+
+std::uint32_t SymSpellIndex::FindWord(std::string_view word) const {
+    if (!_header) {
+        return NotFound;
+    }
+    auto mask = _header->WordSlotCount - 1;
+    auto slot = WordHash(word) & mask;
+    // 装载因子不超过 0.5, 一定能遇到空槽位
+    for (std::uint32_t i = 0; i != _header->WordSlotCount; i++) {
+        auto value = _wordSlots[slot];
+        if (value == 0) {
+            return NotFound;
+        }
+        if (GetWord(value - 1) == word) {
+            return value - 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NotFound;
+}
+
+std::string_view SymSpellIndex::GetWord(std::uint32_t id) const {
+    if (!_header || id >= _header->WordCount) {
+        return "";
+    }
+    auto &word = _words[id];
+    if (std::uint64_t(word.Offset) + word.Length > _header->StringPoolSize) {
+        return "";
+    }
+    return std::string_view(_stringPool + word.Offset, word.Length);
+}
+
+int SymSpellIndex::GetCount(std::uint32_t id) const {
+    if (!_header || id >= _header->WordCount) {
+        return 0;
+    }
+    return static_cast<int>(_words[id].Count);
+}
+
+SymSpellIndex::IdRange SymSpellIndex::FindDeletes(std::uint32_t deleteHash) const {
+    IdRange range;
+    if (!_header) {
+        return range;
+    }
+    auto mask = _header->DeleteBucketCount - 1;
+    auto slot = DeleteSlot(deleteHash, mask);
+    for (std::uint32_t i = 0; i != _header->DeleteBucketCount; i++) {
+        auto &bucket = _deleteBuckets[slot];
+        if (bucket.Count == 0) {
+            break;
+        }
+        if (bucket.Hash == deleteHash) {
+            if (std::uint64_t(bucket.First) + bucket.Count <= _header->DeleteEntryCount) {
+                range.Begin = _deleteEntries + bucket.First;
+                range.End = range.Begin + bucket.Count;
+            }
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return range;
+}
+
+int SymSpellIndex::GetMaxEditDistance() const {
+    return _header ? static_cast<int>(_header->MaxEditDistance) : 0;
+}
+
+std::size_t SymSpellIndex::GetPrefixLength() const {
+    return _header ? _header->PrefixLength : 0;
+}
+
+std::size_t SymSpellIndex::GetMaxWordLength() const {
+    return _header ? _header->MaxWordLength : 0;
+}
+
+std::size_t SymSpellIndex::GetWordCount() const {
+    return _header ? _header->WordCount : 0;
+}
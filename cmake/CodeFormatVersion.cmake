@@ -0,0 +1,30 @@
+# 由 CodeFormat 的 CodeFormatVersion 目标在每次构建时执行
+# 输入: VERSION SOURCE_DIR OUTPUT
+# 版本号加上 git 提交, 任何代码改动都会使结果缓存失效
+
+set(FULL_VERSION "${VERSION}")
+
+find_package(Git QUIET)
+if(GIT_FOUND)
+	execute_process(
+		COMMAND ${GIT_EXECUTABLE} describe --always --dirty --abbrev=12
+		WORKING_DIRECTORY ${SOURCE_DIR}
+		OUTPUT_VARIABLE GIT_REVISION
+		OUTPUT_STRIP_TRAILING_WHITESPACE
+		RESULT_VARIABLE GIT_RESULT
+		ERROR_QUIET
+	)
+	if(GIT_RESULT EQUAL 0 AND NOT GIT_REVISION STREQUAL "")
+		set(FULL_VERSION "${VERSION}+${GIT_REVISION}")
+	endif()
+endif()
+
+set(CONTENT "#pragma once\n\n#include <string_view>\n\n// generated by cmake/CodeFormatVersion.cmake\nconstexpr std::string_view CodeFormatVersion = \"${FULL_VERSION}\";\n")
+
+# 内容不变时不改写, 避免每次构建都重新编译
+if(EXISTS ${OUTPUT})
+	file(READ ${OUTPUT} OLD_CONTENT)
+endif()
+if(NOT "${OLD_CONTENT}" STREQUAL "${CONTENT}")
+	file(WRITE ${OUTPUT} "${CONTENT}")
+endif()